@@ -0,0 +1,656 @@
+#pragma once
+
+// 异步二进制日志：CTP 回调线程上只做 "格式串指针 + 原始参数" 的拷贝，格式化、GBK 转码和写出在后台线程完成
+//
+// 用法：
+//   hf_log::LogGuard guard;                       // main() 开头启动后台线程，析构时写完剩余日志
+//   LOG_INFO("[CTPThread] Login ok, TradingDay: {}", p->TradingDay);
+//   LOG_ERROR("[Auth] failed: [{}] {}", i->ErrorID, hf_log::gbk(i->ErrorMsg));
+//
+// - 格式串必须是字面量 (宏里拼接 "" 强制检查)，记录里只存它的地址；占位符为 {}，多余的参数以空格追加在末尾
+// - 参数按类型编码：整数/浮点/bool/char 直接拷贝，字符串 (const char*、char[N]、std::string) 拷贝内容，
+//   hf_log::gbk() 包装的字符串在后台线程用 iconv 转成 UTF-8
+// - 每个线程第一次写日志时分配自己的 SPSC 字节环 (默认 1 MB)，之后写日志无锁、无系统调用、无内存分配；
+//   环满或单条记录超过环容量的 1/4 (超长字符串参数) 时丢弃并计数，从不阻塞调用线程，后台线程定期报告丢弃数
+// - 时间戳为 RDTSC，后台线程按启动时的标定换算为本地时间
+// - 后台线程轮询各线程的环，按时间戳归并后批量 write()：DEBUG/INFO 写 stdout，WARN/ERROR 写 stderr，
+//   配置了 path 时全部追加写入该文件
+// - 仅依赖 C++11 标准库、pthread 和 glibc iconv，hf_ctp_md、ctp_test、rohon_test 共用
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <iconv.h>
+#include <mutex>
+#include <pthread.h>
+#include <string>
+#include <strings.h>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+#include <x86intrin.h>
+
+namespace hf_log {
+
+enum Level : uint8_t {
+    DEBUG = 0,
+    INFO,
+    WARN,
+    ERROR
+};
+
+// 读取配置用："DEBUG"/"INFO"/"WARN"/"ERROR" (不区分大小写)，无法识别时返回 false 且不修改 level
+inline bool parse_level(const char* name, Level& level) {
+    static const char* const NAMES[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+    for (int i = 0; i < 4; ++i) {
+        if (strcasecmp(name, NAMES[i]) == 0) {
+            level = (Level)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct LogConfig {
+    Level level;            // 低于此级别的日志在调用处直接返回
+    std::string path;       // 非空时写入该文件 (追加)，否则写 stdout/stderr
+    size_t buffer_size;     // 每个线程的环大小 (字节，2 的幂次)
+    unsigned poll_us;       // 后台线程空闲时的轮询间隔
+    int cpu_id;             // 后台线程绑定的核心，< 0 不绑核
+
+    LogConfig() : level(INFO), buffer_size(1 << 20), poll_us(1000), cpu_id(-1) {}
+};
+
+namespace detail {
+
+const size_t MAX_STRING = 1024; // 单个字符串参数的最大拷贝长度，超出截断
+
+// 字符串参数最多读取的字节数：CTP 结构体里的 char[N] 字段不一定以 0 结尾，按数组长度截断
+template<typename T>
+inline size_t string_bound(const T&) { return MAX_STRING; }
+
+template<size_t N>
+inline size_t string_bound(const char (&)[N]) { return N < MAX_STRING ? N : MAX_STRING; }
+
+} // namespace detail
+
+// 标记需要 GBK -> UTF-8 转码的字符串 (CTP 的 ErrorMsg、StatusMsg 等)
+struct GbkString {
+    const char* str;
+    size_t max;
+};
+
+template<typename T>
+inline GbkString gbk(const T& str) {
+    GbkString s;
+    s.str = str;
+    s.max = detail::string_bound(str);
+    return s;
+}
+
+namespace detail {
+
+// 后台解码时的上下文 (iconv 句柄只在后台线程上使用)
+struct DecodeContext {
+    iconv_t gbk;
+
+    DecodeContext() : gbk(iconv_open("UTF-8", "GBK")) {}
+    ~DecodeContext() {
+        if (gbk != (iconv_t)-1) iconv_close(gbk);
+    }
+};
+
+typedef void (*DecodeFn)(const char* fmt, const char* args, std::string& out, DecodeContext& ctx);
+
+// 环中每条记录的头部，记录总长按 8 字节对齐
+struct RecordHeader {
+    uint32_t size;          // 含头部的总长；最高位为 1 表示环尾的填充
+    uint8_t level;
+    uint8_t reserved[3];
+    uint64_t tsc;
+    const char* fmt;        // 格式串地址即格式 id
+    DecodeFn decode;
+};
+
+const uint32_t PADDING_BIT = 0x80000000u;
+
+inline size_t align8(size_t n) { return (n + 7) & ~(size_t)7; }
+
+// === 单线程写、后台线程读的变长字节环 ===
+// 记录不跨越环尾：剩余空间不够时写一条填充记录，从头开始
+class LogRing {
+public:
+    explicit LogRing(size_t capacity) : capacity_(capacity), mask_(capacity - 1), head_(0), tail_(0), tail_cache_(0) {
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, 64, capacity_) != 0) throw std::bad_alloc();
+        buffer_ = static_cast<char*>(ptr);
+    }
+
+    ~LogRing() { free(buffer_); }
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    // === 写线程 ===
+    // 申请 n 字节 (已按 8 对齐) 的连续空间，空间不足返回 nullptr
+    inline char* reserve(size_t n) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t pos = head & mask_;
+        const size_t contiguous = capacity_ - pos;
+        const size_t need = n <= contiguous ? n : n + contiguous;
+        if (head + need - tail_cache_ > capacity_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head + need - tail_cache_ > capacity_) return nullptr;
+        }
+        if (n > contiguous) {
+            RecordHeader* pad = reinterpret_cast<RecordHeader*>(buffer_ + pos);
+            pad->size = (uint32_t)contiguous | PADDING_BIT;
+            head_.store(head + contiguous, std::memory_order_release);
+            return buffer_;
+        }
+        return buffer_ + pos;
+    }
+
+    inline void commit(size_t n) {
+        head_.store(head_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    // === 后台线程 ===
+    // 下一条记录，没有数据返回 nullptr；跳过填充
+    inline const RecordHeader* peek() {
+        const size_t head = head_.load(std::memory_order_acquire);
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        while (tail != head) {
+            const RecordHeader* rec = reinterpret_cast<const RecordHeader*>(buffer_ + (tail & mask_));
+            if (!(rec->size & PADDING_BIT)) return rec;
+            tail += rec->size & ~PADDING_BIT;
+            tail_.store(tail, std::memory_order_release);
+        }
+        return nullptr;
+    }
+
+    inline void pop(const RecordHeader* rec) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + rec->size, std::memory_order_release);
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    // 用填充隔开读写两端的变量 (不用 alignas，C++11 的 new 不保证超过 16 字节的对齐)
+    const size_t capacity_;
+    const size_t mask_;
+    char* buffer_;
+    char pad0_[64];
+    std::atomic<size_t> head_;
+    char pad1_[64];
+    std::atomic<size_t> tail_;
+    char pad2_[64];
+    size_t tail_cache_;                   // 写线程持有的 tail_ 副本
+};
+
+struct ThreadBuffer {
+    LogRing ring;
+    std::atomic<uint64_t> dropped;         // 写线程单写
+    std::atomic<bool> retired;             // 线程已退出，读空后由后台线程释放
+    uint64_t reported_dropped;             // 后台线程已报告的丢弃数
+
+    explicit ThreadBuffer(size_t capacity) : ring(capacity), dropped(0), retired(false), reported_dropped(0) {}
+};
+
+// === 参数编码 ===
+// ArgTraits<T>：size() 编码长度，encode() 写入，decode() 在后台追加为文本
+
+template<typename T, typename Enable = void>
+struct ArgTraits;
+
+template<typename T>
+struct ArgTraits<T, typename std::enable_if<std::is_integral<T>::value || std::is_floating_point<T>::value ||
+                                            std::is_enum<T>::value>::type> {
+    static size_t size(const T&) { return sizeof(T); }
+    static void encode(char*& p, const T& v) {
+        memcpy(p, &v, sizeof(T));
+        p += sizeof(T);
+    }
+    static void decode(const char*& p, std::string& out, DecodeContext&) {
+        T v;
+        memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        append(v, out);
+    }
+
+private:
+    template<typename U>
+    static void append(U v, std::string& out, typename std::enable_if<std::is_floating_point<U>::value>::type* = 0) {
+        char buf[32];
+        out.append(buf, (size_t)snprintf(buf, sizeof(buf), "%g", (double)v));
+    }
+    template<typename U>
+    static void append(U v, std::string& out, typename std::enable_if<std::is_same<U, bool>::value>::type* = 0) {
+        out.append(v ? "true" : "false");
+    }
+    template<typename U>
+    static void append(U v, std::string& out, typename std::enable_if<std::is_same<U, char>::value>::type* = 0) {
+        out.push_back(v);
+    }
+    template<typename U>
+    static void append(U v, std::string& out, typename std::enable_if<(std::is_integral<U>::value || std::is_enum<U>::value) &&
+                                                                      !std::is_same<U, bool>::value &&
+                                                                      !std::is_same<U, char>::value>::type* = 0) {
+        char buf[32];
+        if (std::is_signed<U>::value) {
+            out.append(buf, (size_t)snprintf(buf, sizeof(buf), "%lld", (long long)v));
+        } else {
+            out.append(buf, (size_t)snprintf(buf, sizeof(buf), "%llu", (unsigned long long)v));
+        }
+    }
+};
+
+// 字符串：4 字节长度 + 内容
+struct StringCodec {
+    // max 小于 MAX_STRING 时来自 char[N] 的长度，用 strnlen；指针参数须以 0 结尾
+    static size_t length(const char* s, size_t max = MAX_STRING) {
+        if (!s) return 0;
+        return max < MAX_STRING ? strnlen(s, max) : std::min(strlen(s), MAX_STRING);
+    }
+    static void encode(char*& p, const char* s, size_t len) {
+        const uint32_t n = (uint32_t)len;
+        memcpy(p, &n, sizeof(n));
+        if (len) memcpy(p + sizeof(n), s, len);
+        p += sizeof(n) + len;
+    }
+    static const char* decode(const char*& p, uint32_t& len) {
+        memcpy(&len, p, sizeof(len));
+        const char* s = p + sizeof(len);
+        p = s + len;
+        return s;
+    }
+};
+
+template<>
+struct ArgTraits<const char*> {
+    static size_t size(const char* s) { return sizeof(uint32_t) + StringCodec::length(s); }
+    static void encode(char*& p, const char* s) { StringCodec::encode(p, s, StringCodec::length(s)); }
+    static void decode(const char*& p, std::string& out, DecodeContext&) {
+        uint32_t len;
+        const char* s = StringCodec::decode(p, len);
+        out.append(s, len);
+    }
+};
+
+template<>
+struct ArgTraits<char*> : ArgTraits<const char*> {};
+
+template<>
+struct ArgTraits<std::string> {
+    static size_t size(const std::string& s) { return sizeof(uint32_t) + std::min(s.size(), MAX_STRING); }
+    static void encode(char*& p, const std::string& s) { StringCodec::encode(p, s.data(), std::min(s.size(), MAX_STRING)); }
+    static void decode(const char*& p, std::string& out, DecodeContext& ctx) { ArgTraits<const char*>::decode(p, out, ctx); }
+};
+
+template<>
+struct ArgTraits<GbkString> {
+    static size_t size(const GbkString& s) { return sizeof(uint32_t) + StringCodec::length(s.str, s.max); }
+    static void encode(char*& p, const GbkString& s) { StringCodec::encode(p, s.str, StringCodec::length(s.str, s.max)); }
+    static void decode(const char*& p, std::string& out, DecodeContext& ctx) {
+        uint32_t len;
+        const char* s = StringCodec::decode(p, len);
+        if (ctx.gbk == (iconv_t)-1 || len == 0) {
+            out.append(s, len);
+            return;
+        }
+        char buf[MAX_STRING * 2];
+        char* in = const_cast<char*>(s);
+        char* dst = buf;
+        size_t in_left = len, out_left = sizeof(buf);
+        iconv(ctx.gbk, nullptr, nullptr, nullptr, nullptr);
+        if (iconv(ctx.gbk, &in, &in_left, &dst, &out_left) == (size_t)-1 && in == s) {
+            out.append(s, len); // 无法转换时原样输出
+            return;
+        }
+        out.append(buf, (size_t)(dst - buf));
+    }
+};
+
+// 按实参类型选择编码方式：数组退化为指针，去掉引用和 const
+template<typename T>
+struct Encoded {
+    typedef typename std::decay<T>::type type;
+};
+
+template<typename T>
+inline size_t arg_size(const T& v) { return ArgTraits<typename Encoded<T>::type>::size(v); }
+
+template<typename T>
+inline void arg_encode(char*& p, const T& v) { ArgTraits<typename Encoded<T>::type>::encode(p, v); }
+
+// char[N] 按数组长度截断，解码时与 char* 相同
+template<size_t N>
+inline size_t arg_size(const char (&s)[N]) { return sizeof(uint32_t) + StringCodec::length(s, string_bound(s)); }
+
+template<size_t N>
+inline void arg_encode(char*& p, const char (&s)[N]) { StringCodec::encode(p, s, StringCodec::length(s, string_bound(s))); }
+
+inline size_t args_size() { return 0; }
+
+template<typename T, typename... Rest>
+inline size_t args_size(const T& first, const Rest&... rest) {
+    return arg_size(first) + args_size(rest...);
+}
+
+inline void encode_args(char*&) {}
+
+template<typename T, typename... Rest>
+inline void encode_args(char*& p, const T& first, const Rest&... rest) {
+    arg_encode(p, first);
+    encode_args(p, rest...);
+}
+
+// 复制字面文本直到下一个 {}，返回 {} 之后的位置；占位符用完后剩余文本加一个空格，多余的参数依次追加
+inline const char* copy_literal(const char* fmt, std::string& out) {
+    const char* brace = strstr(fmt, "{}");
+    if (!brace) {
+        const size_t n = strlen(fmt);
+        out.append(fmt, n);
+        out.push_back(' ');
+        return fmt + n;
+    }
+    out.append(fmt, (size_t)(brace - fmt));
+    return brace + 2;
+}
+
+template<typename... Ts>
+struct Decoder;
+
+template<>
+struct Decoder<> {
+    static void run(const char* fmt, const char*, std::string& out, DecodeContext&) {
+        out.append(fmt);
+    }
+};
+
+template<typename T, typename... Rest>
+struct Decoder<T, Rest...> {
+    static void run(const char* fmt, const char* args, std::string& out, DecodeContext& ctx) {
+        fmt = copy_literal(fmt, out);
+        ArgTraits<T>::decode(args, out, ctx);
+        Decoder<Rest...>::run(fmt, args, out, ctx);
+    }
+};
+
+// === 后台线程 ===
+class Logger {
+public:
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    void start(const LogConfig& config) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running) return;
+        m_config = config;
+        if (m_config.buffer_size < 4096 || (m_config.buffer_size & (m_config.buffer_size - 1)) != 0) {
+            m_config.buffer_size = LogConfig().buffer_size;
+        }
+        m_level.store(m_config.level, std::memory_order_relaxed);
+        m_fd = -1;
+        if (!m_config.path.empty()) {
+            m_fd = ::open(m_config.path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+            if (m_fd < 0) fprintf(stderr, "[Log] Failed to open %s, logging to stdout\n", m_config.path.c_str());
+        }
+        calibrate();
+        m_running = true;
+        m_thread = std::thread(&Logger::run, this);
+    }
+
+    // 写完所有线程环中剩余的日志后返回
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_running) return;
+            m_running = false;
+        }
+        if (m_thread.joinable()) m_thread.join();
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    bool enabled(Level level) const { return level >= m_level.load(std::memory_order_relaxed); }
+    void set_level(Level level) { m_level.store(level, std::memory_order_relaxed); }
+
+    // 当前线程的环，第一次调用时分配并登记 (只有这一次加锁)
+    ThreadBuffer* thread_buffer() {
+        static thread_local BufferHolder holder;
+        if (__builtin_expect(!holder.buffer, 0)) {
+            holder.buffer = new ThreadBuffer(m_config.buffer_size);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_buffers.push_back(holder.buffer);
+        }
+        return holder.buffer;
+    }
+
+private:
+    // 线程退出时把环标记为退役，后台线程读空后释放
+    struct BufferHolder {
+        ThreadBuffer* buffer;
+        BufferHolder() : buffer(nullptr) {}
+        ~BufferHolder() {
+            if (buffer) buffer->retired.store(true, std::memory_order_release);
+        }
+    };
+
+    Logger() : m_level(INFO), m_running(false), m_fd(-1), m_baseTsc(0), m_baseNs(0), m_nsPerTick(1.0) {}
+
+    ~Logger() { stop(); }
+
+    static int64_t realtime_ns() {
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+
+    // 用 10ms 窗口标定 TSC 频率，日志时间精度到微秒足够
+    void calibrate() {
+        const uint64_t tsc0 = __rdtsc();
+        const int64_t ns0 = realtime_ns();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const uint64_t tsc1 = __rdtsc();
+        const int64_t ns1 = realtime_ns();
+        m_nsPerTick = tsc1 > tsc0 ? (double)(ns1 - ns0) / (double)(tsc1 - tsc0) : 1.0;
+        m_baseTsc = tsc1;
+        m_baseNs = ns1;
+    }
+
+    int64_t to_ns(uint64_t tsc) const {
+        return m_baseNs + (int64_t)((double)((int64_t)(tsc - m_baseTsc)) * m_nsPerTick);
+    }
+
+    // "HH:MM:SS.uuuuuu L " 前缀，同一秒内复用 localtime_r 的结果
+    void append_prefix(int64_t ns, uint8_t level, std::string& out) {
+        const time_t sec = (time_t)(ns / 1000000000LL);
+        if (sec != m_prefixSec) {
+            tm t;
+            localtime_r(&sec, &t);
+            strftime(m_prefixTime, sizeof(m_prefixTime), "%H:%M:%S", &t);
+            m_prefixSec = sec;
+        }
+        static const char LEVEL_CHARS[] = {'D', 'I', 'W', 'E'};
+        char buf[32];
+        const int n = snprintf(buf, sizeof(buf), "%s.%06d %c ", m_prefixTime, (int)(ns % 1000000000LL / 1000),
+                               LEVEL_CHARS[level & 3]);
+        out.append(buf, (size_t)n);
+    }
+
+    void write_out(int fd, std::string& batch) {
+        size_t done = 0;
+        while (done < batch.size()) {
+            const ssize_t n = ::write(fd, batch.data() + done, batch.size() - done);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            done += (size_t)n;
+        }
+        batch.clear();
+    }
+
+    // 一轮：按时间戳归并所有线程环中已有的记录，批量写出；返回处理的条数
+    size_t drain(std::vector<ThreadBuffer*>& buffers, DecodeContext& ctx) {
+        std::string& out_batch = m_outBatch;
+        std::string& err_batch = m_errBatch;
+        size_t processed = 0;
+        for (;;) {
+            ThreadBuffer* next = nullptr;
+            const RecordHeader* next_rec = nullptr;
+            for (size_t i = 0; i < buffers.size(); ++i) {
+                const RecordHeader* rec = buffers[i]->ring.peek();
+                if (rec && (!next_rec || (int64_t)(rec->tsc - next_rec->tsc) < 0)) {
+                    next = buffers[i];
+                    next_rec = rec;
+                }
+            }
+            if (!next_rec) break;
+
+            std::string& batch = (m_fd < 0 && next_rec->level >= WARN) ? err_batch : out_batch;
+            append_prefix(to_ns(next_rec->tsc), next_rec->level, batch);
+            next_rec->decode(next_rec->fmt, reinterpret_cast<const char*>(next_rec + 1), batch, ctx);
+            batch.push_back('\n');
+            next->ring.pop(next_rec);
+            ++processed;
+
+            if (out_batch.size() >= 64 * 1024) write_out(m_fd >= 0 ? m_fd : STDOUT_FILENO, out_batch);
+            if (err_batch.size() >= 64 * 1024) write_out(STDERR_FILENO, err_batch);
+        }
+
+        // 报告新增的丢弃
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            const uint64_t dropped = buffers[i]->dropped.load(std::memory_order_relaxed);
+            if (dropped != buffers[i]->reported_dropped) {
+                append_prefix(realtime_ns(), WARN, err_batch);
+                char buf[96];
+                err_batch.append(buf, (size_t)snprintf(buf, sizeof(buf), "[Log] Dropped %llu messages (ring full or message too large)\n",
+                                                       (unsigned long long)(dropped - buffers[i]->reported_dropped)));
+                buffers[i]->reported_dropped = dropped;
+            }
+        }
+
+        if (!out_batch.empty()) write_out(m_fd >= 0 ? m_fd : STDOUT_FILENO, out_batch);
+        if (!err_batch.empty()) write_out(m_fd >= 0 ? m_fd : STDERR_FILENO, err_batch);
+        return processed;
+    }
+
+    void run() {
+        if (m_config.cpu_id >= 0) {
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            CPU_SET(m_config.cpu_id, &cpuset);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+        }
+
+        DecodeContext ctx;
+        std::vector<ThreadBuffer*> buffers;
+        m_prefixSec = 0;
+        for (;;) {
+            const bool running = m_running;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                buffers = m_buffers;
+            }
+            const size_t processed = drain(buffers, ctx);
+
+            // 释放已退出线程的空环
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (size_t i = 0; i < m_buffers.size(); ) {
+                    ThreadBuffer* b = m_buffers[i];
+                    if (b->retired.load(std::memory_order_acquire) && !b->ring.peek()) {
+                        delete b;
+                        m_buffers.erase(m_buffers.begin() + i);
+                    } else {
+                        ++i;
+                    }
+                }
+            }
+
+            if (!running && processed == 0) break;
+            if (processed == 0) std::this_thread::sleep_for(std::chrono::microseconds(m_config.poll_us));
+        }
+    }
+
+private:
+    LogConfig m_config;
+    std::atomic<int> m_level;
+    std::mutex m_mutex;
+    std::vector<ThreadBuffer*> m_buffers;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    int m_fd;
+
+    // 以下只在后台线程上访问
+    uint64_t m_baseTsc;
+    int64_t m_baseNs;
+    double m_nsPerTick;
+    time_t m_prefixSec;
+    char m_prefixTime[16];
+    std::string m_outBatch;
+    std::string m_errBatch;
+};
+
+} // namespace detail
+
+inline void start(const LogConfig& config = LogConfig()) { detail::Logger::instance().start(config); }
+inline void stop() { detail::Logger::instance().stop(); }
+inline void set_level(Level level) { detail::Logger::instance().set_level(level); }
+
+// main() 开头构造，退出时写完剩余日志
+class LogGuard {
+public:
+    explicit LogGuard(const LogConfig& config = LogConfig()) { start(config); }
+    ~LogGuard() { stop(); }
+
+    LogGuard(const LogGuard&) = delete;
+    LogGuard& operator=(const LogGuard&) = delete;
+};
+
+// 热路径：一次 RDTSC + 参数拷贝 + 一次 release store
+template<typename... Args>
+inline void log(Level level, const char* fmt, const Args&... args) {
+    detail::Logger& logger = detail::Logger::instance();
+    if (!logger.enabled(level)) return;
+
+    detail::ThreadBuffer* buffer = logger.thread_buffer();
+    const size_t size = detail::align8(sizeof(detail::RecordHeader) + detail::args_size(args...));
+    char* p = __builtin_expect(size <= buffer->ring.capacity() / 4, 1) ? buffer->ring.reserve(size) : nullptr;
+    if (__builtin_expect(!p, 0)) {
+        buffer->dropped.store(buffer->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+
+    detail::RecordHeader* rec = reinterpret_cast<detail::RecordHeader*>(p);
+    rec->size = (uint32_t)size;
+    rec->level = level;
+    rec->tsc = __rdtsc();
+    rec->fmt = fmt;
+    rec->decode = &detail::Decoder<typename detail::Encoded<Args>::type...>::run;
+    p += sizeof(detail::RecordHeader);
+    detail::encode_args(p, args...);
+    buffer->ring.commit(size);
+}
+
+} // namespace hf_log
+
+// 格式串必须是字面量：记录里只保存它的地址
+#define LOG_DEBUG(fmt, ...) ::hf_log::log(::hf_log::DEBUG, "" fmt "", ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...)  ::hf_log::log(::hf_log::INFO, "" fmt "", ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)  ::hf_log::log(::hf_log::WARN, "" fmt "", ##__VA_ARGS__)
+#define LOG_ERROR(fmt, ...) ::hf_log::log(::hf_log::ERROR, "" fmt "", ##__VA_ARGS__)
@@ -8,6 +8,7 @@
 #include <thread>
 
 #include "ThostFtdcTraderApi.h"
+#include "AsyncLog.h"
 
 struct TraderConfig {
     std::string front_address;
@@ -111,9 +112,9 @@ public:
     bool success() const { return success_.load(); }
 
     void OnFrontConnected() override {
-        std::cout << "[1/3] Front connected" << std::endl;
+        LOG_INFO("[1/3] Front connected");
         if (cfg_.app_id.empty() || cfg_.auth_code.empty()) {
-            std::cout << "AppID/AuthCode empty, skip authenticate and login directly." << std::endl;
+            LOG_INFO("AppID/AuthCode empty, skip authenticate and login directly.");
             sendLogin();
             return;
         }
@@ -121,7 +122,7 @@ public:
     }
 
     void OnFrontDisconnected(int nReason) override {
-        std::cerr << "Front disconnected, reason=" << nReason << std::endl;
+        LOG_ERROR("Front disconnected, reason={}", nReason);
         if (!finished_) {
             finished_ = true;
             success_ = false;
@@ -134,14 +135,13 @@ public:
         int,
         bool) override {
         if (pRspInfo && pRspInfo->ErrorID != 0) {
-            std::cerr << "[2/3] Authenticate failed, ErrorID=" << pRspInfo->ErrorID
-                      << ", ErrorMsg=" << pRspInfo->ErrorMsg << std::endl;
+            LOG_ERROR("[2/3] Authenticate failed, ErrorID={}, ErrorMsg={}", pRspInfo->ErrorID, hf_log::gbk(pRspInfo->ErrorMsg));
             finished_ = true;
             success_ = false;
             return;
         }
 
-        std::cout << "[2/3] Authenticate success" << std::endl;
+        LOG_INFO("[2/3] Authenticate success");
         sendLogin();
     }
 
@@ -151,15 +151,13 @@ public:
         int,
         bool) override {
         if (pRspInfo && pRspInfo->ErrorID != 0) {
-            std::cerr << "[3/3] Login failed, ErrorID=" << pRspInfo->ErrorID
-                      << ", ErrorMsg=" << pRspInfo->ErrorMsg << std::endl;
+            LOG_ERROR("[3/3] Login failed, ErrorID={}, ErrorMsg={}", pRspInfo->ErrorID, hf_log::gbk(pRspInfo->ErrorMsg));
             finished_ = true;
             success_ = false;
             return;
         }
 
-        std::cout << "[3/3] Login success, TradingDay="
-                  << (pRspUserLogin ? pRspUserLogin->TradingDay : "") << std::endl;
+        LOG_INFO("[3/3] Login success, TradingDay={}", pRspUserLogin ? pRspUserLogin->TradingDay : "");
         finished_ = true;
         success_ = true;
     }
@@ -168,9 +166,7 @@ public:
         if (!pRspInfo || pRspInfo->ErrorID == 0) {
             return;
         }
-        std::cerr << "OnRspError req=" << nRequestID
-                  << ", ErrorID=" << pRspInfo->ErrorID
-                  << ", ErrorMsg=" << pRspInfo->ErrorMsg << std::endl;
+        LOG_ERROR("OnRspError req={}, ErrorID={}, ErrorMsg={}", nRequestID, pRspInfo->ErrorID, hf_log::gbk(pRspInfo->ErrorMsg));
     }
 
 private:
@@ -187,12 +183,12 @@ private:
 
         const int rc = api_->ReqAuthenticate(&req, ++request_id_);
         if (rc != 0) {
-            std::cerr << "ReqAuthenticate failed, ret=" << rc << std::endl;
+            LOG_ERROR("ReqAuthenticate failed, ret={}", rc);
             finished_ = true;
             success_ = false;
             return;
         }
-        std::cout << "Authenticate request sent." << std::endl;
+        LOG_INFO("Authenticate request sent.");
     }
 
     void sendLogin() {
@@ -204,12 +200,12 @@ private:
 
         const int rc = api_->ReqUserLogin(&req, ++request_id_);
         if (rc != 0) {
-            std::cerr << "ReqUserLogin failed, ret=" << rc << std::endl;
+            LOG_ERROR("ReqUserLogin failed, ret={}", rc);
             finished_ = true;
             success_ = false;
             return;
         }
-        std::cout << "Login request sent." << std::endl;
+        LOG_INFO("Login request sent.");
     }
 
 private:
@@ -240,6 +236,8 @@ int main(int argc, char* argv[]) {
     std::cout << "  AppID=" << cfg.app_id << std::endl;
     std::cout << "  AuthCode=" << (cfg.auth_code.empty() ? "(empty)" : "(set)") << std::endl;
 
+    hf_log::LogGuard logGuard;
+
     CThostFtdcTraderApi* api = CThostFtdcTraderApi::CreateFtdcTraderApi("flow_auth_test/");
     if (!api) {
         std::cerr << "CreateFtdcTraderApi failed." << std::endl;
@@ -268,6 +266,8 @@ int main(int argc, char* argv[]) {
 
     api->RegisterSpi(nullptr);
     api->Release();
+    // 先写完回调里的日志，结果行保持在最后一行
+    hf_log::stop();
 
     std::cout << (ok ? "AUTH_TEST_PASS" : "AUTH_TEST_FAIL") << std::endl;
     return ok ? 0 : 2;
@@ -1,5 +1,6 @@
 #include <chrono>
 #include <cstring>
+#include <atomic>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -10,10 +11,13 @@
 #include <signal.h>
 
 #include "ThostFtdcMdApi.h"
+#include "AsyncLog.h"
 
 static CThostFtdcMdApi* g_pMdApi = nullptr;
 static bool g_bLoggedIn = false;
 static int g_nRequestID = 0;
+// 信号处理里只置位，释放 API、停日志由 main 完成 (日志线程的 stop 要加锁、join，不能在信号处理里调用)
+static std::atomic<bool> g_running(true);
 
 struct MdConfig {
     std::string front_address;
@@ -72,60 +76,49 @@ public:
     CMdSpi(CThostFtdcMdApi* api, const MdConfig& cfg) : m_pMdApi(api), m_cfg(cfg) {}
 
     void OnFrontConnected() override {
-        std::cout << "[MD] Front connected" << std::endl;
+        LOG_INFO("[MD] Front connected");
         reqUserLogin();
     }
 
     void OnFrontDisconnected(int nReason) override {
-        std::cout << "[MD] Front disconnected, reason=" << nReason << std::endl;
+        LOG_WARN("[MD] Front disconnected, reason={}", nReason);
         g_bLoggedIn = false;
     }
 
     void OnHeartBeatWarning(int nTimeLapse) override {
-        std::cout << "[MD] HeartBeat warning " << nTimeLapse << "s" << std::endl;
+        LOG_WARN("[MD] HeartBeat warning {}s", nTimeLapse);
     }
 
     void OnRspUserLogin(CThostFtdcRspUserLoginField* pRsp, CThostFtdcRspInfoField* pRspInfo,
                         int nRequestID, bool bIsLast) override {
         if (pRspInfo && pRspInfo->ErrorID != 0) {
-            std::cerr << "[MD] Login failed ErrorID=" << pRspInfo->ErrorID << " " << pRspInfo->ErrorMsg << std::endl;
+            LOG_ERROR("[MD] Login failed ErrorID={} {}", pRspInfo->ErrorID, hf_log::gbk(pRspInfo->ErrorMsg));
             return;
         }
-        std::cout << "[MD] Login ok, TradingDay=" << (pRsp ? pRsp->TradingDay : "") << std::endl;
+        LOG_INFO("[MD] Login ok, TradingDay={}", pRsp ? pRsp->TradingDay : "");
         g_bLoggedIn = true;
         subscribeMarketData();
     }
 
     void OnRtnDepthMarketData(CThostFtdcDepthMarketDataField* p) override {
         if (!p) return;
-        auto now = std::chrono::system_clock::now();
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
-        std::time_t t = ms / 1000;
-        std::tm* tm = std::localtime(&t);
-        std::ostringstream oss;
-        oss << std::put_time(tm, "%H:%M:%S") << "." << std::setfill('0') << std::setw(3) << (ms % 1000);
-        std::cout << "[" << oss.str() << "] " << p->InstrumentID << " " << p->LastPrice
-                  << " " << p->UpdateTime << "." << p->UpdateMillisec << "\n"
-                  << "  买五档: "
-                  << p->BidPrice1 << "x" << p->BidVolume1 << " "
-                  << p->BidPrice2 << "x" << p->BidVolume2 << " "
-                  << p->BidPrice3 << "x" << p->BidVolume3 << " "
-                  << p->BidPrice4 << "x" << p->BidVolume4 << " "
-                  << p->BidPrice5 << "x" << p->BidVolume5 << "\n"
-                  << "  卖五档: "
-                  << p->AskPrice1 << "x" << p->AskVolume1 << " "
-                  << p->AskPrice2 << "x" << p->AskVolume2 << " "
-                  << p->AskPrice3 << "x" << p->AskVolume3 << " "
-                  << p->AskPrice4 << "x" << p->AskVolume4 << " "
-                  << p->AskPrice5 << "x" << p->AskVolume5 << std::endl;
+        // 本地接收时间由日志前缀给出 (回调线程上取 TSC，后台线程格式化)
+        LOG_INFO("{} {} {}.{}\n"
+                 "  买五档: {}x{} {}x{} {}x{} {}x{} {}x{}\n"
+                 "  卖五档: {}x{} {}x{} {}x{} {}x{} {}x{}",
+                 p->InstrumentID, p->LastPrice, p->UpdateTime, p->UpdateMillisec,
+                 p->BidPrice1, p->BidVolume1, p->BidPrice2, p->BidVolume2, p->BidPrice3, p->BidVolume3,
+                 p->BidPrice4, p->BidVolume4, p->BidPrice5, p->BidVolume5,
+                 p->AskPrice1, p->AskVolume1, p->AskPrice2, p->AskVolume2, p->AskPrice3, p->AskVolume3,
+                 p->AskPrice4, p->AskVolume4, p->AskPrice5, p->AskVolume5);
     }
 
     void OnRspSubMarketData(CThostFtdcSpecificInstrumentField* pInst, CThostFtdcRspInfoField* pRspInfo,
                            int nRequestID, bool bIsLast) override {
         if (pRspInfo && pRspInfo->ErrorID != 0)
-            std::cerr << "[MD] Sub failed " << (pInst ? pInst->InstrumentID : "") << " " << pRspInfo->ErrorMsg << std::endl;
+            LOG_ERROR("[MD] Sub failed {} {}", pInst ? pInst->InstrumentID : "", hf_log::gbk(pRspInfo->ErrorMsg));
         else if (pInst)
-            std::cout << "[MD] Sub ok " << pInst->InstrumentID << std::endl;
+            LOG_INFO("[MD] Sub ok {}", pInst->InstrumentID);
     }
 
 private:
@@ -136,24 +129,23 @@ private:
         strncpy(req.UserID, m_cfg.user_id.c_str(), sizeof(req.UserID) - 1);
         strncpy(req.Password, m_cfg.password.c_str(), sizeof(req.Password) - 1);
         int ret = m_pMdApi->ReqUserLogin(&req, ++g_nRequestID);
-        if (ret != 0) std::cerr << "[MD] ReqUserLogin ret=" << ret << std::endl;
+        if (ret != 0) LOG_ERROR("[MD] ReqUserLogin ret={}", ret);
     }
 
     void subscribeMarketData() {
         if (m_cfg.instruments.empty()) {
-            std::cout << "[MD] No instruments in config, skip subscribe" << std::endl;
+            LOG_INFO("[MD] No instruments in config, skip subscribe");
             return;
         }
         std::vector<char*> ptrs;
         for (auto& s : m_cfg.instruments) ptrs.push_back(const_cast<char*>(s.c_str()));
         int ret = m_pMdApi->SubscribeMarketData(ptrs.data(), ptrs.size());
-        if (ret != 0) std::cerr << "[MD] SubscribeMarketData ret=" << ret << std::endl;
+        if (ret != 0) LOG_ERROR("[MD] SubscribeMarketData ret={}", ret);
     }
 };
 
 static void signalHandler(int) {
-    if (g_pMdApi) { g_pMdApi->Release(); g_pMdApi = nullptr; }
-    exit(0);
+    g_running = false;
 }
 
 int main(int argc, char* argv[]) {
@@ -168,6 +160,9 @@ int main(int argc, char* argv[]) {
     if (cfg.instruments.empty())
         std::cout << "No [INSTRUMENTS] Instruments= in config, will not subscribe." << std::endl;
 
+    // 行情回调里逐笔打印，经异步日志写出，不阻塞 CTP 网络线程
+    hf_log::LogGuard logGuard;
+
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
 
@@ -183,6 +178,11 @@ int main(int argc, char* argv[]) {
     g_pMdApi->Init();
 
     std::cout << "[MD] Connecting to " << cfg.front_address << " ..." << std::endl;
-    while (true)
+    while (g_running)
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // 先停 CTP 回调线程，再由 logGuard 析构写完剩余日志
+    g_pMdApi->Release();
+    g_pMdApi = nullptr;
+    return 0;
 }
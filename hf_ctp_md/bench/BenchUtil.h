@@ -0,0 +1,90 @@
+#pragma once
+
+// 基准测试公共工具：计时、绑核、硬件计数器 (TSC 计时用 include/TscClock.h)
+// 仅供 bench/ 下的程序使用，不进入行情主程序
+
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+namespace bench {
+
+inline uint64_t now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// 已排序样本的分位数
+template<typename T>
+inline T percentile(const T* sorted, size_t n, double p) {
+    if (n == 0) return T();
+    size_t idx = (size_t)(p * (n - 1) + 0.5);
+    return sorted[idx < n ? idx : n - 1];
+}
+
+// 绑定当前线程到指定核心，cpu_id < 0 或核心不存在时不做任何事
+inline bool pin_current_thread(int cpu_id) {
+    if (cpu_id < 0 || cpu_id >= (int)sysconf(_SC_NPROCESSORS_ONLN)) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu_id, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+// 防止编译器把基准循环里的结果优化掉
+template<typename T>
+inline void do_not_optimize(const T& value) {
+    __asm__ __volatile__("" : : "g"(&value) : "memory");
+}
+
+// 进程级硬件计数器 (perf_event_open)
+// 必须在创建工作线程之前 open，inherit=1 才能把子线程计入
+// 容器或 perf_event_paranoid 限制下 open 失败，valid() 返回 false
+class PerfCounter {
+public:
+    explicit PerfCounter(uint64_t config = PERF_COUNT_HW_CACHE_MISSES) : fd_(-1) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    ~PerfCounter() {
+        if (fd_ >= 0) close(fd_);
+    }
+
+    bool valid() const { return fd_ >= 0; }
+
+    void start() {
+        if (fd_ < 0) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    // 返回计数值，不可用时返回 0
+    uint64_t stop() {
+        if (fd_ < 0) return 0;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t value = 0;
+        if (read(fd_, &value, sizeof(value)) != (ssize_t)sizeof(value)) return 0;
+        return value;
+    }
+
+private:
+    int fd_;
+};
+
+} // namespace bench
@@ -0,0 +1,284 @@
+// 多前置 A/B 仲裁基准：同一份行情经两个 CTPMdSpi (共用 FeedArbiter) 送入同一队列
+//
+// 先生成 ops 笔互不相同的行情 (合约轮转，成交量递增)，然后：
+// 1. 单前置：一个线程直接回调，得到不仲裁时每次回调的耗时
+// 2. A/B：两个线程各自按 rate 的节奏回调同一序列，前置 1 比前置 0 晚 delay_us 微秒
+// 消费线程检查每个合约的成交量严格递增 (无重复、无乱序)，且 收到 + 丢弃 == ops；
+// 打印每次回调的耗时分布以及各前置胜出/重复/过期的笔数
+// 另外直接调用 FeedArbiter 检查跨交易日、夜盘与重连：登录时推送的上一交易日 15:00 收盘快照之后的 09:00 行情、
+// 大商所/郑商所夜盘日期填法、日盘之后的夜盘都应发布；所有前置断开后重连的新会话即使时间更早也应发布
+//
+// 用法: arbiter_bench [ops] [rate_per_sec] [delay_us] [front0_cpu] [front1_cpu] [consumer_cpu]
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <immintrin.h>
+#include "AsyncLog.h"
+#include "CTPMdSpi.h"
+#include "FeedArbiter.h"
+#include "TscClock.h"
+#include "BenchUtil.h"
+
+static const size_t INSTRUMENTS = 16;
+
+struct ConsumerResult {
+    uint64_t received;
+    uint64_t out_of_order;
+};
+
+static void consume(SPSCQueue<Tick>& queue, const std::atomic<bool>& done, int cpu, ConsumerResult& result) {
+    bench::pin_current_thread(cpu);
+    std::vector<int32_t> last(INSTRUMENTS, -1);
+    result.received = 0;
+    result.out_of_order = 0;
+    for (;;) {
+        SPSCQueue<Tick>::Span batch = queue.peek_batch(64);
+        if (batch.empty()) {
+            if (done.load(std::memory_order_acquire) && queue.peek_batch(1).empty()) break;
+            _mm_pause();
+            continue;
+        }
+        for (const Tick& tick : batch) {
+            if (tick.volume <= last[tick.instrument_id]) result.out_of_order++;
+            last[tick.instrument_id] = tick.volume;
+        }
+        result.received += batch.size();
+        queue.release(batch.size());
+    }
+}
+
+// 前置线程：第 i 笔在 start + i * interval + delay 时刻回调，记录每次回调的 TSC 周期数
+static void feed(CTPMdSpi& spi, const std::vector<CThostFtdcDepthMarketDataField>& msgs, uint64_t start,
+                 uint64_t interval_ns, uint64_t delay_ns, int cpu, std::vector<uint64_t>& cycles) {
+    bench::pin_current_thread(cpu);
+    cycles.resize(msgs.size());
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        if (interval_ns) {
+            const uint64_t due = start + i * interval_ns + delay_ns;
+            while (bench::now_ns() < due) _mm_pause();
+        }
+        CThostFtdcDepthMarketDataField md = msgs[i]; // CTP 每次回调给的是自己的缓冲区
+        const uint64_t t0 = TscClock::rdtsc();
+        spi.OnRtnDepthMarketData(&md);
+        cycles[i] = TscClock::rdtsc() - t0;
+    }
+}
+
+static void print_cycles(const char* name, std::vector<uint64_t>& cycles) {
+    std::sort(cycles.begin(), cycles.end());
+    const size_t n = cycles.size();
+    printf("  %-22s P50 %5lld ns  P99 %6lld ns  P99.9 %7lld ns\n", name,
+           (long long)TscClock::to_ns((int64_t)bench::percentile(cycles.data(), n, 0.50)),
+           (long long)TscClock::to_ns((int64_t)bench::percentile(cycles.data(), n, 0.99)),
+           (long long)TscClock::to_ns((int64_t)bench::percentile(cycles.data(), n, 0.999)));
+}
+
+// 构造一笔行情，receive_ns 为真实交易所时间 + 1 毫秒
+static CThostFtdcDepthMarketDataField make_md(const char* trading_day, const char* action_day, const char* natural_day,
+                                              const char* time, int volume, int64_t& receive_ns) {
+    CThostFtdcDepthMarketDataField md;
+    memset(&md, 0, sizeof(md));
+    strcpy(md.TradingDay, trading_day);
+    strcpy(md.ActionDay, action_day);
+    strcpy(md.UpdateTime, time);
+    md.Volume = volume;
+    receive_ns = exchange_time_ns(natural_day, time, 0) + 1000000;
+    return md;
+}
+
+// 按顺序送入 (前置, 合约, 日期, 时间, 成交量)，检查每笔是否发布；connect 为 -1/1 的步骤改为断开/连上该前置
+static bool check_sessions() {
+    struct Step {
+        int connect;
+        uint8_t front;
+        uint16_t id;
+        const char* trading_day;
+        const char* action_day;
+        const char* natural_day;
+        const char* time;
+        int volume;
+        bool publish;
+    };
+    // 2025-01-06 为周一
+    static const Step steps[] = {
+        // 登录时收到周一收盘快照，之后周二日盘开盘
+        {0, 0, 0, "20250106", "20250106", "20250106", "15:00:00", 1000, true},
+        {0, 0, 0, "20250107", "20250107", "20250107", "09:00:00", 5, true},
+        {0, 1, 0, "20250107", "20250107", "20250107", "09:00:00", 5, false},
+        // 郑商所：日盘之后的夜盘，日期填自然日
+        {0, 0, 1, "20250106", "20250106", "20250106", "14:59:59", 100, true},
+        {0, 0, 1, "20250106", "20250106", "20250106", "21:00:00", 3, true},
+        {0, 0, 1, "20250107", "20250107", "20250107", "09:00:00", 8, true},
+        {0, 1, 1, "20250106", "20250106", "20250106", "22:59:59", 6, false},
+        // 大商所：夜盘日期填下一交易日，跨零点
+        {0, 0, 2, "20250106", "20250106", "20250106", "15:00:00", 100, true},
+        {0, 0, 2, "20250107", "20250107", "20250106", "23:59:59", 7, true},
+        {0, 1, 2, "20250107", "20250107", "20250107", "00:00:01", 9, true},
+        {0, 0, 2, "20250107", "20250107", "20250106", "23:59:59", 7, false},
+        // 两个前置都断开，前置 1 重连后的新会话时间更早 (重放)，清空记录后发布
+        {-1, 0, 0, "", "", "", "", 0, false},
+        {-1, 1, 0, "", "", "", "", 0, false},
+        {1, 1, 0, "", "", "", "", 0, false},
+        {0, 1, 0, "20250106", "20250106", "20250106", "10:00:00", 50, true},
+        // 前置 0 重连时前置 1 在线，不清空，同一笔为重复
+        {1, 0, 0, "", "", "", "", 0, false},
+        {0, 0, 0, "20250106", "20250106", "20250106", "10:00:00", 50, false},
+    };
+    FeedArbiter arbiter(INSTRUMENTS, 2);
+    arbiter.set_connected(0, true);
+    arbiter.set_connected(1, true);
+    size_t wrong = 0;
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); ++i) {
+        const Step& step = steps[i];
+        if (step.connect != 0) {
+            arbiter.set_connected(step.front, step.connect > 0);
+            continue;
+        }
+        int64_t receive_ns = 0;
+        const CThostFtdcDepthMarketDataField md =
+            make_md(step.trading_day, step.action_day, step.natural_day, step.time, step.volume, receive_ns);
+        arbiter.lock();
+        const bool published = arbiter.accept(step.front, step.id, md, receive_ns);
+        arbiter.unlock();
+        if (published != step.publish) {
+            printf("  step %zu: front %d %s %s %s volume %d %s\n", i, (int)step.front, step.trading_day,
+                   step.action_day, step.time, step.volume, published ? "published" : "rejected");
+            ++wrong;
+        }
+    }
+    printf("check: sessions and reconnects, %zu wrong decisions, %s\n", wrong, wrong == 0 ? "OK" : "INCONSISTENT");
+    return wrong == 0;
+}
+
+static bool check(const char* name, const ConsumerResult& r, const DropCounters& drops, uint64_t ops) {
+    const bool ok = r.out_of_order == 0 && r.received + drops.total() == ops;
+    printf("%s: received %llu, dropped %llu, out of order/duplicate %llu, %s\n", name,
+           (unsigned long long)r.received, (unsigned long long)drops.total(), (unsigned long long)r.out_of_order,
+           ok ? "OK" : "INCONSISTENT");
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    const uint64_t ops = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+    const uint64_t rate = argc > 2 ? strtoull(argv[2], nullptr, 10) : 50000;
+    const uint64_t delay_us = argc > 3 ? strtoull(argv[3], nullptr, 10) : 20;
+    const int cpu0 = argc > 4 ? atoi(argv[4]) : -1;
+    const int cpu1 = argc > 5 ? atoi(argv[5]) : -1;
+    const int consumer_cpu = argc > 6 ? atoi(argv[6]) : -1;
+
+    hf_log::LogConfig logConfig;
+    logConfig.level = hf_log::WARN;
+    hf_log::LogGuard logGuard(logConfig);
+    if (!TscClock::calibrate(100000000ULL)) {
+        std::cerr << "TSC calibration failed." << std::endl;
+        return 1;
+    }
+
+    InstrumentRegistry registry;
+    char name[16];
+    for (size_t i = 0; i < INSTRUMENTS; ++i) {
+        snprintf(name, sizeof(name), "bench%02zu", i);
+        registry.add(name, 1.0);
+    }
+    registry.build();
+
+    // 行情序列：每毫秒一个时间点，合约轮转，每个合约成交量逐笔递增
+    std::vector<CThostFtdcDepthMarketDataField> msgs(ops);
+    std::vector<int> volume(INSTRUMENTS, 0);
+    for (uint64_t i = 0; i < ops; ++i) {
+        CThostFtdcDepthMarketDataField& md = msgs[i];
+        memset(&md, 0, sizeof(md));
+        const size_t id = i % INSTRUMENTS;
+        const uint64_t ms = 9 * 3600 * 1000ULL + i / 4;
+        snprintf(md.InstrumentID, sizeof(md.InstrumentID), "bench%02zu", id);
+        strcpy(md.TradingDay, "20250101");
+        strcpy(md.ActionDay, "20250101");
+        snprintf(md.UpdateTime, sizeof(md.UpdateTime), "%02d:%02d:%02d", (int)(ms / 3600000 % 24),
+                 (int)(ms / 60000 % 60), (int)(ms / 1000 % 60));
+        md.UpdateMillisec = (int)(ms % 1000);
+        md.LastPrice = 1000 + (double)(i % 7);
+        md.Volume = (volume[id] += 1 + (int)(i % 3));
+        md.BidPrice1 = md.LastPrice - 1;
+        md.AskPrice1 = md.LastPrice + 1;
+        md.BidVolume1 = md.AskVolume1 = 10;
+    }
+
+    const uint64_t interval_ns = rate ? 1000000000ULL / rate : 0;
+    bool ok = check_sessions();
+
+    // 1. 单前置，不仲裁
+    {
+        SPSCQueue<Tick> queue(65536);
+        DropCounters drops(registry.size());
+        CTPMdSpi spi(nullptr, &queue, &registry);
+        spi.SetOverflowPolicy(OverflowConfig(), &drops);
+        std::atomic<bool> done(false);
+        ConsumerResult result;
+        std::thread consumer(consume, std::ref(queue), std::cref(done), consumer_cpu, std::ref(result));
+        std::vector<uint64_t> cycles;
+        feed(spi, msgs, bench::now_ns(), interval_ns, 0, cpu0, cycles);
+        done.store(true, std::memory_order_release);
+        consumer.join();
+        ok = check("single front", result, drops, ops) && ok;
+        print_cycles("callback", cycles);
+    }
+
+    // 2. A/B 两个前置，前置 1 晚 delay_us
+    {
+        SPSCQueue<Tick> queue(65536);
+        DropCounters drops(registry.size());
+        FeedArbiter arbiter(registry.size(), 2);
+        CTPMdSpi spi0(nullptr, &queue, &registry);
+        CTPMdSpi spi1(nullptr, &queue, &registry);
+        spi0.SetOverflowPolicy(OverflowConfig(), &drops);
+        spi0.SetArbiter(&arbiter, 0, &spi0);
+        spi1.SetArbiter(&arbiter, 1, &spi0);
+
+        std::atomic<bool> done(false);
+        ConsumerResult result;
+        std::thread consumer(consume, std::ref(queue), std::cref(done), consumer_cpu, std::ref(result));
+        std::vector<uint64_t> cycles0, cycles1;
+        const uint64_t start = bench::now_ns() + 1000000;
+        std::thread front1(feed, std::ref(spi1), std::cref(msgs), start, interval_ns, delay_us * 1000, cpu1,
+                           std::ref(cycles1));
+        feed(spi0, msgs, start, interval_ns, 0, cpu0, cycles0);
+        front1.join();
+        done.store(true, std::memory_order_release);
+        consumer.join();
+        ok = check("A/B fronts", result, drops, ops) && ok;
+        print_cycles("front 0 callback", cycles0);
+        print_cycles("front 1 callback", cycles1);
+        for (size_t i = 0; i < 2; ++i) {
+            const FeedArbiter::FrontStats& s = arbiter.stats(i);
+            const uint64_t duplicate = s.duplicate.load();
+            printf("  front %zu: won %llu, duplicate %llu (behind avg %llu ns), stale %llu\n", i,
+                   (unsigned long long)s.won.load(), (unsigned long long)duplicate,
+                   (unsigned long long)(duplicate ? s.behind_ns.load() / duplicate : 0),
+                   (unsigned long long)s.stale.load());
+        }
+        // 未注册合约：两个前置各收到一笔，按前置计数，不进入 DropCounters (只有前置 0 持有)
+        CThostFtdcDepthMarketDataField unknown = msgs[0];
+        strcpy(unknown.InstrumentID, "unknown");
+        const uint64_t drops_before = drops.total();
+        spi0.OnRtnDepthMarketData(&unknown);
+        spi1.OnRtnDepthMarketData(&unknown);
+        const bool unknown_ok = arbiter.stats(0).unknown.load() == 1 && arbiter.stats(1).unknown.load() == 1 &&
+                                drops.total() == drops_before;
+        printf("  unknown instrument: front 0 %llu, front 1 %llu, %s\n",
+               (unsigned long long)arbiter.stats(0).unknown.load(), (unsigned long long)arbiter.stats(1).unknown.load(),
+               unknown_ok ? "OK" : "INCONSISTENT");
+        ok = unknown_ok && ok;
+        const uint64_t won = arbiter.stats(0).won.load() + arbiter.stats(1).won.load();
+        if (won != ops) {
+            printf("  published %llu, expected %llu\n", (unsigned long long)won, (unsigned long long)ops);
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,233 @@
+// K 线聚合基准：BarAggregator 单线程吞吐 (目标：回放时单核 5M ticks/s)
+//
+// 生成两个交易日的行情 (夜盘 21:00~02:30 跨零点，日盘 09:00~11:30、13:30~15:00)，每一轮所有合约各一笔。
+// 合约两两成对、行情完全相同，区别只在夜盘的 TradingDay：偶数合约按上期所填下一交易日，奇数合约按
+// 郑商所填自然日 (周五夜盘填周五，零点后填周六)。交易所时间都是真实时间 (normalize_tick 已按各交易所的
+// 日期填法求出)。检查：
+// - 每对合约每个周期产出的 bar 序列完全相同 (OHLC、成交量、笔数、交易日、开始时刻)，
+//   郑商所的夜盘既不会被当成迟到丢弃，夜盘成交量也不会计入日盘第一根 bar
+// - 每个合约每个周期 bar 的成交量之和 == 各交易日累计成交量的增量，成交额误差在 1e-6 以内
+// - bar 数与按交易所时间分桶的期望一致，bar 按时间严格递增，没有迟到行情
+//
+// 用法: bar_bench [ops] [instruments] [periods_sec,...]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "AlignedAllocator.h"
+#include "BarAggregator.h"
+#include "TscClock.h"
+#include "BenchUtil.h"
+
+typedef std::vector<Tick, AlignedAllocator<Tick> > TickVector;
+
+struct TradingDay {
+    uint32_t trading_day;
+    const char* night_before_midnight; // 夜盘零点前的自然日
+    const char* night_after_midnight;  // 夜盘零点后的自然日
+    const char* day;                   // 日盘 (即交易日)
+};
+
+static const TradingDay DAYS[2] = {
+    {20250106, "20250103", "20250104", "20250106"}, // 周五夜盘 -> 周一
+    {20250107, "20250106", "20250107", "20250107"},
+};
+
+// 交易时段 (北京时间日内毫秒，夜盘结束时刻超过 24h 表示跨零点)
+static const uint32_t SEGMENTS[3][2] = {
+    {21 * 3600000, 26 * 3600000 + 30 * 60000},
+    {9 * 3600000, 11 * 3600000 + 30 * 60000},
+    {13 * 3600000 + 30 * 60000, 15 * 3600000},
+};
+static const uint32_t DAY_TRADING_MS = 34200000; // 9.5 小时
+
+// 交易日内的第 offset 毫秒交易时间 -> 北京时间的日内毫秒 (可能 >= 24h)
+static uint32_t trading_time(uint32_t offset) {
+    for (size_t s = 0; s < 3; ++s) {
+        const uint32_t len = SEGMENTS[s][1] - SEGMENTS[s][0];
+        if (offset < len) return SEGMENTS[s][0] + offset;
+        offset -= len;
+    }
+    return SEGMENTS[2][1] - 1;
+}
+
+// 与 BarAggregator 相同的交易日内时刻 (从 18:00 起算)
+static uint32_t session_ms(uint32_t tod_ms) {
+    return tod_ms >= 18 * 3600000 ? tod_ms - 18 * 3600000 : tod_ms + 6 * 3600000;
+}
+
+struct Generated {
+    TickVector ticks;
+    std::vector<int64_t> volume;      // 每个合约期望的 bar 成交量之和
+    std::vector<double> turnover;
+    std::vector<uint64_t> bars;       // 每个周期期望的 bar 数 (所有合约相同)
+};
+
+static void generate(Generated& g, size_t ops, size_t instruments, const std::vector<uint32_t>& periods) {
+    const size_t pairs = instruments / 2;
+    const size_t rounds = ops / instruments;
+    const size_t per_day = rounds / 2;
+    std::mt19937_64 rng(11);
+    std::vector<int64_t> px(pairs, 40000), cum_volume(pairs, 0);
+    std::vector<double> cum_turnover(pairs, 0);
+    g.ticks.resize(rounds * instruments);
+    g.volume.assign(instruments, 0);
+    g.turnover.assign(instruments, 0);
+    g.bars.assign(periods.size(), 0);
+    std::vector<uint64_t> last_key(periods.size(), UINT64_MAX);
+
+    char time[16];
+    size_t n = 0;
+    for (size_t r = 0; r < rounds; ++r) {
+        const size_t d = r < per_day ? 0 : 1;
+        const size_t rd = d == 0 ? r : r - per_day;
+        const bool first_of_day = rd == 0;
+        const uint32_t tod = trading_time((uint32_t)((uint64_t)rd * DAY_TRADING_MS / (rounds - per_day)));
+        const bool night = tod >= 18 * 3600000;
+        const uint32_t clock_ms = tod % 86400000;
+        snprintf(time, sizeof(time), "%02u:%02u:%02u", clock_ms / 3600000, clock_ms / 60000 % 60, clock_ms / 1000 % 60);
+        const char* natural = !night ? DAYS[d].day : tod < 86400000 ? DAYS[d].night_before_midnight
+                                                                    : DAYS[d].night_after_midnight;
+        const int64_t ts = exchange_time_ns(natural, time, (int)(clock_ms % 1000));
+        const uint32_t czce_day = tick_detail::parse_yyyymmdd(natural);
+
+        for (size_t p = 0; p < periods.size(); ++p) {
+            const uint64_t key = (uint64_t)DAYS[d].trading_day << 32 | (session_ms(clock_ms) / (periods[p] * 1000));
+            if (key != last_key[p]) g.bars[p]++;
+            last_key[p] = key;
+        }
+
+        for (size_t j = 0; j < pairs; ++j) {
+            px[j] += (int64_t)(rng() % 5) - 2;
+            const int64_t dv = (int64_t)(rng() % 20);
+            if (first_of_day) {
+                // 第一个交易日从盘中启动，第一笔只作为基准；第二个交易日累计值从 0 开始
+                cum_volume[j] = d == 0 ? 5000 : 0;
+                cum_turnover[j] = d == 0 ? 5000.0 * 40000 * 10 : 0;
+            }
+            cum_volume[j] += dv;
+            cum_turnover[j] += (double)dv * px[j] * 10;
+            if (!(d == 0 && first_of_day)) {
+                g.volume[2 * j] += dv + (first_of_day ? cum_volume[j] - dv : 0);
+                g.turnover[2 * j] += first_of_day ? cum_turnover[j] : (double)dv * px[j] * 10;
+            }
+            for (size_t k = 0; k < 2; ++k) {
+                Tick& tick = g.ticks[n++];
+                memset(&tick, 0, sizeof(Tick));
+                tick.instrument_id = (uint16_t)(2 * j + k);
+                tick.exchange_ts_ns = ts;
+                tick.trading_day = k == 0 ? DAYS[d].trading_day : czce_day;
+                tick.last_px = px[j];
+                tick.volume = (int32_t)cum_volume[j];
+                tick.turnover = cum_turnover[j];
+                tick.open_interest = 100000;
+            }
+        }
+    }
+    for (size_t j = 0; j < pairs; ++j) {
+        g.volume[2 * j + 1] = g.volume[2 * j];
+        g.turnover[2 * j + 1] = g.turnover[2 * j];
+    }
+}
+
+// 按 (合约, 周期) 累计 bar 的成交量/成交额/个数，对 bar 内容做滚动哈希，检查 bar 严格递增
+struct CheckSink {
+    size_t periods;
+    std::vector<uint32_t> period_sec;
+    std::vector<int64_t> volume;
+    std::vector<double> turnover;
+    std::vector<uint64_t> count;
+    std::vector<uint64_t> hash;
+    std::vector<uint64_t> last_key;
+    uint64_t out_of_order;
+
+    CheckSink(size_t instruments, const std::vector<uint32_t>& p)
+        : periods(p.size()), period_sec(p), volume(instruments * p.size(), 0), turnover(instruments * p.size(), 0),
+          count(instruments * p.size(), 0), hash(instruments * p.size(), 0), last_key(instruments * p.size(), 0),
+          out_of_order(0) {}
+
+    inline void onBar(const Bar& bar) {
+        size_t p = 0;
+        while (period_sec[p] != bar.period_sec) ++p;
+        const size_t i = bar.instrument_id * periods + p;
+        volume[i] += bar.volume;
+        turnover[i] += bar.turnover;
+        count[i]++;
+        const uint64_t key = (uint64_t)bar.trading_day << 32 | session_ms(bar.start_sec * 1000);
+        if (key <= last_key[i]) out_of_order++;
+        last_key[i] = key;
+        const uint64_t fields[] = {(uint64_t)bar.open, (uint64_t)bar.high, (uint64_t)bar.low, (uint64_t)bar.close,
+                                   (uint64_t)bar.volume, bar.ticks, bar.trading_day, bar.start_sec};
+        for (size_t k = 0; k < sizeof(fields) / sizeof(fields[0]); ++k) hash[i] = hash[i] * 1099511628211ULL ^ fields[k];
+    }
+};
+
+int main(int argc, char* argv[]) {
+    const size_t ops = argc > 1 ? (size_t)strtoull(argv[1], nullptr, 10) : 1000000;
+    const size_t instruments = argc > 2 ? (size_t)strtoull(argv[2], nullptr, 10) : 64;
+    std::vector<uint32_t> periods;
+    const std::string period_list = argc > 3 ? argv[3] : "1,60,300";
+    for (size_t pos = 0; pos < period_list.size();) {
+        size_t comma = period_list.find(',', pos);
+        if (comma == std::string::npos) comma = period_list.size();
+        periods.push_back((uint32_t)atoi(period_list.substr(pos, comma - pos).c_str()));
+        pos = comma + 1;
+    }
+    for (size_t p = 0; p < periods.size(); ++p) {
+        if (!BarAggregator::valid_period(periods[p])) {
+            std::cerr << "period must divide 86400: " << periods[p] << std::endl;
+            return 1;
+        }
+    }
+    if (instruments < 2 || instruments % 2 != 0 || instruments > 65534 || ops / instruments < 4 ||
+        periods.empty() || periods.size() > BarAggregator::MAX_PERIODS) {
+        std::cerr << "instruments must be even, ops >= 4 * instruments, 1.." << BarAggregator::MAX_PERIODS
+                  << " periods" << std::endl;
+        return 1;
+    }
+    if (!TscClock::calibrate(100000000ULL)) {
+        std::cerr << "TSC calibration failed." << std::endl;
+        return 1;
+    }
+
+    Generated g;
+    generate(g, ops, instruments, periods);
+    const size_t n = g.ticks.size();
+
+    BarAggregator bars(instruments, periods);
+    CheckSink sink(instruments, periods);
+    const uint64_t t0 = bench::now_ns();
+    for (size_t i = 0; i < n; ++i) bars.update(g.ticks[i], sink);
+    bars.flush(sink);
+    const double seconds = (bench::now_ns() - t0) / 1e9;
+
+    printf("=== %zu ticks, %zu instruments, %zu periods: %.2f M ticks/s, %llu bars, %llu late ===\n", n, instruments,
+           periods.size(), n / seconds / 1e6, (unsigned long long)bars.bar_count(),
+           (unsigned long long)bars.late_count());
+
+    uint64_t volume_mismatch = 0, turnover_mismatch = 0, count_mismatch = 0, pair_mismatch = 0;
+    for (size_t id = 0; id < instruments; ++id) {
+        for (size_t p = 0; p < periods.size(); ++p) {
+            const size_t i = id * periods.size() + p;
+            volume_mismatch += sink.volume[i] != g.volume[id];
+            turnover_mismatch += std::fabs(sink.turnover[i] - g.turnover[id]) > 1e-6 * (std::fabs(g.turnover[id]) + 1);
+            count_mismatch += sink.count[i] != g.bars[p];
+            if (id % 2 == 1) pair_mismatch += sink.hash[i] != sink.hash[i - periods.size()];
+        }
+    }
+    for (size_t p = 0; p < periods.size(); ++p) {
+        printf("  %5us bars: %llu per instrument\n", periods[p], (unsigned long long)g.bars[p]);
+    }
+    const bool ok = volume_mismatch == 0 && turnover_mismatch == 0 && count_mismatch == 0 && pair_mismatch == 0 &&
+                    sink.out_of_order == 0 && bars.late_count() == 0;
+    printf("check: volume %llu, turnover %llu, bar count %llu, SHFE/CZCE pair %llu mismatches, out of order %llu, %s\n",
+           (unsigned long long)volume_mismatch, (unsigned long long)turnover_mismatch,
+           (unsigned long long)count_mismatch, (unsigned long long)pair_mismatch,
+           (unsigned long long)sink.out_of_order, ok ? "OK" : "INCONSISTENT");
+    return ok ? 0 : 1;
+}
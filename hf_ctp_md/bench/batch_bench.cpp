@@ -0,0 +1,112 @@
+// MarketDataEngine 批量取数基准：队列驻留时间 p50/p99 与批大小的关系
+//
+// 生产者模拟集合竞价/行情风暴：连续推送 burst 个 Tick 后空闲 gap_us 微秒；
+// 消费者按 peek_batch(batch) 取数，每个 tick 模拟 work_ns 纳秒的策略计算，
+// 整批处理完才 release。驻留时间 = 消费者处理该 tick 时刻 - 生产者入队时刻。
+//
+// 用法: batch_bench [ops] [burst] [gap_us] [work_ns] [producer_cpu] [consumer_cpu]
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <immintrin.h>
+#include "SPSCQueue.h"
+#include "Tick.h"
+#include "TscClock.h"
+#include "BenchUtil.h"
+
+struct BenchConfig {
+    size_t ops;
+    size_t burst;
+    uint64_t gap_ns;
+    uint64_t work_cycles;
+    int producer_cpu;
+    int consumer_cpu;
+};
+
+static void run_batch(const BenchConfig& cfg, size_t batch_size) {
+    SPSCQueue<Tick> queue(4096);
+    std::vector<int64_t> residence;
+    residence.reserve(cfg.ops);
+    std::atomic<bool> ready(false);
+    size_t batches = 0;
+
+    std::thread consumer([&]() {
+        bench::pin_current_thread(cfg.consumer_cpu);
+        ready.store(true, std::memory_order_release);
+        while (residence.size() < cfg.ops) {
+            SPSCQueue<Tick>::Span batch = queue.peek_batch(batch_size);
+            if (batch.empty()) {
+                _mm_pause();
+                continue;
+            }
+            for (const Tick& md : batch) {
+                const uint64_t t = TscClock::rdtsc();
+                residence.push_back(TscClock::to_wall_ns(t) - md.receive_ns);
+                // 模拟策略计算
+                while (TscClock::rdtsc() - t < cfg.work_cycles) {}
+            }
+            queue.release(batch.size());
+            ++batches;
+        }
+    });
+
+    bench::pin_current_thread(cfg.producer_cpu);
+    while (!ready.load(std::memory_order_acquire)) _mm_pause();
+
+    for (size_t sent = 0; sent < cfg.ops; ) {
+        const size_t end = std::min(cfg.ops, sent + cfg.burst);
+        for (; sent < end; ++sent) {
+            Tick* md;
+            while ((md = queue.claim()) == nullptr) _mm_pause();
+            md->receive_ns = TscClock::wall_ns();
+            queue.commit();
+        }
+        const uint64_t g0 = bench::now_ns();
+        while (bench::now_ns() - g0 < cfg.gap_ns) _mm_pause();
+    }
+    consumer.join();
+
+    std::sort(residence.begin(), residence.end());
+    const int64_t* s = residence.data();
+    const size_t n = residence.size();
+    std::cout << std::setw(8) << batch_size
+              << std::fixed << std::setprecision(0)
+              << std::setw(12) << bench::percentile(s, n, 0.50)
+              << std::setw(12) << bench::percentile(s, n, 0.99)
+              << std::setw(12) << bench::percentile(s, n, 0.999)
+              << std::setprecision(1)
+              << std::setw(12) << (double)n / batches << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig cfg;
+    cfg.ops = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000;
+    cfg.burst = argc > 2 ? strtoull(argv[2], nullptr, 10) : 512;
+    cfg.gap_ns = (argc > 3 ? strtoull(argv[3], nullptr, 10) : 50) * 1000;
+    const uint64_t work_ns = argc > 4 ? strtoull(argv[4], nullptr, 10) : 40;
+    cfg.producer_cpu = argc > 5 ? atoi(argv[5]) : 0;
+    cfg.consumer_cpu = argc > 6 ? atoi(argv[6]) : 1;
+    if (cfg.burst == 0) cfg.burst = 1;
+
+    TscClock::calibrate(50000000ULL);
+    const double cycles_per_ns = TscClock::ghz();
+    cfg.work_cycles = (uint64_t)(work_ns * cycles_per_ns);
+
+    std::cout << "=== MarketDataEngine batch drain benchmark ===" << std::endl;
+    std::cout << "ops=" << cfg.ops << " burst=" << cfg.burst
+              << " gap=" << cfg.gap_ns / 1000 << "us work=" << work_ns << "ns"
+              << " tsc=" << std::setprecision(3) << cycles_per_ns << "GHz" << std::endl;
+    std::cout << std::setw(8) << "batch" << std::setw(12) << "p50(ns)" << std::setw(12) << "p99(ns)"
+              << std::setw(12) << "p99.9(ns)" << std::setw(12) << "avg_batch" << std::endl;
+
+    const size_t batch_sizes[] = {1, 4, 16, 64, 256};
+    for (size_t b : batch_sizes) {
+        run_batch(cfg, b);
+    }
+    return 0;
+}
@@ -0,0 +1,183 @@
+// 五档盘口变化检测基准：OrderBookTable (SIMD 比较) 对比逐字段比较
+//
+// 生成 ops 笔行情 (合约轮转)，按比例模拟：一档数量变化、多档数量变化、价格整体移动一个 tick、
+// 盘口不变 (只有成交)。测量每笔行情的平均周期数：
+// - scalar / simd mask：与 OrderBookTable::update(tick) 相同的循环 (比较、有变化时写回盘口)，
+//   只有比较函数不同：changed_fields_scalar 对比 changed_fields，各测 REPEATS 次取最小值
+// - simd deltas：OrderBookTable::update(tick, out)，生成 BookDelta
+// 一致性：每笔的 SIMD 位图与逐字段比较相同；把 BookDelta 依次应用到镜像盘口后与 tick 的五档完全一致
+//
+// 用法: book_bench [ops] [rounds] [instruments]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "AlignedAllocator.h"
+#include "OrderBook.h"
+#include "TscClock.h"
+#include "BenchUtil.h"
+
+typedef std::vector<Tick, AlignedAllocator<Tick> > TickVector;
+typedef OrderBookTable::Book Book;
+typedef std::vector<Book, AlignedAllocator<Book> > BookVector;
+
+static void make_ticks(TickVector& ticks, size_t instruments) {
+    std::mt19937_64 rng(7);
+    std::vector<int32_t> mid(instruments, 5000);
+    std::vector<int32_t> depth(instruments * 10, 10); // 每个合约 买一~买五、卖一~卖五 的数量
+    std::vector<int32_t> volume(instruments, 0);
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        const size_t id = i % instruments;
+        int32_t* vol = &depth[id * 10];
+        const unsigned r = (unsigned)(rng() % 100);
+        if (r < 50) {
+            vol[(rng() % 2) * 5] = 1 + (int32_t)(rng() % 50);
+        } else if (r < 70) {
+            for (int k = 0; k < 10; ++k) {
+                if (rng() % 3 == 0) vol[k] = 1 + (int32_t)(rng() % 50);
+            }
+        } else if (r < 80) {
+            mid[id] += rng() % 2 ? 1 : -1;
+        }
+        volume[id] += 1 + (int32_t)(rng() % 3);
+
+        Tick& tick = ticks[i];
+        memset(&tick, 0, sizeof(Tick));
+        tick.instrument_id = (uint16_t)id;
+        tick.volume = volume[id];
+        for (int k = 0; k < 5; ++k) {
+            tick.bid_px[k] = mid[id] - 1 - k;
+            tick.ask_px[k] = mid[id] + 1 + k;
+            tick.bid_vol[k] = vol[k];
+            tick.ask_vol[k] = vol[5 + k];
+        }
+    }
+}
+
+static bool check(const TickVector& ticks, size_t instruments, uint64_t& total_deltas) {
+    OrderBookTable table(instruments);
+    BookVector mirror(instruments);
+    memset(static_cast<void*>(mirror.data()), 0, sizeof(Book) * instruments);
+    BookDelta deltas[OrderBookTable::MAX_DELTAS];
+    uint64_t mask_mismatch = 0, book_mismatch = 0;
+    total_deltas = 0;
+
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        const Tick& tick = ticks[i];
+        const Book& before = table.book(tick.instrument_id);
+        if (orderbook_detail::changed_fields(before.bid_px, tick.bid_px) !=
+            orderbook_detail::changed_fields_scalar(before.bid_px, tick.bid_px)) {
+            mask_mismatch++;
+        }
+        const size_t n = table.update(tick, deltas);
+        total_deltas += n;
+        Book& book = mirror[tick.instrument_id];
+        for (size_t k = 0; k < n; ++k) {
+            const BookDelta& d = deltas[k];
+            int32_t* px = d.side ? book.ask_px : book.bid_px;
+            int32_t* vol = d.side ? book.ask_vol : book.bid_vol;
+            if (px[d.level] != d.prev_px || vol[d.level] != d.prev_vol) book_mismatch++;
+            px[d.level] = d.px;
+            vol[d.level] = d.vol;
+        }
+        if (memcmp(book.bid_px, tick.bid_px, orderbook_detail::FIELDS * sizeof(int32_t)) != 0) book_mismatch++;
+    }
+    printf("check: SIMD/scalar mask mismatches %llu, book mismatches %llu, %s\n", (unsigned long long)mask_mismatch,
+           (unsigned long long)book_mismatch, mask_mismatch == 0 && book_mismatch == 0 ? "OK" : "INCONSISTENT");
+    return mask_mismatch == 0 && book_mismatch == 0;
+}
+
+static const int REPEATS = 5;
+
+// 每种比较一个类型，模板各自实例化，比较函数内联进循环
+struct ScalarCompare {
+    uint32_t operator()(const int32_t* a, const int32_t* b) const {
+        return orderbook_detail::changed_fields_scalar(a, b);
+    }
+};
+struct SimdCompare {
+    uint32_t operator()(const int32_t* a, const int32_t* b) const { return orderbook_detail::changed_fields(a, b); }
+};
+
+// 与 OrderBookTable::update(tick) 相同：比较，有变化时写回五档、交易所时间和计数；返回 REPEATS 次中最少的周期数
+template<typename Compare>
+static uint64_t run_mask(const TickVector& ticks, size_t instruments, size_t rounds, Compare compare) {
+    uint64_t best = ~0ULL, levels = 0;
+    for (int rep = 0; rep < REPEATS; ++rep) {
+        BookVector books(instruments);
+        memset(static_cast<void*>(books.data()), 0, sizeof(Book) * instruments);
+        const uint64_t t0 = TscClock::rdtsc();
+        for (size_t r = 0; r < rounds; ++r) {
+            for (size_t i = 0; i < ticks.size(); ++i) {
+                const Tick& tick = ticks[i];
+                Book& book = books[tick.instrument_id];
+                const uint32_t fields = compare(book.bid_px, tick.bid_px);
+                if (fields) {
+                    memcpy(book.bid_px, tick.bid_px, orderbook_detail::FIELDS * sizeof(int32_t));
+                    book.exchange_ts_ns = tick.exchange_ts_ns;
+                    book.updates++;
+                }
+                levels += orderbook_detail::changed_levels(fields);
+            }
+        }
+        const uint64_t cycles = TscClock::rdtsc() - t0;
+        if (cycles < best) best = cycles;
+    }
+    bench::do_not_optimize(levels);
+    return best;
+}
+
+static void print_cycles(const char* name, uint64_t cycles, uint64_t n) {
+    const double per = (double)cycles / n;
+    printf("  %-12s %6.2f cycles/tick (%5.2f ns)\n", name, per, per / TscClock::ghz());
+}
+
+int main(int argc, char* argv[]) {
+    const size_t ops = argc > 1 ? (size_t)strtoull(argv[1], nullptr, 10) : 1 << 18;
+    const size_t rounds = argc > 2 ? (size_t)strtoull(argv[2], nullptr, 10) : 20;
+    const size_t instruments = argc > 3 ? (size_t)strtoull(argv[3], nullptr, 10) : 64;
+    if (ops == 0 || instruments == 0 || instruments > 65535) {
+        std::cerr << "ops must be > 0 and instruments in 1..65535" << std::endl;
+        return 1;
+    }
+    if (!TscClock::calibrate(100000000ULL)) {
+        std::cerr << "TSC calibration failed." << std::endl;
+        return 1;
+    }
+
+    TickVector ticks(ops);
+    make_ticks(ticks, instruments);
+    uint64_t total_deltas = 0;
+    const bool ok = check(ticks, instruments, total_deltas);
+#if defined(__AVX512F__)
+    const char* isa = "AVX-512";
+#elif defined(__AVX2__)
+    const char* isa = "AVX2";
+#else
+    const char* isa = "SSE2";
+#endif
+    printf("=== %zu ticks x %zu rounds, %zu instruments, %s, %.2f deltas per tick ===\n", ops, rounds, instruments,
+           isa, (double)total_deltas / ops);
+
+    print_cycles("scalar", run_mask(ticks, instruments, rounds, ScalarCompare()), rounds * ops);
+    print_cycles("simd mask", run_mask(ticks, instruments, rounds, SimdCompare()), rounds * ops);
+    // SIMD + BookDelta
+    {
+        OrderBookTable table(instruments);
+        BookDelta deltas[OrderBookTable::MAX_DELTAS];
+        int64_t sum = 0;
+        const uint64_t t0 = TscClock::rdtsc();
+        for (size_t r = 0; r < rounds; ++r) {
+            for (size_t i = 0; i < ops; ++i) {
+                const size_t n = table.update(ticks[i], deltas);
+                for (size_t k = 0; k < n; ++k) sum += deltas[k].vol;
+            }
+        }
+        print_cycles("simd deltas", TscClock::rdtsc() - t0, rounds * ops);
+        bench::do_not_optimize(sum);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,121 @@
+// 共享内存行情总线基准：一个写线程 + N 个读线程 (每个读线程独立挂载，与跨进程读取相同)
+//
+// 写线程尽快发布 ops 条 tick (序号写在 exchange_ts_ns 里)，读线程用 read() 读取，
+// 检查序号严格递增、received + missed == ops (写端关闭后读完剩余数据)，并统计写 -> 读的延迟 (TSC 周期)。
+// 最后一个读线程每读 slow_every 条睡 1ms，用来演示被套圈后的检测和重新定位
+//
+// 用法: bus_bench [ops] [readers] [capacity] [slow_every] [writer_cpu] [first_reader_cpu]
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <immintrin.h>
+#include "ShmBus.h"
+#include "TscClock.h"
+#include "BenchUtil.h"
+
+struct ReaderResult {
+    uint64_t received;
+    uint64_t lapped;
+    uint64_t missed;
+    uint64_t out_of_order;
+    std::vector<uint64_t> latency; // 抽样的写 -> 读周期数
+};
+
+static void reader_main(const std::string& name, uint64_t ops, uint64_t slow_every, int cpu,
+                        std::atomic<int>& ready, ReaderResult& result) {
+    bench::pin_current_thread(cpu);
+    ShmBusReader bus;
+    if (!bus.open(name, "")) {
+        ready++;
+        return;
+    }
+    bus.seek_oldest();
+    ready++;
+
+    Tick tick;
+    int64_t last = -1;
+    result.out_of_order = 0;
+    result.latency.reserve(ops / 64 + 1);
+    for (;;) {
+        if (!bus.read(tick)) {
+            if (bus.writer_closed()) break;
+            _mm_pause();
+            continue;
+        }
+        // 序号只能前进；被套圈时跳过的部分计入 missed
+        if (tick.exchange_ts_ns <= last) result.out_of_order++;
+        last = tick.exchange_ts_ns;
+        if ((tick.exchange_ts_ns & 63) == 0) result.latency.push_back(TscClock::rdtsc() - (uint64_t)tick.receive_ns);
+        if (slow_every && bus.received() % slow_every == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    result.received = bus.received();
+    result.lapped = bus.lapped();
+    result.missed = bus.missed();
+}
+
+int main(int argc, char* argv[]) {
+    const uint64_t ops = argc > 1 ? strtoull(argv[1], nullptr, 10) : 5000000;
+    const size_t readers = argc > 2 ? (size_t)strtoull(argv[2], nullptr, 10) : 3;
+    const size_t capacity = argc > 3 ? (size_t)strtoull(argv[3], nullptr, 10) : ShmBusWriter::DEFAULT_CAPACITY;
+    const uint64_t slow_every = argc > 4 ? strtoull(argv[4], nullptr, 10) : 100000;
+    const int writer_cpu = argc > 5 ? atoi(argv[5]) : -1;
+    const int reader_cpu = argc > 6 ? atoi(argv[6]) : -1;
+
+    if (!TscClock::calibrate(100000000ULL)) {
+        std::cerr << "TSC calibration failed." << std::endl;
+        return 1;
+    }
+
+    InstrumentRegistry registry;
+    registry.add("bench", 1.0);
+    registry.build();
+
+    const std::string name = "hf_bus_bench";
+    ShmBusWriter writer;
+    if (!writer.open(name, capacity, registry, "")) return 1;
+
+    std::atomic<int> ready(0);
+    std::vector<ReaderResult> results(readers);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < readers; ++i) {
+        const uint64_t slow = i + 1 == readers ? slow_every : 0;
+        threads.emplace_back(reader_main, name, ops, slow, reader_cpu < 0 ? -1 : reader_cpu + (int)i,
+                             std::ref(ready), std::ref(results[i]));
+    }
+    while (ready.load() < (int)readers) std::this_thread::yield();
+
+    bench::pin_current_thread(writer_cpu);
+    Tick tick;
+    memset(&tick, 0, sizeof(tick));
+    const uint64_t start = bench::now_ns();
+    for (uint64_t i = 0; i < ops; ++i) {
+        tick.exchange_ts_ns = (int64_t)i;
+        tick.receive_ns = (int64_t)TscClock::rdtsc();
+        writer.publish(tick);
+    }
+    const double write_s = (bench::now_ns() - start) / 1e9;
+    writer.close();
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+
+    printf("writer: %llu ticks in %.3f s (%.1f M ticks/s), %zu slots\n", (unsigned long long)ops, write_s,
+           ops / write_s / 1e6, capacity);
+    bool ok = true;
+    for (size_t i = 0; i < readers; ++i) {
+        ReaderResult& r = results[i];
+        std::sort(r.latency.begin(), r.latency.end());
+        const size_t n = r.latency.size();
+        const bool consistent = r.out_of_order == 0 && r.received + r.missed == ops;
+        ok = ok && consistent;
+        printf("reader %zu%s: received %llu, lapped %llu, missed %llu, latency P50 %.0f ns P99 %.0f ns, %s\n", i,
+               i + 1 == readers && slow_every ? " (slow)" : "", (unsigned long long)r.received,
+               (unsigned long long)r.lapped, (unsigned long long)r.missed,
+               n ? (double)TscClock::to_ns((int64_t)bench::percentile(r.latency.data(), n, 0.50)) : 0.0,
+               n ? (double)TscClock::to_ns((int64_t)bench::percentile(r.latency.data(), n, 0.99)) : 0.0,
+               consistent ? "OK" : "INCONSISTENT");
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+// 列式日文件基准：合成一天的行情，测编码/解码吞吐、压缩率和单合约区间查询读取的块数
+//
+// 行情按 CTP 的节奏生成：每个合约每 500ms 一笔，价格按最小变动价位随机游走，
+// 成交量递增，五档围绕最新价展开
+// 读回后逐条与原始 tick 比对，区间查询结果与暴力扫描比对
+//
+// 用法: columnar_bench [path] [ticks] [instruments] [block_ticks] [max_pending_ticks]
+//   max_pending_ticks 取小值时写入端会提前写出不满的块，用来检查一个合约多个不满块的读回和区间查询
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "AlignedAllocator.h"
+#include "ColumnarReader.h"
+#include "ColumnarWriter.h"
+#include "TickJournal.h"
+#include "BenchUtil.h"
+
+typedef std::vector<Tick, AlignedAllocator<Tick> > TickVector;
+
+static uint64_t xorshift(uint64_t& s) {
+    s ^= s >> 12;
+    s ^= s << 25;
+    s ^= s >> 27;
+    return s * 2685821657736338717ULL;
+}
+
+static void generate(TickVector& ticks, size_t count, size_t instruments) {
+    const int64_t day_start = 1735693200LL * 1000000000LL; // 2025-01-01 09:00 CST
+    std::vector<int64_t> px(instruments), oi(instruments);
+    std::vector<int32_t> volume(instruments, 0);
+    std::vector<double> turnover(instruments, 0);
+    uint64_t rng = 88172645463325252ULL;
+    for (size_t i = 0; i < instruments; ++i) {
+        px[i] = 3000 + (int64_t)(xorshift(rng) % 5000);
+        oi[i] = 100000 + (int64_t)(xorshift(rng) % 100000);
+    }
+
+    ticks.resize(count);
+    for (size_t n = 0; n < count; ++n) {
+        const size_t id = n % instruments;
+        Tick& t = ticks[n];
+        memset(&t, 0, sizeof(t));
+        const uint64_t r = xorshift(rng);
+        px[id] += (int64_t)(r % 5) - 2;
+        const int32_t traded = (int32_t)((r >> 8) % 20);
+        volume[id] += traded;
+        turnover[id] += (double)traded * px[id] * 10;
+        oi[id] += (int64_t)((r >> 16) % 7) - 3;
+
+        t.instrument_id = (uint16_t)id;
+        t.exchange_ts_ns = day_start + (int64_t)(n / instruments) * 500000000LL;
+        t.receive_ns = t.exchange_ts_ns + 3000000 + (int64_t)((r >> 24) % 200000);
+        t.last_px = px[id];
+        t.volume = volume[id];
+        t.turnover = turnover[id];
+        t.open_interest = (int32_t)oi[id];
+        t.trading_day = 20250101;
+        for (int k = 0; k < 5; ++k) {
+            t.bid_px[k] = (int32_t)(px[id] - 1 - k);
+            t.ask_px[k] = (int32_t)(px[id] + 1 + k);
+            t.bid_vol[k] = 1 + (int32_t)((r >> (32 + k * 3)) % 50);
+            t.ask_vol[k] = 1 + (int32_t)((r >> (35 + k * 3)) % 50);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const std::string path = argc > 1 ? argv[1] : "columnar_bench.tc";
+    const size_t count = argc > 2 ? (size_t)strtoull(argv[2], nullptr, 10) : 2000000;
+    const size_t instruments = argc > 3 ? (size_t)strtoull(argv[3], nullptr, 10) : 100;
+    const size_t block_ticks = argc > 4 ? (size_t)strtoull(argv[4], nullptr, 10) : (size_t)ColumnarWriter::DEFAULT_BLOCK_TICKS;
+    const size_t max_pending = argc > 5 ? (size_t)strtoull(argv[5], nullptr, 10) : (size_t)ColumnarWriter::DEFAULT_MAX_PENDING_TICKS;
+
+    TickVector ticks;
+    generate(ticks, count, instruments);
+
+    // 编码
+    ColumnarWriter writer(block_ticks, max_pending);
+    if (!writer.open(path, 20250101)) return 1;
+    for (size_t i = 0; i < instruments; ++i) {
+        char id[32];
+        snprintf(id, sizeof(id), "IF%04zu", i);
+        writer.add_instrument(id, 0.2);
+    }
+    uint64_t start = bench::now_ns();
+    for (size_t i = 0; i < count; ++i) writer.append(ticks[i]);
+    if (!writer.close()) return 1;
+    const double encode_s = (bench::now_ns() - start) / 1e9;
+    const double raw_mb = count * (double)journal::TICK_RECORD_SIZE / 1048576.0;
+    printf("encode: %zu ticks in %.3f s (%.1f M ticks/s), %.1f MB journal-equivalent -> %.1f MB (%.2fx, %.1f bytes/tick)\n",
+           count, encode_s, count / encode_s / 1e6, raw_mb, writer.file_size() / 1048576.0,
+           raw_mb * 1048576.0 / writer.file_size(), (double)writer.file_size() / count);
+    printf("blocks: %zu (%llu flushed early, pending budget %zu ticks)\n",
+           writer.block_count(), (unsigned long long)writer.budget_flushes(), max_pending);
+
+    ColumnarReader reader;
+    if (!reader.open(path)) return 1;
+
+    // 全量解码并逐条比对 (原始 tick 按合约分组后保持顺序)
+    std::vector<size_t> cursor(instruments, 0);
+    std::vector<std::vector<size_t> > by_instrument(instruments);
+    for (size_t i = 0; i < count; ++i) by_instrument[ticks[i].instrument_id].push_back(i);
+
+    TickVector block(block_ticks);
+    bool ok = true;
+    uint64_t decoded = 0;
+    start = bench::now_ns();
+    for (uint16_t id = 0; id < reader.instrument_count(); ++id) {
+        for (size_t b = 0; b < reader.block_count(id); ++b) {
+            const columnar::BlockEntry& entry = reader.block(id, b);
+            if (block.size() < entry.tick_count) block.resize(entry.tick_count);
+            const size_t n = reader.decode_block(entry, block.data());
+            for (size_t i = 0; i < n && ok; ++i) {
+                ok = memcmp(&block[i], &ticks[by_instrument[id][cursor[id]++]], sizeof(Tick)) == 0;
+            }
+            decoded += n;
+        }
+    }
+    const double decode_s = (bench::now_ns() - start) / 1e9;
+    printf("decode+compare: %llu ticks in %.3f s, round trip %s\n",
+           (unsigned long long)decoded, decode_s, ok && decoded == count ? "OK" : "MISMATCH");
+
+    // 只解码时间和最新价两列
+    start = bench::now_ns();
+    int64_t checksum = 0;
+    const uint32_t columns = columnar::column_bit(columnar::COL_EXCHANGE_TS) | columnar::column_bit(columnar::COL_LAST_PX);
+    for (uint16_t id = 0; id < reader.instrument_count(); ++id) {
+        for (size_t b = 0; b < reader.block_count(id); ++b) {
+            const size_t n = reader.decode_block(reader.block(id, b), block.data(), columns);
+            for (size_t i = 0; i < n; ++i) checksum += block[i].last_px;
+        }
+    }
+    bench::do_not_optimize(checksum);
+    const double partial_s = (bench::now_ns() - start) / 1e9;
+    printf("decode ts+last_px only: %.1f M ticks/s (all columns incl. compare: %.1f M ticks/s)\n",
+           count / partial_s / 1e6, count / decode_s / 1e6);
+
+    // 区间查询：中间合约、时间轴中间 5 分钟
+    const uint16_t qid = (uint16_t)(instruments / 2);
+    const int64_t mid = ticks[count / 2].exchange_ts_ns;
+    const int64_t from = mid, to = mid + 300LL * 1000000000LL;
+    size_t expected = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (ticks[i].instrument_id == qid && ticks[i].exchange_ts_ns >= from && ticks[i].exchange_ts_ns < to) expected++;
+    }
+    start = bench::now_ns();
+    const uint64_t blocks_before = reader.blocks_decoded();
+    const size_t matched = reader.scan(qid, from, to, [&](const Tick& t) { checksum += t.last_px; });
+    const uint64_t scan_ns = bench::now_ns() - start;
+    printf("range scan %s [+5 min]: %zu ticks (expected %zu) %s, decoded %llu of %zu blocks in %.1f us\n",
+           reader.instrument(qid).instrument_id, matched, expected, matched == expected ? "OK" : "MISMATCH",
+           (unsigned long long)(reader.blocks_decoded() - blocks_before), reader.block_count(qid), scan_ns / 1e3);
+
+    // 损坏的块目录：列偏移乱序、列越过块尾、块越过文件尾都应拒绝解码而不是越界读
+    columnar::BlockEntry bad = reader.block(0, 0);
+    std::swap(bad.column_offset[columnar::COL_LAST_PX], bad.column_offset[columnar::COL_VOLUME]);
+    bool rejected = reader.decode_block(bad, block.data()) == 0;
+    bad = reader.block(0, 0);
+    bad.column_offset[columnar::NUM_COLUMNS - 1] = bad.length + 1;
+    rejected = rejected && reader.decode_block(bad, block.data()) == 0;
+    bad = reader.block(0, 0);
+    bad.offset = reader.size() - bad.length + 1;
+    rejected = rejected && reader.decode_block(bad, block.data()) == 0;
+    printf("corrupt block entries: %s\n", rejected ? "rejected OK" : "ACCEPTED");
+
+    return ok && matched == expected && rejected ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+// 策略回调分发开销基准：StrategyEngine<Handler> (编译期绑定) 对比 StrategyEngine<VirtualTickHandler> (虚函数)
+//
+// 两个变体的策略做完全相同的事 (按合约累加价格和成交量)，分两部分测量：
+// 1. loop：同一批 tick 反复分发给 handler，只有分发本身和策略计算，不经过队列
+// 2. engine：队列预先写满 ops 个 tick 后启动引擎，策略在第一笔和最后一笔记录 TSC，
+//    得到引擎每处理一个 tick 的平均周期数 (含延迟统计等引擎自身的开销)
+// 虚函数变体的具体类型在运行时选择，编译器无法去虚化；两个变体的校验和必须一致
+// 3. snapshot：队列为空、快照表里每个合约写过若干笔，两个变体的 onSnapshot 都必须收到每个合约的最后一笔
+//
+// 用法: dispatch_bench [ops] [rounds] [engine_cpu]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "AlignedAllocator.h"
+#include "MarketDataEngine.h"
+#include "TickHandler.h"
+#include "TscClock.h"
+#include "BenchUtil.h"
+
+static const size_t INSTRUMENTS = 64;
+
+typedef std::vector<Tick, AlignedAllocator<Tick> > TickVector;
+
+// 两个变体共用的策略状态
+struct StrategyState {
+    int64_t px_sum[INSTRUMENTS];
+    int64_t volume_sum[INSTRUMENTS];
+    int64_t snapshot_px[INSTRUMENTS];
+    std::atomic<uint64_t> snapshots;
+    uint64_t ticks;
+    uint64_t batches;
+    uint64_t first_tsc;
+    uint64_t last_tsc;
+
+    void reset() {
+        memset(px_sum, 0, sizeof(px_sum));
+        memset(volume_sum, 0, sizeof(volume_sum));
+        memset(snapshot_px, 0, sizeof(snapshot_px));
+        snapshots.store(0);
+        ticks = batches = first_tsc = last_tsc = 0;
+    }
+
+    inline void on_tick(const Tick& tick) {
+        px_sum[tick.instrument_id % INSTRUMENTS] += tick.last_px;
+        volume_sum[tick.instrument_id % INSTRUMENTS] += tick.volume;
+        if (ticks++ == 0) first_tsc = TscClock::rdtsc();
+    }
+
+    inline void on_snapshot(uint16_t id, const Tick& tick) {
+        snapshot_px[id % INSTRUMENTS] = tick.last_px;
+        snapshots.fetch_add(1, std::memory_order_release);
+    }
+
+    uint64_t checksum() const {
+        uint64_t sum = ticks;
+        for (size_t i = 0; i < INSTRUMENTS; ++i) sum = sum * 31 + (uint64_t)px_sum[i] + (uint64_t)volume_sum[i];
+        return sum;
+    }
+};
+
+// 编译期绑定
+struct InlineStrategy {
+    StrategyState* state;
+
+    InlineStrategy() : state(nullptr) {}
+    inline void onTick(const Tick& tick) { state->on_tick(tick); }
+    inline void onBookDelta(const BookDelta*, size_t) {}
+    inline void onBar(const Bar&) {}
+    inline void onBatchEnd() {
+        state->batches++;
+        state->last_tsc = TscClock::rdtsc();
+    }
+    inline void onSnapshot(uint16_t id, const Tick& tick) { state->on_snapshot(id, tick); }
+    inline void onIdle() {}
+};
+
+// 经虚函数接口
+class VirtualStrategy : public TickHandler {
+public:
+    explicit VirtualStrategy(StrategyState* state) : m_state(state) {}
+    virtual void onTick(const Tick& tick) { m_state->on_tick(tick); }
+    virtual void onBatchEnd() {
+        m_state->batches++;
+        m_state->last_tsc = TscClock::rdtsc();
+    }
+    virtual void onSnapshot(uint16_t id, const Tick& tick) { m_state->on_snapshot(id, tick); }
+
+private:
+    StrategyState* m_state;
+};
+
+// 另一个实现，只为让虚函数调用点保持多态
+class OtherStrategy : public TickHandler {
+public:
+    virtual void onTick(const Tick&) {}
+};
+
+static void make_ticks(TickVector& ticks) {
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        memset(&ticks[i], 0, sizeof(Tick));
+        ticks[i].instrument_id = (uint16_t)(i % INSTRUMENTS);
+        ticks[i].last_px = 1000 + (int64_t)(i % 17);
+        ticks[i].volume = (int32_t)i;
+    }
+}
+
+template<typename Handler>
+static double run_loop(Handler& handler, const TickVector& ticks, size_t rounds, size_t batch) {
+    const uint64_t t0 = TscClock::rdtsc();
+    for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < ticks.size(); i += batch) {
+            const size_t end = i + batch < ticks.size() ? i + batch : ticks.size();
+            for (size_t k = i; k < end; ++k) handler.onTick(ticks[k]);
+            handler.onBatchEnd();
+        }
+    }
+    return (double)(TscClock::rdtsc() - t0) / (rounds * ticks.size());
+}
+
+// 队列写满后启动引擎，返回每个 tick 的平均周期数
+template<typename Handler>
+static double run_engine(const Handler& handler, const StrategyState& state, const TickVector& ticks,
+                         int cpu) {
+    SPSCQueue<Tick> queue(ticks.size());
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        Tick* slot = queue.claim();
+        *slot = ticks[i];
+        slot->receive_ns = TscClock::wall_ns();
+        queue.commit();
+    }
+
+    StrategyEngine<Handler> engine(&queue, handler);
+    EngineThreadConfig cfg;
+    cfg.cpu_id = cpu;
+    cfg.prefault = false; // 预热会清空已写入的队列
+    engine.set_thread_config(cfg);
+    engine.start();
+    while (engine.tick_count() < ticks.size()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    engine.stop();
+    return state.ticks > 1 ? (double)(state.last_tsc - state.first_tsc) / (state.ticks - 1) : 0;
+}
+
+// 队列为空，快照表里每个合约写 3 笔，等引擎空闲扫描把全部合约交给 onSnapshot
+template<typename Handler>
+static bool run_snapshots(const Handler& handler, StrategyState& state) {
+    SPSCQueue<Tick> queue(2);
+    SnapshotTable<Tick> snapshots(INSTRUMENTS);
+    for (int round = 0; round < 3; ++round) {
+        for (size_t id = 0; id < INSTRUMENTS; ++id) {
+            Tick* slot = snapshots.begin_write(id);
+            memset(static_cast<void*>(slot), 0, sizeof(Tick));
+            slot->instrument_id = (uint16_t)id;
+            slot->last_px = 1000 * (round + 1) + (int64_t)id;
+            snapshots.end_write(id);
+        }
+    }
+
+    StrategyEngine<Handler> engine(&queue, handler);
+    engine.set_snapshot_table(&snapshots);
+    engine.start();
+    for (int i = 0; i < 5000 && state.snapshots.load(std::memory_order_acquire) < INSTRUMENTS; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    engine.stop();
+
+    uint64_t mismatch = 0;
+    for (size_t id = 0; id < INSTRUMENTS; ++id) mismatch += state.snapshot_px[id] != 3000 + (int64_t)id;
+    return state.snapshots.load() == INSTRUMENTS && mismatch == 0;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t ops = argc > 1 ? (size_t)strtoull(argv[1], nullptr, 10) : 1 << 16;
+    const size_t rounds = argc > 2 ? (size_t)strtoull(argv[2], nullptr, 10) : 200;
+    const int engine_cpu = argc > 3 ? atoi(argv[3]) : -1;
+
+    if (ops < 2 || (ops & (ops - 1)) != 0) {
+        std::cerr << "ops must be a power of two >= 2 (queue capacity)." << std::endl;
+        return 1;
+    }
+    if (!TscClock::calibrate(100000000ULL)) {
+        std::cerr << "TSC calibration failed." << std::endl;
+        return 1;
+    }
+
+    TickVector ticks(ops);
+    make_ticks(ticks);
+    StrategyState inline_state, virtual_state;
+    OtherStrategy other;
+    VirtualStrategy impl(&virtual_state);
+    // argc 恒大于 0，但编译器不知道：调用点看到两个可能的动态类型
+    TickHandler* pHandler = argc > 0 ? static_cast<TickHandler*>(&impl) : &other;
+
+    InlineStrategy inline_handler;
+    inline_handler.state = &inline_state;
+    VirtualTickHandler virtual_handler(pHandler);
+    bool ok = true;
+
+    printf("=== loop: %zu ticks x %zu rounds, batch %zu ===\n", ops, rounds, MarketDataEngine::DEFAULT_BATCH_SIZE);
+    inline_state.reset();
+    virtual_state.reset();
+    const double inline_loop = run_loop(inline_handler, ticks, rounds, MarketDataEngine::DEFAULT_BATCH_SIZE);
+    const double virtual_loop = run_loop(virtual_handler, ticks, rounds, MarketDataEngine::DEFAULT_BATCH_SIZE);
+    printf("  template  %6.2f cycles/tick (%5.2f ns)\n", inline_loop, inline_loop / TscClock::ghz());
+    printf("  virtual   %6.2f cycles/tick (%5.2f ns)\n", virtual_loop, virtual_loop / TscClock::ghz());
+    if (inline_state.checksum() != virtual_state.checksum()) {
+        printf("  checksum mismatch\n");
+        ok = false;
+    }
+
+    printf("=== engine: %zu ticks drained by StrategyEngine ===\n", ops);
+    inline_state.reset();
+    virtual_state.reset();
+    const double inline_engine = run_engine(inline_handler, inline_state, ticks, engine_cpu);
+    const double virtual_engine = run_engine(virtual_handler, virtual_state, ticks, engine_cpu);
+    printf("  template  %6.2f cycles/tick (%5.2f ns)\n", inline_engine, inline_engine / TscClock::ghz());
+    printf("  virtual   %6.2f cycles/tick (%5.2f ns)\n", virtual_engine, virtual_engine / TscClock::ghz());
+    if (inline_state.ticks != ops || inline_state.checksum() != virtual_state.checksum()) {
+        printf("  inconsistent: template %llu ticks, virtual %llu ticks\n", (unsigned long long)inline_state.ticks,
+               (unsigned long long)virtual_state.ticks);
+        ok = false;
+    }
+    printf("=== snapshot: %zu instruments, queue empty ===\n", INSTRUMENTS);
+    inline_state.reset();
+    virtual_state.reset();
+    const bool inline_snap = run_snapshots(inline_handler, inline_state);
+    const bool virtual_snap = run_snapshots(virtual_handler, virtual_state);
+    printf("  template  %llu snapshots, %s\n", (unsigned long long)inline_state.snapshots.load(),
+           inline_snap ? "latest" : "MISMATCH");
+    printf("  virtual   %llu snapshots, %s\n", (unsigned long long)virtual_state.snapshots.load(),
+           virtual_snap ? "latest" : "MISMATCH");
+    ok = ok && inline_snap && virtual_snap;
+
+    printf("%s\n", ok ? "OK" : "INCONSISTENT");
+    return ok ? 0 : 1;
+}
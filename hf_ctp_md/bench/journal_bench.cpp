@@ -0,0 +1,160 @@
+// TickRecorder 基准：引擎线程按给定速率 append，写线程落盘
+//
+// 输出：
+// - append 在"热核"上的耗时 (ns/op) 与占用率 (append 总耗时 / 运行时长)
+// - 实际落盘速率与环满丢弃数
+// 读回文件校验记录数与序号连续性
+// 写盘失败：RLIMIT_FSIZE 限制文件大小 (pwrite 返回 EFBIG，相当于磁盘写满)，检查记录器停止写入、
+// 之后的 tick 全部计入 dropped、written + dropped 等于 append 总数，文件不超过限制
+//
+// 用法: journal_bench [path] [ticks] [rate_per_sec] [engine_cpu]
+//        rate_per_sec = 0 表示不限速 (测写线程的最大吞吐)
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstdio>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <immintrin.h>
+#include "TickRecorder.h"
+#include "TscClock.h"
+#include "BenchUtil.h"
+
+// 读回 journal，检查 receive_ns 字段里写入的序号是否连续
+static bool verify(const std::string& path, uint64_t expected) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    fstat(fd, &st);
+    const char* base = static_cast<const char*>(mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0));
+    close(fd);
+    if (base == MAP_FAILED) return false;
+
+    const journal::FileHeader* header = reinterpret_cast<const journal::FileHeader*>(base);
+    uint64_t n = 0;
+    bool ok = memcmp(header->magic, journal::MAGIC, sizeof(journal::MAGIC)) == 0 && header->tick_size == sizeof(Tick);
+    for (size_t off = header->header_size; ok && off + sizeof(journal::RecordHeader) <= (size_t)st.st_size; ) {
+        const journal::RecordHeader* rh = reinterpret_cast<const journal::RecordHeader*>(base + off);
+        if (rh->length == 0) break;
+        Tick tick;
+        memcpy(&tick, base + off + sizeof(journal::RecordHeader), sizeof(Tick));
+        if (rh->type != journal::RECORD_TICK || tick.receive_ns != (int64_t)n) ok = false;
+        ++n;
+        off += sizeof(journal::RecordHeader) + rh->length;
+    }
+    munmap(const_cast<char*>(base), st.st_size);
+    std::cout << "verify: " << n << " records, " << (ok && n == expected ? "OK" : "MISMATCH") << std::endl;
+    return ok && n == expected;
+}
+
+// 文件限制在 limit 字节时写入 ticks 笔，返回记录器是否按写盘失败处理
+static bool check_write_failure(const std::string& path, const InstrumentRegistry& registry, uint64_t ticks) {
+    const rlim_t limit = 1 << 20;
+    struct rlimit old_limit, new_limit;
+    getrlimit(RLIMIT_FSIZE, &old_limit);
+    new_limit = old_limit;
+    new_limit.rlim_cur = limit;
+    signal(SIGXFSZ, SIG_IGN);
+    setrlimit(RLIMIT_FSIZE, &new_limit);
+
+    bool ok = false;
+    {
+        TickRecorder recorder(TickRecorder::DEFAULT_RING_SIZE, 256 << 10);
+        if (recorder.open(path, 20250101, registry)) {
+            recorder.start();
+            Tick tick;
+            memset(&tick, 0, sizeof(tick));
+            for (uint64_t i = 0; i < ticks; ++i) {
+                while (i - recorder.written() - recorder.dropped() >= TickRecorder::DEFAULT_RING_SIZE) _mm_pause();
+                tick.receive_ns = (int64_t)i;
+                tick.instrument_id = (uint16_t)(i % registry.size());
+                recorder.append(tick);
+            }
+            while (recorder.written() + recorder.dropped() < ticks) usleep(1000);
+            recorder.stop();
+            struct stat st;
+            const bool size_ok = stat(path.c_str(), &st) == 0 && (uint64_t)st.st_size <= limit;
+            ok = recorder.failed() && recorder.dropped() > 0 && recorder.written() + recorder.dropped() == ticks &&
+                 size_ok;
+            std::cout << "write failure: written " << recorder.written() << ", dropped " << recorder.dropped()
+                      << ", file " << (size_ok ? st.st_size : -1) << " bytes (limit " << limit << "), "
+                      << (ok ? "OK" : "INCONSISTENT") << std::endl;
+        }
+    }
+    setrlimit(RLIMIT_FSIZE, &old_limit);
+    signal(SIGXFSZ, SIG_DFL);
+    unlink(path.c_str());
+    unlink((path + ".idx").c_str());
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    const std::string path = argc > 1 ? argv[1] : "journal_bench.tj";
+    const uint64_t ticks = argc > 2 ? strtoull(argv[2], nullptr, 10) : 5000000;
+    const uint64_t rate = argc > 3 ? strtoull(argv[3], nullptr, 10) : 1000000;
+    const int engine_cpu = argc > 4 ? atoi(argv[4]) : -1;
+
+    TscClock::calibrate(50000000ULL);
+    InstrumentRegistry registry;
+    for (int i = 0; i < 100; ++i) {
+        char id[16];
+        snprintf(id, sizeof(id), "sim%03d", i);
+        registry.add(id, 1.0);
+    }
+    registry.build();
+
+    TickRecorder recorder;
+    if (!recorder.open(path, 20250101, registry)) return 1;
+    recorder.prefault();
+    recorder.start();
+    bench::pin_current_thread(engine_cpu);
+
+    std::cout << "=== TickRecorder benchmark ===" << std::endl;
+    std::cout << "ticks=" << ticks << " rate=" << (rate ? std::to_string(rate) + "/s" : std::string("max"))
+              << " O_DIRECT=" << (recorder.direct_io() ? "on" : "off") << std::endl;
+
+    Tick tick;
+    memset(&tick, 0, sizeof(tick));
+    const uint64_t t0 = bench::now_ns();
+    uint64_t append_cycles = 0;
+    for (uint64_t i = 0; i < ticks; ++i) {
+        if (rate) {
+            const uint64_t due = t0 + i * 1000000000ULL / rate;
+            while (bench::now_ns() < due) _mm_pause();
+        } else {
+            // 不限速时等写线程腾出空位，测的是落盘吞吐而不是丢弃
+            while (i - recorder.written() >= TickRecorder::DEFAULT_RING_SIZE) _mm_pause();
+        }
+        tick.receive_ns = (int64_t)i;
+        tick.instrument_id = (uint16_t)(i % registry.size());
+        const uint64_t c0 = TscClock::rdtsc();
+        recorder.append(tick);
+        append_cycles += TscClock::rdtsc() - c0;
+    }
+    const uint64_t produce_ns = bench::now_ns() - t0;
+    while (recorder.written() + recorder.dropped() < ticks) usleep(1000);
+    const uint64_t drain_ns = bench::now_ns() - t0;
+    recorder.stop();
+
+    const double append_ns = TscClock::to_ns((int64_t)append_cycles) / (double)ticks;
+    std::cout << std::fixed << std::setprecision(1)
+              << "append: " << append_ns << " ns/op, hot-core share "
+              << std::setprecision(3) << 100.0 * TscClock::to_ns((int64_t)append_cycles) / produce_ns << "%" << std::endl
+              << std::setprecision(0)
+              << "written: " << recorder.written() << " ticks in " << drain_ns / 1000000 << " ms ("
+              << recorder.written() * 1e9 / drain_ns << " ticks/s, "
+              << recorder.written() * journal::TICK_RECORD_SIZE * 1e9 / drain_ns / (1024 * 1024) << " MB/s), dropped "
+              << recorder.dropped() << std::endl;
+
+    bool ok = recorder.dropped() > 0 || verify(path, ticks);
+    unlink(path.c_str());
+    unlink((path + ".idx").c_str());
+
+    ok = check_write_failure(path, registry, 100000) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+// 异步日志 vs std::cout 的调用线程开销
+//
+// 模拟 CTP 回调里的典型日志：合约代码 + 价格 + 整数 + GBK 错误信息。
+// 每次调用单独用 TSC 计时，输出调用线程上的 P50/P99/P99.9/Max (ns)。
+// 两者都写到 /dev/null：cout 按原来回调里的写法 << std::endl (每条 flush)，
+// 异步日志由后台线程格式化、转码后批量写出。
+// 每 burst 条休息 gap_us 微秒，模拟行情突发，同时给后台线程留出追赶的时间
+//
+// 用法: log_bench [ops] [burst] [gap_us] [cpu] [log_cpu]
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "AsyncLog.h"
+#include "TscClock.h"
+#include "BenchUtil.h"
+
+struct BenchConfig {
+    size_t ops;
+    size_t burst;
+    uint64_t gap_us;
+};
+
+static void report(const char* name, std::vector<uint64_t>& cycles) {
+    std::sort(cycles.begin(), cycles.end());
+    const size_t n = cycles.size();
+    printf("%-12s P50 %7.0f  P99 %7.0f  P99.9 %8.0f  Max %9.0f  (ns/call)\n", name,
+           (double)TscClock::to_ns((int64_t)bench::percentile(cycles.data(), n, 0.50)),
+           (double)TscClock::to_ns((int64_t)bench::percentile(cycles.data(), n, 0.99)),
+           (double)TscClock::to_ns((int64_t)bench::percentile(cycles.data(), n, 0.999)),
+           (double)TscClock::to_ns((int64_t)cycles[n - 1]));
+}
+
+template<typename Fn>
+static void run(const BenchConfig& cfg, std::vector<uint64_t>& cycles, Fn fn) {
+    cycles.resize(cfg.ops);
+    for (size_t i = 0; i < cfg.ops; ++i) {
+        const uint64_t start = TscClock::rdtsc();
+        fn(i);
+        cycles[i] = TscClock::rdtsc() - start;
+        if ((i + 1) % cfg.burst == 0) std::this_thread::sleep_for(std::chrono::microseconds(cfg.gap_us));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig cfg;
+    cfg.ops = argc > 1 ? (size_t)strtoull(argv[1], nullptr, 10) : 200000;
+    cfg.burst = argc > 2 ? (size_t)strtoull(argv[2], nullptr, 10) : 256;
+    cfg.gap_us = argc > 3 ? strtoull(argv[3], nullptr, 10) : 500;
+    const int cpu = argc > 4 ? atoi(argv[4]) : -1;
+    const int log_cpu = argc > 5 ? atoi(argv[5]) : -1;
+    if (cfg.ops == 0 || cfg.burst == 0) {
+        std::cerr << "Usage: " << argv[0] << " [ops] [burst] [gap_us] [cpu] [log_cpu]" << std::endl;
+        return 1;
+    }
+
+    if (!TscClock::calibrate(100000000ULL)) {
+        std::cerr << "TSC calibration failed." << std::endl;
+        return 1;
+    }
+    bench::pin_current_thread(cpu);
+
+    const char instrument[31] = "rb2601";
+    const char error_msg[81] = "\xb2\xe2\xca\xd4"; // GBK "测试"
+    const double price = 3512.0;
+    std::vector<uint64_t> cycles;
+
+    // std::cout 写到 /dev/null
+    std::ofstream devnull("/dev/null");
+    std::streambuf* saved = std::cout.rdbuf(devnull.rdbuf());
+    run(cfg, cycles, [&](size_t i) {
+        std::cout << "[MainThread] Subscribe Failed: " << instrument << " " << price << " " << i
+                  << " " << error_msg << std::endl;
+    });
+    std::cout.rdbuf(saved);
+    std::vector<uint64_t> cout_cycles;
+    cout_cycles.swap(cycles);
+
+    // 异步日志写到 /dev/null
+    hf_log::LogConfig log_config;
+    log_config.path = "/dev/null";
+    log_config.cpu_id = log_cpu;
+    hf_log::start(log_config);
+    run(cfg, cycles, [&](size_t i) {
+        LOG_ERROR("[MainThread] Subscribe Failed: {} {} {} {}", instrument, price, i, hf_log::gbk(error_msg));
+    });
+    hf_log::stop();
+
+    printf("%zu calls, burst %zu, gap %llu us\n", cfg.ops, cfg.burst, (unsigned long long)cfg.gap_us);
+    report("std::cout", cout_cycles);
+    report("LOG_ERROR", cycles);
+    return 0;
+}
@@ -0,0 +1,167 @@
+// tick 归一化往返校验 + 基准：CThostFtdcDepthMarketDataField -> Tick -> CThostFtdcDepthMarketDataField
+//
+// 随机生成 ops 笔原始行情 (合约代码、最小变动价位 0.01~10、价格为价位整数倍、成交量/持仓量/成交额、
+// 随机日期时间和毫秒、日盘和夜盘、每档约 1/4 概率为空档 (CTP 填 DBL_MAX、数量 0)、约 1/50 没有最新价)，检查：
+// - denormalize_tick(normalize_tick(raw)) 与 raw 在 Tick 保留的字段上完全相同：
+//   价格逐位相等，空档还原为 DBL_MAX，没有最新价时还原为 0；日期、时间、毫秒、合约代码逐字节相等
+// - 还原后再归一化得到的 Tick 与第一次逐字节相同
+// 性能：在前 WINDOW 笔 (常驻缓存) 上反复 normalize_tick，每笔的纳秒数
+//
+// 用法: normalize_bench [ops] [rounds]
+
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "AlignedAllocator.h"
+#include "Tick.h"
+#include "TscClock.h"
+#include "BenchUtil.h"
+
+typedef std::vector<Tick, AlignedAllocator<Tick> > TickVector;
+
+static const size_t WINDOW = 256; // 原始行情约 500 字节，256 笔约 128KB
+
+static const double PRICE_TICKS[] = {0.01, 0.02, 0.05, 0.2, 0.5, 1, 2, 5, 10};
+static const size_t PRICE_TICK_COUNT = sizeof(PRICE_TICKS) / sizeof(PRICE_TICKS[0]);
+
+struct Sample {
+    CThostFtdcDepthMarketDataField raw;
+    double price_tick;
+    int64_t receive_ns;
+};
+
+// 按 CTP 字段顺序取五档的指针
+struct Levels {
+    double* bid_px[5];
+    double* ask_px[5];
+    int* bid_vol[5];
+    int* ask_vol[5];
+
+    explicit Levels(CThostFtdcDepthMarketDataField& f)
+        : bid_px{&f.BidPrice1, &f.BidPrice2, &f.BidPrice3, &f.BidPrice4, &f.BidPrice5},
+          ask_px{&f.AskPrice1, &f.AskPrice2, &f.AskPrice3, &f.AskPrice4, &f.AskPrice5},
+          bid_vol{&f.BidVolume1, &f.BidVolume2, &f.BidVolume3, &f.BidVolume4, &f.BidVolume5},
+          ask_vol{&f.AskVolume1, &f.AskVolume2, &f.AskVolume3, &f.AskVolume4, &f.AskVolume5} {}
+};
+
+static void write_date(char* out, int64_t days) {
+    int y;
+    unsigned m, d;
+    tick_detail::civil_from_days(days, y, m, d);
+    tick_detail::write_digits(out, (uint32_t)y * 10000 + m * 100 + d, 8);
+}
+
+static void generate(std::vector<Sample>& samples) {
+    std::mt19937_64 rng(23);
+    const int64_t first = tick_detail::days_from_civil(2000, 1, 1);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        Sample& s = samples[i];
+        CThostFtdcDepthMarketDataField& raw = s.raw;
+        memset(&raw, 0, sizeof(raw));
+        snprintf(raw.InstrumentID, sizeof(raw.InstrumentID), "x%zu", i % 1000);
+        s.price_tick = PRICE_TICKS[rng() % PRICE_TICK_COUNT];
+
+        // 上期所填法：ActionDay 为自然日，夜盘的 TradingDay 为下一天
+        const int64_t days = first + (int64_t)(rng() % 36500);
+        const uint32_t secs = (uint32_t)(rng() % 86400);
+        const bool night = secs >= 18 * 3600 || secs < 6 * 3600;
+        write_date(raw.ActionDay, days);
+        write_date(raw.TradingDay, night && secs >= 18 * 3600 ? days + 1 : days);
+        tick_detail::write_digits(raw.UpdateTime, secs / 3600, 2);
+        tick_detail::write_digits(raw.UpdateTime + 3, secs / 60 % 60, 2);
+        tick_detail::write_digits(raw.UpdateTime + 6, secs % 60, 2);
+        raw.UpdateTime[2] = raw.UpdateTime[5] = ':';
+        raw.UpdateMillisec = (int)(rng() % 1000);
+        s.receive_ns = exchange_time_ns(raw.ActionDay, raw.UpdateTime, raw.UpdateMillisec) +
+                       (int64_t)(rng() % 5000000);
+
+        const int64_t mid = 1000 + (int64_t)(rng() % 200000);
+        raw.LastPrice = rng() % 50 == 0 ? DBL_MAX : (double)(mid + (int64_t)(rng() % 5) - 2) * s.price_tick;
+        raw.Volume = (int)(rng() % 2000000000);
+        raw.OpenInterest = (double)(rng() % 2000000000);
+        raw.Turnover = (double)(rng() % 1000000000000ULL) * 0.5;
+        Levels levels(raw);
+        for (int k = 0; k < 5; ++k) {
+            const bool bid_empty = rng() % 4 == 0, ask_empty = rng() % 4 == 0;
+            *levels.bid_px[k] = bid_empty ? DBL_MAX : (double)(mid - 1 - k) * s.price_tick;
+            *levels.ask_px[k] = ask_empty ? DBL_MAX : (double)(mid + 1 + k) * s.price_tick;
+            *levels.bid_vol[k] = bid_empty ? 0 : 1 + (int)(rng() % 100000);
+            *levels.ask_vol[k] = ask_empty ? 0 : 1 + (int)(rng() % 100000);
+        }
+    }
+}
+
+// 比较 Tick 保留的字段，返回不一致的字段数
+static uint64_t compare(const CThostFtdcDepthMarketDataField& a, const CThostFtdcDepthMarketDataField& b) {
+    uint64_t bad = 0;
+    bad += strcmp(a.InstrumentID, b.InstrumentID) != 0;
+    bad += memcmp(a.TradingDay, b.TradingDay, sizeof(a.TradingDay)) != 0;
+    bad += memcmp(a.ActionDay, b.ActionDay, sizeof(a.ActionDay)) != 0;
+    bad += memcmp(a.UpdateTime, b.UpdateTime, sizeof(a.UpdateTime)) != 0;
+    bad += a.UpdateMillisec != b.UpdateMillisec;
+    // 没有最新价 (DBL_MAX) 归一化为 0 tick，还原为 0
+    bad += (a.LastPrice == DBL_MAX ? 0.0 : a.LastPrice) != b.LastPrice;
+    bad += a.Volume != b.Volume;
+    bad += a.OpenInterest != b.OpenInterest;
+    bad += a.Turnover != b.Turnover;
+    Levels la(const_cast<CThostFtdcDepthMarketDataField&>(a)), lb(const_cast<CThostFtdcDepthMarketDataField&>(b));
+    for (int k = 0; k < 5; ++k) {
+        bad += *la.bid_px[k] != *lb.bid_px[k];
+        bad += *la.ask_px[k] != *lb.ask_px[k];
+        bad += *la.bid_vol[k] != *lb.bid_vol[k];
+        bad += *la.ask_vol[k] != *lb.ask_vol[k];
+    }
+    return bad;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t ops = argc > 1 ? (size_t)strtoull(argv[1], nullptr, 10) : 200000;
+    const size_t rounds = argc > 2 ? (size_t)strtoull(argv[2], nullptr, 10) : 4000;
+    if (ops == 0) {
+        std::cerr << "ops must be > 0" << std::endl;
+        return 1;
+    }
+    if (!TscClock::calibrate(100000000ULL)) {
+        std::cerr << "TSC calibration failed." << std::endl;
+        return 1;
+    }
+
+    std::vector<Sample> samples(ops);
+    generate(samples);
+    TickVector ticks(ops), again(ops);
+
+    uint64_t field_mismatch = 0, tick_mismatch = 0;
+    CThostFtdcDepthMarketDataField back;
+    for (size_t i = 0; i < ops; ++i) {
+        const Sample& s = samples[i];
+        const uint16_t id = (uint16_t)(i % 1000);
+        normalize_tick(s.raw, id, 1.0 / s.price_tick, s.receive_ns, ticks[i]);
+        denormalize_tick(ticks[i], s.raw.InstrumentID, s.price_tick, back);
+        field_mismatch += compare(s.raw, back);
+        normalize_tick(back, id, 1.0 / s.price_tick, s.receive_ns, again[i]);
+        tick_mismatch += memcmp(&ticks[i], &again[i], sizeof(Tick)) != 0;
+    }
+
+    const size_t window = ops < WINDOW ? ops : WINDOW;
+    std::vector<double> inv(window);
+    for (size_t i = 0; i < window; ++i) inv[i] = 1.0 / samples[i].price_tick;
+    const uint64_t t0 = bench::now_ns();
+    for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < window; ++i) {
+            normalize_tick(samples[i].raw, (uint16_t)i, inv[i], samples[i].receive_ns, ticks[i]);
+        }
+        bench::do_not_optimize(ticks[0]);
+    }
+    const double ns = (double)(bench::now_ns() - t0) / (rounds * window);
+
+    printf("=== %zu raw ticks, timing %zu x %zu rounds ===\n", ops, window, rounds);
+    printf("  normalize  %6.2f ns/tick\n", ns);
+    const bool ok = field_mismatch == 0 && tick_mismatch == 0;
+    printf("check: field mismatches %llu, re-normalized tick mismatches %llu, %s\n",
+           (unsigned long long)field_mismatch, (unsigned long long)tick_mismatch, ok ? "OK" : "INCONSISTENT");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+// 合约代码 -> 稠密 id 查找基准：完美哈希 vs std::unordered_map<std::string> vs 线性比较
+//
+// 默认生成约 1 万个 CTP 风格的合约代码 (期货、商品期权、股指期权、郑商所三位月份)，
+// 也可以传入 query_instruments 导出的 CSV 使用真实全市场合约。
+// 查找输入模拟 CTP 回调：81 字节的 InstrumentID 字段。
+//
+// 用法: registry_bench [lookups] [instruments.csv]
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdio>
+#include <cstdlib>
+#include "InstrumentRegistry.h"
+#include "ThostFtdcUserApiDataType.h"
+#include "BenchUtil.h"
+
+// 生成合成的全市场合约代码
+static void make_universe(InstrumentRegistry& registry) {
+    const char* futures[] = {
+        "rb", "hc", "cu", "al", "zn", "pb", "ni", "sn", "au", "ag", "ru", "bu", "fu", "sp", "ss", "ao",
+        "m", "y", "a", "b", "p", "c", "cs", "jd", "l", "v", "pp", "j", "jm", "i", "eg", "eb", "pg", "lh",
+        "sc", "lu", "nr", "bc", "ec", "IF", "IH", "IC", "IM", "TS", "TF", "T", "TL", "si", "lc", "ps"
+    };
+    const char* czce[] = {"SR", "CF", "TA", "MA", "FG", "RM", "OI", "ZC", "SA", "UR", "PF", "AP", "CJ", "PK", "SH", "PX"};
+    const char* options[] = {"m", "c", "i", "cu", "au", "ag", "rb", "ru", "sc", "IO", "MO", "HO"};
+
+    char id[64];
+    for (int month = 1; month <= 12; ++month) {
+        for (size_t f = 0; f < sizeof(futures) / sizeof(futures[0]); ++f) {
+            snprintf(id, sizeof(id), "%s26%02d", futures[f], month);
+            registry.add(id);
+        }
+        for (size_t f = 0; f < sizeof(czce) / sizeof(czce[0]); ++f) {
+            snprintf(id, sizeof(id), "%s6%02d", czce[f], month);
+            registry.add(id);
+            // 郑商所期权: SR601C5000
+            for (int k = 0; k < 20 && registry.size() < 10000; ++k) {
+                snprintf(id, sizeof(id), "%s6%02d%c%d", czce[f], month, k % 2 ? 'C' : 'P', 5000 + (k / 2) * 100);
+                registry.add(id);
+            }
+        }
+        // 大商所/上期所/中金所期权: m2601-C-3000, IO2601-P-4000
+        for (size_t o = 0; o < sizeof(options) / sizeof(options[0]); ++o) {
+            for (int k = 0; k < 40 && registry.size() < 10000; ++k) {
+                snprintf(id, sizeof(id), "%s26%02d-%c-%d", options[o], month, k % 2 ? 'C' : 'P', 3000 + (k / 2) * 50);
+                registry.add(id);
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const size_t lookups = argc > 1 ? strtoull(argv[1], nullptr, 10) : 20000000;
+
+    InstrumentRegistry registry;
+    if (argc > 2) {
+        if (registry.load_csv(argv[2]) < 0) {
+            std::cerr << "cannot open " << argv[2] << std::endl;
+            return 1;
+        }
+    } else {
+        make_universe(registry);
+    }
+
+    uint64_t t0 = bench::now_ns();
+    if (!registry.build()) {
+        std::cerr << "perfect hash build failed" << std::endl;
+        return 1;
+    }
+    const uint64_t build_ns = bench::now_ns() - t0;
+
+    const size_t n = registry.size();
+    std::unordered_map<std::string, uint16_t> map;
+    for (size_t i = 0; i < n; ++i) map[registry.name((uint16_t)i)] = (uint16_t)i;
+
+    // 81 字节的 CTP 合约字段，按伪随机顺序访问
+    std::vector<TThostFtdcInstrumentIDType> fields(n);
+    for (size_t i = 0; i < n; ++i) {
+        memset(fields[i], 0, sizeof(fields[i]));
+        strncpy(fields[i], registry.name((uint16_t)i), sizeof(fields[i]) - 1);
+    }
+    std::vector<uint32_t> order(1 << 16);
+    uint64_t x = 88172645463325252ULL;
+    for (size_t i = 0; i < order.size(); ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        order[i] = (uint32_t)(x % n);
+    }
+
+    std::cout << "=== InstrumentRegistry lookup benchmark ===" << std::endl;
+    std::cout << "instruments=" << n << " lookups=" << lookups
+              << " build=" << build_ns / 1000 << "us" << std::endl;
+
+    // 校验：每个合约都能查回自己的 id，未注册的查不到
+    for (size_t i = 0; i < n; ++i) {
+        if (registry.find_field(fields[i]) != i || registry.find(registry.name((uint16_t)i)) != i) {
+            std::cerr << "lookup mismatch for " << fields[i] << std::endl;
+            return 1;
+        }
+    }
+    TThostFtdcInstrumentIDType unknown = "zz9999";
+    if (registry.find("zz9999") != InstrumentRegistry::INVALID_ID
+        || registry.find_field(unknown) != InstrumentRegistry::INVALID_ID) {
+        std::cerr << "unknown instrument resolved" << std::endl;
+        return 1;
+    }
+
+    uint64_t sum = 0;
+    t0 = bench::now_ns();
+    for (size_t i = 0; i < lookups; ++i) sum += registry.find_field(fields[order[i & 0xFFFF]]);
+    const double perfect_ns = (double)(bench::now_ns() - t0) / lookups;
+
+    t0 = bench::now_ns();
+    for (size_t i = 0; i < lookups; ++i) sum += map.find(fields[order[i & 0xFFFF]])->second;
+    const double map_ns = (double)(bench::now_ns() - t0) / lookups;
+
+    // 线性比较太慢，只跑一小部分
+    const size_t linear_lookups = lookups / 1000 + 1;
+    t0 = bench::now_ns();
+    for (size_t i = 0; i < linear_lookups; ++i) {
+        const char* key = fields[order[i & 0xFFFF]];
+        for (size_t k = 0; k < n; ++k) {
+            if (strcmp(registry.name((uint16_t)k), key) == 0) { sum += k; break; }
+        }
+    }
+    const double linear_ns = (double)(bench::now_ns() - t0) / linear_lookups;
+    bench::do_not_optimize(sum);
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "  perfect hash          " << std::setw(10) << perfect_ns << " ns/lookup" << std::endl
+              << "  unordered_map<string> " << std::setw(10) << map_ns << " ns/lookup" << std::endl
+              << "  linear strcmp         " << std::setw(10) << linear_ns << " ns/lookup" << std::endl;
+    return 0;
+}
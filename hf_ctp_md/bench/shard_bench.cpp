@@ -0,0 +1,142 @@
+// 分片引擎基准：一个生产者按 ShardMap 把 tick 分到 K 个 SPSC 队列，K 个消费线程各自处理
+//
+// 每个 tick 模拟 work_ns 纳秒的策略计算，单个消费者的上限约为 1e9 / work_ns tick/s；
+// 依次测 K = 1..max_shards，打印总吞吐和各分片处理的笔数，并检查：
+// - 每个合约的序号严格递增 (分片内不乱序，同一合约不会跨分片)
+// - 所有分片处理的总数 == ops
+//
+// 用法: shard_bench [ops] [work_ns] [max_shards] [instruments] [producer_cpu] [first_consumer_cpu]
+//   first_consumer_cpu >= 0 时第 k 个消费者绑到 first_consumer_cpu + k
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <immintrin.h>
+#include "InstrumentRegistry.h"
+#include "SPSCQueue.h"
+#include "ShardMap.h"
+#include "Tick.h"
+#include "TscClock.h"
+#include "BenchUtil.h"
+
+struct ShardResult {
+    uint64_t processed;
+    uint64_t out_of_order;
+};
+
+static void consume(SPSCQueue<Tick>& queue, size_t instruments, uint64_t work_cycles, const std::atomic<bool>& done,
+                    int cpu, ShardResult& result) {
+    bench::pin_current_thread(cpu);
+    std::vector<int32_t> last(instruments, -1);
+    result.processed = 0;
+    result.out_of_order = 0;
+    for (;;) {
+        SPSCQueue<Tick>::Span batch = queue.peek_batch(64);
+        if (batch.empty()) {
+            if (done.load(std::memory_order_acquire) && queue.peek_batch(1).empty()) break;
+            _mm_pause();
+            continue;
+        }
+        for (const Tick& tick : batch) {
+            const uint64_t t = TscClock::rdtsc();
+            if (tick.volume <= last[tick.instrument_id]) result.out_of_order++;
+            last[tick.instrument_id] = tick.volume;
+            // 模拟策略计算
+            while (TscClock::rdtsc() - t < work_cycles) {}
+        }
+        result.processed += batch.size();
+        queue.release(batch.size());
+    }
+}
+
+static bool run(const InstrumentRegistry& registry, size_t shards, uint64_t ops, uint64_t work_cycles,
+                int producer_cpu, int first_consumer_cpu) {
+    const size_t instruments = registry.size();
+    ShardMap map(registry, shards);
+    std::vector<std::unique_ptr<SPSCQueue<Tick> > > queues;
+    for (size_t k = 0; k < shards; ++k) {
+        queues.push_back(std::unique_ptr<SPSCQueue<Tick> >(new SPSCQueue<Tick>(4096)));
+        queues.back()->prefault();
+    }
+
+    std::atomic<bool> done(false);
+    std::vector<ShardResult> results(shards);
+    std::vector<std::thread> consumers;
+    for (size_t k = 0; k < shards; ++k) {
+        consumers.push_back(std::thread(consume, std::ref(*queues[k]), instruments, work_cycles, std::cref(done),
+                                        first_consumer_cpu < 0 ? -1 : first_consumer_cpu + (int)k,
+                                        std::ref(results[k])));
+    }
+
+    bench::pin_current_thread(producer_cpu);
+    std::vector<int32_t> seq(instruments, 0);
+    uint64_t full_spins = 0;
+    const uint64_t start = bench::now_ns();
+    for (uint64_t i = 0; i < ops; ++i) {
+        const uint16_t id = (uint16_t)(i % instruments);
+        SPSCQueue<Tick>& queue = *queues[map.shard_of(id)];
+        Tick* slot;
+        while ((slot = queue.claim()) == nullptr) {
+            ++full_spins;
+            _mm_pause();
+        }
+        slot->instrument_id = id;
+        slot->volume = ++seq[id];
+        queue.commit();
+    }
+    done.store(true, std::memory_order_release);
+    for (size_t k = 0; k < shards; ++k) consumers[k].join();
+    const double seconds = (bench::now_ns() - start) / 1e9;
+
+    uint64_t processed = 0, out_of_order = 0;
+    for (size_t k = 0; k < shards; ++k) {
+        processed += results[k].processed;
+        out_of_order += results[k].out_of_order;
+    }
+    const bool ok = processed == ops && out_of_order == 0;
+    printf("shards %2zu: %8.1f K ticks/s, producer full spins %llu, %s\n", shards, processed / seconds / 1e3,
+           (unsigned long long)full_spins, ok ? "OK" : "INCONSISTENT");
+    printf("  per shard:");
+    for (size_t k = 0; k < shards; ++k) printf(" %llu", (unsigned long long)results[k].processed);
+    printf("\n");
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    const uint64_t ops = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    const uint64_t work_ns = argc > 2 ? strtoull(argv[2], nullptr, 10) : 500;
+    const size_t max_shards = argc > 3 ? (size_t)strtoull(argv[3], nullptr, 10) : 4;
+    const size_t instruments = argc > 4 ? (size_t)strtoull(argv[4], nullptr, 10) : 64;
+    const int producer_cpu = argc > 5 ? atoi(argv[5]) : -1;
+    const int first_consumer_cpu = argc > 6 ? atoi(argv[6]) : -1;
+
+    if (!TscClock::calibrate(100000000ULL)) {
+        std::cerr << "TSC calibration failed." << std::endl;
+        return 1;
+    }
+    if (instruments == 0 || max_shards == 0 || max_shards > ShardMap::MAX_SHARDS) {
+        std::cerr << "instruments must be > 0 and max_shards in 1.." << ShardMap::MAX_SHARDS << std::endl;
+        return 1;
+    }
+
+    InstrumentRegistry registry;
+    char name[32];
+    for (size_t i = 0; i < instruments; ++i) {
+        snprintf(name, sizeof(name), "bench%03zu", i);
+        registry.add(name, 1.0);
+    }
+    registry.build();
+
+    const uint64_t work_cycles = (uint64_t)(work_ns * TscClock::ghz());
+    printf("=== Sharded engine: %llu ticks, %llu ns work per tick, %zu instruments ===\n", (unsigned long long)ops,
+           (unsigned long long)work_ns, instruments);
+    bool ok = true;
+    for (size_t shards = 1; shards <= max_shards; ++shards) {
+        ok = run(registry, shards, ops, work_cycles, producer_cpu, first_consumer_cpu) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+// SPSCQueue 微基准：2 的幂次 + 本地副本版 vs 取模基线版
+//
+// 模拟换月/持仓量突变时的突发行情：生产者连续推送 burst 个 Tick，
+// 然后空闲 gap_us 微秒，如此往复直到推送 ops 个；消费者忙轮询取出。
+// 输出每种实现的 ns/op 与每操作缓存未命中数 (perf_event 可用时)。
+//
+// 用法: spsc_bench [ops] [burst] [gap_us] [producer_cpu] [consumer_cpu]
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <immintrin.h>
+#include "SPSCQueue.h"
+#include "Tick.h"
+#include "LegacySPSCQueue.h"
+#include "BenchUtil.h"
+
+struct BenchConfig {
+    size_t ops;
+    size_t burst;
+    uint64_t gap_ns;
+    int producer_cpu;
+    int consumer_cpu;
+};
+
+struct BenchResult {
+    double ns_per_op;
+    double misses_per_op;
+    bool has_misses;
+};
+
+template<typename Queue>
+static BenchResult run_bench(const BenchConfig& cfg) {
+    Queue queue(4096);
+    bench::PerfCounter misses;
+    std::atomic<bool> ready(false);
+
+    misses.start();
+    std::thread consumer([&]() {
+        bench::pin_current_thread(cfg.consumer_cpu);
+        Tick md;
+        uint64_t checksum = 0;
+        ready.store(true, std::memory_order_release);
+        for (size_t n = 0; n < cfg.ops; ) {
+            if (queue.pop(md)) {
+                checksum += md.receive_ns;
+                ++n;
+            } else {
+                _mm_pause();
+            }
+        }
+        bench::do_not_optimize(checksum);
+    });
+
+    bench::pin_current_thread(cfg.producer_cpu);
+    while (!ready.load(std::memory_order_acquire)) _mm_pause();
+
+    Tick md;
+    memset(&md, 0, sizeof(md));
+    uint64_t idle_ns = 0;
+    const uint64_t t0 = bench::now_ns();
+    for (size_t sent = 0; sent < cfg.ops; ) {
+        const size_t end = std::min(cfg.ops, sent + cfg.burst);
+        for (; sent < end; ++sent) {
+            md.receive_ns = (int64_t)sent;
+            while (!queue.push(md)) _mm_pause();
+        }
+        if (cfg.gap_ns > 0 && sent < cfg.ops) {
+            // 突发间隙：忙等而不是 sleep，避免调度抖动混入结果
+            const uint64_t g0 = bench::now_ns();
+            while (bench::now_ns() - g0 < cfg.gap_ns) _mm_pause();
+            idle_ns += bench::now_ns() - g0;
+        }
+    }
+    consumer.join();
+    const uint64_t elapsed = bench::now_ns() - t0;
+    const uint64_t miss_count = misses.stop();
+
+    BenchResult r;
+    r.ns_per_op = (double)(elapsed - idle_ns) / cfg.ops;
+    r.has_misses = misses.valid();
+    r.misses_per_op = (double)miss_count / cfg.ops;
+    return r;
+}
+
+static void print_result(const char* name, const BenchResult& r) {
+    std::cout << "  " << std::left << std::setw(24) << name
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << r.ns_per_op << " ns/op";
+    if (r.has_misses) {
+        std::cout << std::setw(12) << r.misses_per_op << " misses/op";
+    } else {
+        std::cout << "      misses/op n/a";
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig cfg;
+    cfg.ops = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+    cfg.burst = argc > 2 ? strtoull(argv[2], nullptr, 10) : 2000;
+    cfg.gap_ns = (argc > 3 ? strtoull(argv[3], nullptr, 10) : 100) * 1000;
+    cfg.producer_cpu = argc > 4 ? atoi(argv[4]) : 0;
+    cfg.consumer_cpu = argc > 5 ? atoi(argv[5]) : 1;
+    if (cfg.burst == 0) cfg.burst = cfg.ops;
+
+    std::cout << "=== SPSCQueue<Tick> benchmark ===" << std::endl;
+    std::cout << "ops=" << cfg.ops << " burst=" << cfg.burst
+              << " gap=" << cfg.gap_ns / 1000 << "us"
+              << " sizeof(Tick)=" << sizeof(Tick) << std::endl;
+
+    BenchConfig saturate = cfg;
+    saturate.burst = cfg.ops;
+    saturate.gap_ns = 0;
+
+    std::cout << "[saturate]" << std::endl;
+    print_result("legacy (modulo)", run_bench<LegacySPSCQueue<Tick> >(saturate));
+    print_result("pow2 + cached index", run_bench<SPSCQueue<Tick> >(saturate));
+
+    std::cout << "[burst]" << std::endl;
+    print_result("legacy (modulo)", run_bench<LegacySPSCQueue<Tick> >(cfg));
+    print_result("pow2 + cached index", run_bench<SPSCQueue<Tick> >(cfg));
+    return 0;
+}
@@ -0,0 +1,192 @@
+// 交易所时间解析基准：SWAR 解析对比逐字符解析、sscanf、strptime + timegm
+//
+// 随机校验 (fuzz)，每项 ops 组随机输入：
+// - exchange_time_ns (SWAR) 与逐字符解析、strptime + timegm 的结果完全相同 (1990~2099 年任意合法日期时间)
+// - parse_yyyymmdd 与 strtoul 相同
+// - 往返：denormalize_tick 还原的 ActionDay/UpdateTime/UpdateMillisec 再解析得到原时间戳
+// - 夜盘日期语义：按上期所 (ActionDay 为自然日)、大商所 (ActionDay = TradingDay = 下一交易日)、
+//   郑商所 (ActionDay = TradingDay = 自然日) 三种填法生成夜盘和日盘行情，接收时间 = 真实时间 + 0~2 秒延迟，
+//   resolve_exchange_time_ns 都得到真实时间
+// 性能：每种方法解析 ops 组 (日期, 时间, 毫秒)，报告每次的纳秒数
+//
+// 用法: timestamp_bench [ops]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "Tick.h"
+#include "TscClock.h"
+#include "BenchUtil.h"
+
+using namespace tick_detail;
+
+struct Input {
+    char day[9];
+    char time[9];
+    int millisec;
+};
+
+// 逐字符解析 (SWAR 之前的实现)
+static uint32_t parse_uint(const char* s, int n) {
+    uint32_t v = 0;
+    for (int i = 0; i < n; ++i) v = v * 10 + (uint32_t)(s[i] - '0');
+    return v;
+}
+
+static int64_t scalar_time_ns(const char* day, const char* time, int millisec) {
+    const int64_t days = days_from_civil(parse_uint(day, 4), parse_uint(day + 4, 2), parse_uint(day + 6, 2));
+    const int64_t secs = parse_uint(time, 2) * 3600 + parse_uint(time + 3, 2) * 60 + parse_uint(time + 6, 2);
+    return (days * 86400 + secs) * 1000000000LL + millisec * 1000000LL - CST_OFFSET_NS;
+}
+
+static int64_t sscanf_time_ns(const char* day, const char* time, int millisec) {
+    unsigned y = 0, m = 0, d = 0, hh = 0, mm = 0, ss = 0;
+    sscanf(day, "%4u%2u%2u", &y, &m, &d);
+    sscanf(time, "%2u:%2u:%2u", &hh, &mm, &ss);
+    const int64_t secs = days_from_civil(y, m, d) * 86400 + hh * 3600 + mm * 60 + ss;
+    return secs * 1000000000LL + millisec * 1000000LL - CST_OFFSET_NS;
+}
+
+static int64_t strptime_time_ns(const char* day, const char* time, int millisec) {
+    char buf[18];
+    memcpy(buf, day, 8);
+    buf[8] = ' ';
+    memcpy(buf + 9, time, 8);
+    buf[17] = '\0';
+    struct tm t;
+    memset(&t, 0, sizeof(t));
+    strptime(buf, "%Y%m%d %H:%M:%S", &t);
+    return (int64_t)timegm(&t) * 1000000000LL + millisec * 1000000LL - CST_OFFSET_NS;
+}
+
+static void format(int64_t days, uint32_t secs, Input& in) {
+    int y;
+    unsigned m, d;
+    civil_from_days(days, y, m, d);
+    write_digits(in.day, (uint32_t)y * 10000 + m * 100 + d, 8);
+    write_digits(in.time, secs / 3600, 2);
+    write_digits(in.time + 3, secs / 60 % 60, 2);
+    write_digits(in.time + 6, secs % 60, 2);
+    in.time[2] = in.time[5] = ':';
+    in.day[8] = in.time[8] = '\0';
+}
+
+// 交易日 (周一~周五) 的夜盘在前一个交易日晚上：周一 -> 上周五
+static int64_t night_date(int64_t trading_days) {
+    static const int BACK[7] = {2, 3, 1, 1, 1, 1, 1}; // 按星期 (0 为周日)
+    return trading_days - BACK[(trading_days % 7 + 11) % 7];
+}
+
+static bool fuzz(size_t ops) {
+    std::mt19937_64 rng(17);
+    const int64_t first = days_from_civil(1990, 1, 1), last = days_from_civil(2099, 12, 31);
+    uint64_t parse_mismatch = 0, strptime_mismatch = 0, day_mismatch = 0, roundtrip_mismatch = 0;
+    uint64_t resolve_mismatch[3] = {0, 0, 0};
+
+    for (size_t i = 0; i < ops; ++i) {
+        const int64_t days = first + (int64_t)(rng() % (uint64_t)(last - first + 1));
+        const uint32_t secs = (uint32_t)(rng() % 86400);
+        Input in;
+        format(days, secs, in);
+        in.millisec = (int)(rng() % 1000);
+
+        const int64_t ts = exchange_time_ns(in.day, in.time, in.millisec);
+        parse_mismatch += ts != scalar_time_ns(in.day, in.time, in.millisec);
+        strptime_mismatch += ts != strptime_time_ns(in.day, in.time, in.millisec);
+        day_mismatch += parse_yyyymmdd(in.day) != (uint32_t)strtoul(in.day, nullptr, 10);
+
+        Tick tick;
+        memset(&tick, 0, sizeof(tick));
+        tick.exchange_ts_ns = ts;
+        tick.trading_day = parse_yyyymmdd(in.day);
+        CThostFtdcDepthMarketDataField raw;
+        denormalize_tick(tick, "rb2601", 1.0, raw);
+        roundtrip_mismatch += exchange_time_ns(raw.ActionDay, raw.UpdateTime, raw.UpdateMillisec) != ts;
+
+        // 夜盘日期语义：随机工作日作为交易日，时间取夜盘 (21:00~02:30) 或日盘
+        int64_t trading = days;
+        while ((trading % 7 + 11) % 7 == 0 || (trading % 7 + 11) % 7 == 6) ++trading;
+        const uint32_t offset = (uint32_t)(rng() % (5 * 3600 + 30 * 60 + 6 * 3600));
+        const bool night = offset < 5 * 3600 + 30 * 60;
+        const uint32_t local = night ? (21 * 3600 + offset) % 86400 : 9 * 3600 + offset - (5 * 3600 + 30 * 60);
+        const int64_t natural = night ? night_date(trading) + (local < 12 * 3600 ? 1 : 0) : trading;
+        Input truth, trading_in;
+        format(natural, local, truth);
+        format(trading, local, trading_in);
+        const int64_t true_ts = exchange_time_ns(truth.day, truth.time, in.millisec);
+        const int64_t receive_ns = true_ts + (int64_t)(rng() % 2000000000ULL);
+        // 上期所：ActionDay 自然日；大商所：两者都是交易日；郑商所：两者都是自然日
+        resolve_mismatch[0] += resolve_exchange_time_ns(trading_in.day, truth.day, truth.time, in.millisec,
+                                                        receive_ns) != true_ts;
+        resolve_mismatch[1] += resolve_exchange_time_ns(trading_in.day, trading_in.day, truth.time, in.millisec,
+                                                        receive_ns) != true_ts;
+        resolve_mismatch[2] += resolve_exchange_time_ns(truth.day, truth.day, truth.time, in.millisec,
+                                                        receive_ns) != true_ts;
+    }
+
+    const bool ok = parse_mismatch == 0 && strptime_mismatch == 0 && day_mismatch == 0 && roundtrip_mismatch == 0 &&
+                    resolve_mismatch[0] == 0 && resolve_mismatch[1] == 0 && resolve_mismatch[2] == 0;
+    printf("check: scalar %llu, strptime %llu, YYYYMMDD %llu, round trip %llu, SHFE/DCE/CZCE night %llu/%llu/%llu "
+           "mismatches, %s\n",
+           (unsigned long long)parse_mismatch, (unsigned long long)strptime_mismatch, (unsigned long long)day_mismatch,
+           (unsigned long long)roundtrip_mismatch, (unsigned long long)resolve_mismatch[0],
+           (unsigned long long)resolve_mismatch[1], (unsigned long long)resolve_mismatch[2], ok ? "OK" : "INCONSISTENT");
+    return ok;
+}
+
+// 每种方法一个类型，模板各自实例化，解析函数内联进循环
+struct Swar {
+    int64_t operator()(const Input& in) const { return exchange_time_ns(in.day, in.time, in.millisec); }
+};
+struct Scalar {
+    int64_t operator()(const Input& in) const { return scalar_time_ns(in.day, in.time, in.millisec); }
+};
+struct Sscanf {
+    int64_t operator()(const Input& in) const { return sscanf_time_ns(in.day, in.time, in.millisec); }
+};
+struct Strptime {
+    int64_t operator()(const Input& in) const { return strptime_time_ns(in.day, in.time, in.millisec); }
+};
+
+template<typename Parse>
+static void run(const char* name, const std::vector<Input>& inputs, Parse parse) {
+    int64_t sum = 0;
+    const uint64_t t0 = bench::now_ns();
+    for (size_t i = 0; i < inputs.size(); ++i) sum += parse(inputs[i]);
+    const double ns = (double)(bench::now_ns() - t0) / inputs.size();
+    bench::do_not_optimize(sum);
+    printf("  %-10s %7.2f ns/parse\n", name, ns);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t ops = argc > 1 ? (size_t)strtoull(argv[1], nullptr, 10) : 1000000;
+    if (ops == 0) {
+        std::cerr << "ops must be > 0" << std::endl;
+        return 1;
+    }
+    if (!TscClock::calibrate(100000000ULL)) {
+        std::cerr << "TSC calibration failed." << std::endl;
+        return 1;
+    }
+
+    const bool ok = fuzz(ops);
+
+    // 日期和时间都随机 (实际行情里日期几乎不变)，解析的开销与输入无关
+    std::mt19937_64 rng(19);
+    const int64_t first = days_from_civil(2020, 1, 1);
+    std::vector<Input> inputs(ops);
+    for (size_t i = 0; i < ops; ++i) {
+        format(first + (int64_t)(rng() % 3650), (uint32_t)(rng() % 86400), inputs[i]);
+        inputs[i].millisec = (int)(rng() % 1000);
+    }
+    printf("=== %zu timestamps ===\n", ops);
+    run("swar", inputs, Swar());
+    run("scalar", inputs, Scalar());
+    run("sscanf", inputs, Sscanf());
+    run("strptime", inputs, Strptime());
+    return ok ? 0 : 1;
+}
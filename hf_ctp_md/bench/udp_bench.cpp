@@ -0,0 +1,154 @@
+// UDP 组播转发基准：同一进程内一个 UdpPublisher + 一个 UdpReceiver (走 loopback)
+//
+// 生产线程按固定速率 append ops 条 tick (序号写在 exchange_ts_ns 里)，接收线程统计：
+// - 报文/tick 吞吐、recvmmsg 平均每批报文数
+// - 两段延迟：append -> 发出 (环 + 打包)、发出 -> 收到 (内核 + loopback)
+// - 一致性：tick 序号严格递增，received + 丢弃 (环满) + 丢失报文中的 tick == ops
+// - 整条拷贝：回调按值拷贝整个 Tick (编译器可用对齐的向量加载)，检查地址 64 字节对齐、各字段与发送时一致
+//
+// 用法: udp_bench [ops] [rate_per_sec] [ticks_per_packet] [group] [port] [sender_cpu] [receiver_cpu]
+//   rate_per_sec 为 0 时不限速 (内核接收缓冲可能溢出，会体现为 lost)
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "UdpFeed.h"
+#include "TscClock.h"
+#include "BenchUtil.h"
+
+// 第 i 条 tick 的内容 (receive_ns 由发送时刻填写，不在此生成)
+static void fill_tick(Tick& tick, uint64_t i) {
+    tick.exchange_ts_ns = (int64_t)i;
+    tick.last_px = (int64_t)(i * 7);
+    tick.turnover = (double)i * 0.5;
+    tick.instrument_id = (uint16_t)(i % 1000);
+    tick.volume = (int32_t)i;
+    tick.open_interest = (int32_t)(i * 3);
+    tick.trading_day = 20250101;
+    for (int k = 0; k < 5; ++k) {
+        tick.bid_px[k] = (int32_t)(i - k);
+        tick.ask_px[k] = (int32_t)(i + k + 1);
+        tick.bid_vol[k] = (int32_t)(i % 97 + k);
+        tick.ask_vol[k] = (int32_t)(i % 89 + k);
+    }
+}
+
+struct ReceiverResult {
+    uint64_t received;
+    uint64_t out_of_order;
+    uint64_t misaligned;
+    uint64_t corrupted;
+    std::vector<uint64_t> publish;  // append -> 发出 (ns)
+    std::vector<uint64_t> wire;     // 发出 -> 收到 (ns)
+};
+
+static void receiver_main(UdpReceiver& rx, uint64_t ops, int cpu, std::atomic<bool>& done, ReceiverResult& result) {
+    bench::pin_current_thread(cpu);
+    int64_t last = -1;
+    result.received = 0;
+    result.out_of_order = 0;
+    result.misaligned = 0;
+    result.corrupted = 0;
+    Tick expected;
+    memset(&expected, 0, sizeof(expected));
+    result.publish.reserve(ops);
+    result.wire.reserve(ops);
+    // 发送端结束后再多等一轮超时，收完内核缓冲里剩余的报文
+    int idle = 0;
+    while (idle < 2) {
+        const size_t n = rx.poll([&](const Tick& tick, const udpfeed::PacketHeader& header, int64_t recv_ns) {
+            const Tick copy = tick;
+            result.misaligned += ((uintptr_t)&tick & (CACHELINE_SIZE - 1)) != 0;
+            fill_tick(expected, (uint64_t)copy.exchange_ts_ns);
+            expected.receive_ns = copy.receive_ns;
+            result.corrupted += memcmp(&copy, &expected, sizeof(Tick)) != 0;
+            if (copy.exchange_ts_ns <= last) result.out_of_order++;
+            last = copy.exchange_ts_ns;
+            const int64_t publish_ns = header.send_ns - tick.receive_ns;
+            const int64_t wire_ns = recv_ns - header.send_ns;
+            result.publish.push_back(publish_ns > 0 ? (uint64_t)publish_ns : 0);
+            result.wire.push_back(wire_ns > 0 ? (uint64_t)wire_ns : 0);
+        }, 50);
+        result.received += n;
+        idle = n == 0 && done.load() ? idle + 1 : 0;
+    }
+}
+
+static void print_latency(const char* name, std::vector<uint64_t>& samples) {
+    std::sort(samples.begin(), samples.end());
+    const size_t n = samples.size();
+    if (n == 0) return;
+    printf("  %-14s P50 %6llu ns  P99 %6llu ns  P99.9 %7llu ns  Max %8llu ns\n", name,
+           (unsigned long long)bench::percentile(samples.data(), n, 0.50),
+           (unsigned long long)bench::percentile(samples.data(), n, 0.99),
+           (unsigned long long)bench::percentile(samples.data(), n, 0.999), (unsigned long long)samples[n - 1]);
+}
+
+int main(int argc, char* argv[]) {
+    const uint64_t ops = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    const uint64_t rate = argc > 2 ? strtoull(argv[2], nullptr, 10) : 200000;
+    const size_t per_packet = argc > 3 ? (size_t)strtoull(argv[3], nullptr, 10) : udpfeed::DEFAULT_TICKS_PER_PACKET;
+    const std::string group = argc > 4 ? argv[4] : "239.255.0.1";
+    const uint16_t port = (uint16_t)(argc > 5 ? atoi(argv[5]) : 30101);
+    const int sender_cpu = argc > 6 ? atoi(argv[6]) : -1;
+    const int receiver_cpu = argc > 7 ? atoi(argv[7]) : -1;
+
+    if (!TscClock::calibrate(100000000ULL)) {
+        std::cerr << "TSC calibration failed." << std::endl;
+        return 1;
+    }
+
+    UdpReceiver rx;
+    if (!rx.open(group, port, "127.0.0.1", 16 << 20)) return 1;
+    UdpPublisher tx;
+    if (!tx.open(group, port, "127.0.0.1", per_packet)) return 1;
+    tx.set_cpu_affinity(sender_cpu);
+    tx.set_idle_sleep_us(0);
+    tx.prefault();
+    tx.start();
+
+    std::atomic<bool> done(false);
+    ReceiverResult result;
+    std::thread receiver(receiver_main, std::ref(rx), ops, receiver_cpu, std::ref(done), std::ref(result));
+
+    Tick tick;
+    memset(&tick, 0, sizeof(tick));
+    const uint64_t interval_ns = rate ? 1000000000ULL / rate : 0;
+    const uint64_t start = bench::now_ns();
+    for (uint64_t i = 0; i < ops; ++i) {
+        if (interval_ns) {
+            const uint64_t due = start + i * interval_ns;
+            while (bench::now_ns() < due) {
+            }
+        }
+        fill_tick(tick, i);
+        tick.receive_ns = TscClock::wall_ns();
+        tx.append(tick);
+    }
+    tx.stop();
+    const double send_s = (bench::now_ns() - start) / 1e9;
+    done = true;
+    receiver.join();
+
+    // 每个丢失的报文按 per_packet 条计上限：末尾不满的报文让 lost 估算偏大，允许这部分误差
+    const uint64_t accounted = result.received + tx.dropped();
+    const bool consistent = result.out_of_order == 0 && result.misaligned == 0 && result.corrupted == 0 &&
+                            accounted <= ops &&
+                            ops - accounted <= (rx.lost() + tx.send_errors()) * per_packet;
+    printf("publisher: %llu ticks in %llu packets, %.3f s (%.1f K ticks/s), ring dropped %llu, send errors %llu\n",
+           (unsigned long long)tx.ticks_sent(), (unsigned long long)tx.packets(), send_s,
+           tx.ticks_sent() / send_s / 1e3, (unsigned long long)tx.dropped(), (unsigned long long)tx.send_errors());
+    printf("receiver:  %llu ticks in %llu packets, %.1f packets per recvmmsg, gaps %llu, lost %llu, %s\n",
+           (unsigned long long)result.received, (unsigned long long)rx.packets(),
+           rx.batches() ? (double)rx.packets() / rx.batches() : 0.0, (unsigned long long)rx.gaps(),
+           (unsigned long long)rx.lost(), consistent ? "OK" : "INCONSISTENT");
+    printf("check: misaligned %llu, corrupted %llu ticks\n", (unsigned long long)result.misaligned,
+           (unsigned long long)result.corrupted);
+    print_latency("append->send", result.publish);
+    print_latency("send->recv", result.wire);
+    return consistent ? 0 : 1;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifndef CACHELINE_SIZE
+#define CACHELINE_SIZE 64
+#endif
+
+// 按缓存行对齐的分配器，给 std::vector<Tick> 等使用
+// C++17 以前 std::allocator 不保证 alignas 超过 16 字节的类型的对齐，
+// -march=native 下编译器会对 Tick 生成要求 64 字节对齐的 AVX 访存，未对齐直接崩溃
+template<typename T>
+struct AlignedAllocator {
+    typedef T value_type;
+
+    AlignedAllocator() {}
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        void* ptr = nullptr;
+        const size_t align = alignof(T) > CACHELINE_SIZE ? alignof(T) : CACHELINE_SIZE;
+        if (posix_memalign(&ptr, align, n * sizeof(T)) != 0) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t) { free(ptr); }
+
+    template<typename U>
+    struct rebind { typedef AlignedAllocator<U> other; };
+};
+
+template<typename T, typename U>
+inline bool operator==(const AlignedAllocator<T>&, const AlignedAllocator<U>&) { return true; }
+
+template<typename T, typename U>
+inline bool operator!=(const AlignedAllocator<T>&, const AlignedAllocator<U>&) { return false; }
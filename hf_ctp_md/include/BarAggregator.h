@@ -0,0 +1,250 @@
+#pragma once
+
+#include "Tick.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+// 一根已收盘的 K 线
+struct Bar {
+    int64_t  open_ts_ns;    // 第一笔的交易所时间 (UTC epoch 纳秒)
+    int64_t  close_ts_ns;   // 最后一笔的交易所时间
+    int64_t  open;          // 价格均为 tick 数
+    int64_t  high;
+    int64_t  low;
+    int64_t  close;
+    int64_t  volume;        // 本 bar 成交量，由累计 Volume 相减得到
+    double   turnover;      // 本 bar 成交额，由累计 Turnover 相减得到
+    uint32_t trading_day;   // 交易日 YYYYMMDD
+    uint32_t start_sec;     // bar 开始时刻，北京时间日内秒 (21:00:00 为 75600)
+    uint32_t period_sec;
+    uint32_t ticks;
+    int32_t  open_interest; // 最后一笔的持仓量
+    uint16_t instrument_id;
+};
+
+// 全部合约的 OHLCV K 线聚合 (单写者，在引擎线程内逐笔更新)
+// - 每个 (合约, 周期) 一个缓存行对齐的槽位，按合约 id 连续存放，一笔行情只访问该合约的几个槽位
+// - 分桶键为 (交易日, 交易日内时刻)，都由交易所时间求出 (session_day_of)，交易日从 18:00 的夜盘开始，
+//   夜盘跨零点不断开；不用 Tick::trading_day —— 郑商所夜盘填的是自然日，会和其他交易所差一天
+// - 成交量/成交额由累计值逐笔相减；交易日切换 (夜盘开盘) 时累计值从 0 重新开始，合约的第一笔只作为基准
+//   (启动前已成交的部分无法归属到 bar)
+// - 收盘由交易所时间驱动：合约自己的下一笔进入新的桶时收盘；另外聚合器按所有合约的最新交易所
+//   时间推进时钟，越过 bar 结束时刻 + close_delay_ms 后扫描收盘，不活跃的合约也能按时出 bar
+// - 已收盘的 bar 之后才到的行情记为 late：价格不再计入，成交量顺延到该合约的下一根 bar
+class BarAggregator {
+public:
+    static const size_t MAX_PERIODS = 8;
+
+    // periods_sec 中每个周期必须整除 86400，K 线边界才落在整点/整分
+    static bool valid_period(uint32_t period_sec) { return period_sec > 0 && 86400 % period_sec == 0; }
+
+    BarAggregator(size_t instrument_count, const std::vector<uint32_t>& periods_sec, uint32_t close_delay_ms = 0)
+        : capacity_(instrument_count), periods_(periods_sec.size()), close_delay_ms_(close_delay_ms),
+          clock_day_(0), clock_yyyymmdd_(0), clock_ms_(0), next_sweep_ms_(0), bars_(0), late_(0) {
+        if (periods_ == 0 || periods_ > MAX_PERIODS) throw std::invalid_argument("BarAggregator: bad period count");
+        for (size_t p = 0; p < periods_; ++p) {
+            if (!valid_period(periods_sec[p])) throw std::invalid_argument("BarAggregator: period must divide 86400");
+            period_sec_[p] = periods_sec[p];
+            period_ms_[p] = periods_sec[p] * 1000;
+            sweep_ms_[p] = 0;
+        }
+
+        const size_t slots = capacity_ * periods_;
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, CACHELINE_SIZE, sizeof(Slot) * (slots ? slots : 1)) != 0) {
+            throw std::bad_alloc();
+        }
+        slots_ = static_cast<Slot*>(ptr);
+        memset(static_cast<void*>(slots_), 0, sizeof(Slot) * slots);
+        base_.resize(capacity_);
+        memset(static_cast<void*>(base_.data()), 0, sizeof(Base) * capacity_);
+    }
+
+    ~BarAggregator() { free(slots_); }
+
+    BarAggregator(const BarAggregator&) = delete;
+    BarAggregator& operator=(const BarAggregator&) = delete;
+
+    size_t period_count() const { return periods_; }
+    uint32_t period_sec(size_t p) const { return period_sec_[p]; }
+    uint64_t bar_count() const { return bars_; }
+    uint64_t late_count() const { return late_; }
+
+    // 逐笔更新，收盘的 bar 通过 sink.onBar(const Bar&) 交出 (只在回调内有效)
+    template<typename Sink>
+    inline void update(const Tick& tick, Sink& sink) {
+        const uint16_t id = tick.instrument_id;
+        const uint32_t day = (uint32_t)session_day_of(tick.exchange_ts_ns);
+        const uint32_t session_ms = session_ms_of(tick.exchange_ts_ns);
+
+        // 推进交易所时钟：进入新交易日时上一交易日的 bar 全部收盘
+        if (day != clock_day_) {
+            if (day < clock_day_) {
+                late_++;
+                return;
+            }
+            close_all(sink);
+            clock_day_ = day;
+            clock_yyyymmdd_ = yyyymmdd_of(day);
+            clock_ms_ = session_ms;
+            schedule_sweeps();
+        } else if (session_ms > clock_ms_) {
+            clock_ms_ = session_ms;
+            if (clock_ms_ >= next_sweep_ms_) sweep(sink);
+        }
+
+        // 累计成交量/成交额 -> 本笔增量
+        Base& base = base_[id];
+        int64_t volume = 0;
+        double turnover = 0;
+        if (base.day != day) {
+            if (base.day != 0) {
+                volume = tick.volume;
+                turnover = tick.turnover;
+            }
+            base.day = day;
+        } else if (tick.volume >= base.volume) {
+            volume = tick.volume - base.volume;
+            turnover = tick.turnover - base.turnover;
+        }
+        base.volume = tick.volume;
+        base.turnover = tick.turnover;
+
+        bool late = false;
+        Slot* slots = &slots_[(size_t)id * periods_];
+        for (size_t p = 0; p < periods_; ++p) {
+            Slot& slot = slots[p];
+            const uint64_t key = (uint64_t)day << 32 | (session_ms / period_ms_[p]);
+            if (slot.open && key == slot.key) {
+                Bar& bar = slot.bar;
+                if (tick.last_px > bar.high) bar.high = tick.last_px;
+                if (tick.last_px < bar.low) bar.low = tick.last_px;
+                bar.close = tick.last_px;
+                bar.close_ts_ns = tick.exchange_ts_ns;
+                bar.volume += volume;
+                bar.turnover += turnover;
+                bar.ticks++;
+                bar.open_interest = tick.open_interest;
+            } else if (key > slot.key) {
+                if (slot.open) emit(slot, sink);
+                open(slot, key, p, tick, volume, turnover);
+            } else {
+                slot.carry_volume += volume;
+                slot.carry_turnover += turnover;
+                late = true;
+            }
+        }
+        late_ += late;
+    }
+
+    // 把所有未收盘的 bar 立即收盘 (收盘/停止时调用)
+    template<typename Sink>
+    void flush(Sink& sink) {
+        close_all(sink);
+    }
+
+private:
+    static const uint32_t DAY_MS = 86400000;
+    static const uint32_t SESSION_START_MS = 18 * 3600 * 1000; // 交易日从前一晚 18:00 开始
+
+    struct alignas(CACHELINE_SIZE) Slot {
+        Bar bar;
+        uint64_t key;          // 当前 bar 的 (交易日天数 << 32 | 桶号)；open 为 false 时是最后收盘的 bar
+        int64_t carry_volume;  // 迟到行情的成交量，计入下一根 bar
+        double carry_turnover;
+        bool open;
+    };
+
+    struct Base {
+        uint32_t day;          // 交易日 (session_day_of)，0 表示该合约还没有行情
+        int32_t volume;
+        double turnover;
+    };
+
+    // 交易所时间 -> 交易日内毫秒 (从 18:00 起算)
+    static inline uint32_t session_ms_of(int64_t exchange_ts_ns) {
+        const uint64_t local_ms = (uint64_t)(exchange_ts_ns + tick_detail::CST_OFFSET_NS) / 1000000ULL;
+        const uint32_t tod_ms = (uint32_t)(local_ms % DAY_MS);
+        return tod_ms >= SESSION_START_MS ? tod_ms - SESSION_START_MS : tod_ms + (DAY_MS - SESSION_START_MS);
+    }
+
+    inline void open(Slot& slot, uint64_t key, size_t p, const Tick& tick, int64_t volume, double turnover) {
+        const uint32_t bucket = (uint32_t)key;
+        Bar& bar = slot.bar;
+        bar.open_ts_ns = bar.close_ts_ns = tick.exchange_ts_ns;
+        bar.open = bar.high = bar.low = bar.close = tick.last_px;
+        bar.volume = slot.carry_volume + volume;
+        bar.turnover = slot.carry_turnover + turnover;
+        bar.trading_day = clock_yyyymmdd_; // 只有当前交易日的行情会开新 bar
+        bar.start_sec = (bucket * period_sec_[p] + SESSION_START_MS / 1000) % 86400;
+        bar.period_sec = period_sec_[p];
+        bar.ticks = 1;
+        bar.open_interest = tick.open_interest;
+        bar.instrument_id = tick.instrument_id;
+        slot.key = key;
+        slot.carry_volume = 0;
+        slot.carry_turnover = 0;
+        slot.open = true;
+    }
+
+    template<typename Sink>
+    inline void emit(Slot& slot, Sink& sink) {
+        slot.open = false;
+        bars_++;
+        sink.onBar(slot.bar);
+    }
+
+    template<typename Sink>
+    void close_all(Sink& sink) {
+        const size_t slots = capacity_ * periods_;
+        for (size_t i = 0; i < slots; ++i) {
+            if (slots_[i].open) emit(slots_[i], sink);
+        }
+    }
+
+    // 时钟越过某个周期的下一个收盘时刻：扫描该周期全部合约，收盘结束时刻 + 延迟已过的 bar
+    template<typename Sink>
+    void sweep(Sink& sink) {
+        for (size_t p = 0; p < periods_; ++p) {
+            if (clock_ms_ < sweep_ms_[p]) continue;
+            for (size_t id = 0; id < capacity_; ++id) {
+                Slot& slot = slots_[id * periods_ + p];
+                if (!slot.open) continue;
+                const uint64_t end_ms = ((uint64_t)(uint32_t)slot.key + 1) * period_ms_[p];
+                if (end_ms + close_delay_ms_ <= clock_ms_) emit(slot, sink);
+            }
+        }
+        schedule_sweeps();
+    }
+
+    // 每个周期的下一次扫描时刻：当前时钟下还未到期的最早 bar 的结束时刻 + 延迟
+    void schedule_sweeps() {
+        next_sweep_ms_ = UINT32_MAX;
+        for (size_t p = 0; p < periods_; ++p) {
+            const uint32_t buckets = clock_ms_ >= close_delay_ms_ ? (clock_ms_ - close_delay_ms_) / period_ms_[p] + 1 : 1;
+            sweep_ms_[p] = buckets * period_ms_[p] + close_delay_ms_;
+            if (sweep_ms_[p] < next_sweep_ms_) next_sweep_ms_ = sweep_ms_[p];
+        }
+    }
+
+private:
+    Slot* slots_;
+    std::vector<Base> base_;
+    size_t capacity_;
+    size_t periods_;
+    uint32_t period_sec_[MAX_PERIODS];
+    uint32_t period_ms_[MAX_PERIODS];
+    uint32_t sweep_ms_[MAX_PERIODS];
+    uint32_t close_delay_ms_;
+    uint32_t clock_day_;     // 交易所时钟：当前交易日 (session_day_of) 和交易日内毫秒 (所有合约中最新的)
+    uint32_t clock_yyyymmdd_; // clock_day_ 的 YYYYMMDD
+    uint32_t clock_ms_;
+    uint32_t next_sweep_ms_; // sweep_ms_ 的最小值
+    uint64_t bars_;
+    uint64_t late_;
+};
@@ -2,18 +2,21 @@
 
 #include "ThostFtdcMdApi.h"
 #include "SPSCQueue.h"
+#include "InstrumentRegistry.h"
+#include "OverflowPolicy.h"
+#include "SnapshotTable.h"
+#include "Tick.h"
+#include "AlignedAllocator.h"
+#include "FeedArbiter.h"
+#include "ShardMap.h"
+#include "TscClock.h"
 #include <cstring>
 #include <iostream>
-
-// 定义用于队列传输的数据结构
-struct MdData {
-    CThostFtdcDepthMarketDataField data;
-    uint64_t receive_tsc; // 接收时的 CPU 周期数 (RDTSC)
-};
+#include <vector>
 
 class CTPMdSpi : public CThostFtdcMdSpi {
 public:
-    CTPMdSpi(CThostFtdcMdApi* pUserApi, SPSCQueue<MdData>* pQueue);
+    CTPMdSpi(CThostFtdcMdApi* pUserApi, SPSCQueue<Tick>* pQueue, const InstrumentRegistry* pRegistry);
     virtual ~CTPMdSpi();
 
     // CTP 回调接口
@@ -30,8 +33,59 @@ public:
     void ReqUserLogin(const char* brokerId, const char* userId, const char* password);
     void SubscribeMarketData(char* ppInstrumentID[], int nCount);
 
+    // 设置队列满时的处理策略，必须在 Init() 之前调用
+    // OverwriteOldest 还要求队列已 set_overwrite(true)
+    void SetOverflowPolicy(const OverflowConfig& config, DropCounters* pDrops);
+
+    // 同时写入按合约的最新快照表 (可选)，必须在 Init() 之前调用
+    void SetSnapshotTable(SnapshotTable<Tick>* pSnapshots);
+
+    // 分片：按 map 把每个合约的 tick 写入对应分片的队列 (和快照表，snapshots 为空表示不写快照)，
+    // 替代构造时的单一队列和 SetSnapshotTable；必须在 Init() 之前调用
+    void SetShards(const ShardMap& map, const std::vector<SPSCQueue<Tick>*>& queues,
+                   const std::vector<SnapshotTable<Tick>*>& snapshots);
+
+    // 多前置 A/B 仲裁：本实例对应编号为 source 的前置 (写入 Tick::source)，
+    // 仲裁胜出的行情交给 pPrimary 写入队列 —— 队列、快照表和溢出暂存只由 pPrimary 持有
+    // (可以是自己)，所有前置共用；必须在 Init() 之前调用
+    void SetArbiter(FeedArbiter* pArbiter, uint8_t source, CTPMdSpi* pPrimary);
+
 private:
+    // 快照 + 入队 (含溢出处理)；多前置时在仲裁锁内调用
+    void Publish(const CThostFtdcDepthMarketDataField* pDepthMarketData, uint16_t id, int64_t receive_ns, uint8_t source);
+
+    // 队列已满时按策略处理，返回可写槽位；返回 nullptr 表示该 tick 已被丢弃或暂存
+    Tick* HandleOverflow(SPSCQueue<Tick>* pQueue, const CThostFtdcDepthMarketDataField* pDepthMarketData, uint16_t id,
+                         int64_t receive_ns, uint8_t source);
+    // 把按合约合并暂存的 tick 补发到队列，队列再次写满即停止 (分片时只跳过写满的分片)
+    void FlushPending();
+    // Conflate：把 tick 合并进该合约的暂存 (覆盖还没补发的上一笔)
+    void Conflate(const CThostFtdcDepthMarketDataField* pDepthMarketData, uint16_t id, int64_t receive_ns,
+                  uint8_t source);
+    bool IsPending(uint16_t id) const { return (m_pendingBits[id / 64] >> (id % 64)) & 1; }
+
+private:
+    // 每个合约写入的队列和快照表 (不分片时都指向同一个)，按合约 id 查表
+    struct Route {
+        SPSCQueue<Tick>* queue;
+        SnapshotTable<Tick>* snapshots;
+    };
+
     CThostFtdcMdApi* m_pUserApi;
-    SPSCQueue<MdData>* m_pQueue; // 无锁队列指针
+    const InstrumentRegistry* m_pRegistry;
+    std::vector<Route> m_routes;
+    bool m_sharded;
     int m_requestId;
+
+    // 多前置仲裁 (单前置时 m_pArbiter 为空，m_pPrimary 为自己)
+    FeedArbiter* m_pArbiter;
+    CTPMdSpi* m_pPrimary;
+    uint8_t m_source;
+
+    // 溢出处理 (只在 CTP 线程访问)
+    OverflowConfig m_overflow;
+    DropCounters* m_pDrops;
+    std::vector<Tick, AlignedAllocator<Tick> > m_pending;     // Conflate: 每个合约最新一笔暂存
+    std::vector<uint64_t> m_pendingBits;  // Conflate: 有暂存数据的合约位图
+    size_t m_pendingCount;
 };
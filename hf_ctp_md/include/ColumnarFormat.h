@@ -0,0 +1,135 @@
+#pragma once
+
+#include "Tick.h"
+#include <cstdint>
+#include <cstring>
+
+// 按交易日的列式行情文件 (.tc)，收盘后由 tick_convert 从 journal 转换生成
+//
+// 文件布局 (小端)：
+//   [FileHeader][数据块 ...][InstrumentEntry x instrument_count][BlockEntry x block_count]
+// - 每个数据块只含一个合约的连续至多 block_ticks 条 tick，块内按列存放，各列独立编码：
+//     时间戳          delta-of-delta + zigzag varint
+//     价格 (tick 数)  与上一条的差值 + zigzag varint，五档按同一档位求差
+//     成交量/持仓量   差值 + zigzag varint；盘口挂单量直接 zigzag varint
+//     成交额          原始 8 字节 double
+// - 每块第一条以 0 为基准编码，块之间没有依赖，可以单独解码
+// - BlockEntry 记录块的偏移、各列偏移和时间/价格/成交量的最小最大值，
+//   按合约排序，同一合约的块连续且按写入顺序排列；
+//   查询一个合约的时间区间只需读取目录和与区间重叠的块
+namespace columnar {
+
+const char MAGIC[8] = {'H', 'F', 'T', 'C', 'O', 'L', '\0', '\0'};
+const uint32_t VERSION = 1;
+
+enum Column {
+    COL_EXCHANGE_TS = 0,
+    COL_RECEIVE_TS,
+    COL_LAST_PX,
+    COL_VOLUME,
+    COL_TURNOVER,
+    COL_OPEN_INTEREST,
+    COL_BID_PX,       // 每条 5 个值
+    COL_ASK_PX,
+    COL_BID_VOL,
+    COL_ASK_VOL,
+    COL_META,         // source、flags 各 1 字节 + 交易日差值 varint
+    NUM_COLUMNS
+};
+
+const uint32_t ALL_COLUMNS = (1u << NUM_COLUMNS) - 1;
+
+inline uint32_t column_bit(Column c) { return 1u << c; }
+
+inline const char* column_name(int c) {
+    static const char* const names[NUM_COLUMNS] = {
+        "exchange_ts", "receive_ts", "last_px", "volume", "turnover", "open_interest",
+        "bid_px", "ask_px", "bid_vol", "ask_vol", "meta"
+    };
+    return c >= 0 && c < NUM_COLUMNS ? names[c] : "?";
+}
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t tick_size;         // sizeof(Tick)，结构变化时拒绝读取
+    uint32_t trading_day;       // YYYYMMDD
+    uint32_t instrument_count;
+    uint32_t block_ticks;       // 每块最多的 tick 数
+    uint32_t reserved0;
+    uint64_t tick_count;
+    uint64_t block_count;
+    uint64_t instrument_offset; // 合约表的文件偏移
+    uint64_t block_offset;      // 块目录的文件偏移
+    int64_t created_ns;
+    char reserved[56];
+};
+
+struct InstrumentEntry {
+    char instrument_id[32];
+    double price_tick;
+    uint64_t tick_count;
+    uint32_t first_block;       // 在块目录中的下标
+    uint32_t block_count;
+    char reserved[8];
+};
+
+struct BlockEntry {
+    uint64_t offset;            // 块的文件偏移
+    uint32_t length;            // 块的字节数
+    uint32_t tick_count;
+    uint32_t column_offset[NUM_COLUMNS]; // 各列相对块起点的偏移，列长度 = 下一列偏移 - 本列偏移
+    uint16_t instrument_id;
+    uint16_t reserved0;
+    int32_t min_volume;
+    int32_t max_volume;
+    int64_t min_exchange_ts;
+    int64_t max_exchange_ts;
+    int64_t min_last_px;
+    int64_t max_last_px;
+    char reserved[24];
+
+    size_t column_length(int c) const {
+        return (c + 1 < NUM_COLUMNS ? column_offset[c + 1] : length) - column_offset[c];
+    }
+};
+
+static_assert(sizeof(FileHeader) == 128, "FileHeader layout changed");
+static_assert(sizeof(InstrumentEntry) == 64, "InstrumentEntry layout changed");
+static_assert(sizeof(BlockEntry) == 128, "BlockEntry layout changed");
+
+// === 整数编码 ===
+
+inline uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+// LEB128：每字节 7 位，最高位表示后面还有字节；out 至少留 10 字节
+inline uint8_t* put_varint(uint8_t* out, uint64_t v) {
+    while (v >= 0x80) {
+        *out++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *out++ = (uint8_t)v;
+    return out;
+}
+
+// 越界或超长时返回 nullptr
+inline const uint8_t* get_varint(const uint8_t* in, const uint8_t* end, uint64_t& v) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && in < end; shift += 7) {
+        const uint8_t b = *in++;
+        result |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            v = result;
+            return in;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace columnar
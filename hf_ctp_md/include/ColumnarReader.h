@@ -0,0 +1,80 @@
+#pragma once
+
+#include "AlignedAllocator.h"
+#include "ColumnarFormat.h"
+#include "Tick.h"
+#include <string>
+#include <vector>
+
+// 列式行情文件读取：整个文件只读 mmap，按需解码数据块
+// - 打开时只校验文件头并定位合约表、块目录，数据块在解码时才被访问 (缺页读入)
+// - 区间查询先用块目录里的时间范围筛块，不相交的块一个字节都不读；映射设为 MADV_RANDOM，
+//   避免内核按顺序预读把用不到的块也读进来
+// - decode_block() 可以只解码部分列 (columns 位掩码)，未解码的字段为 0
+class ColumnarReader {
+public:
+    static const uint16_t INVALID_ID = 0xFFFF;
+
+    ColumnarReader();
+    ~ColumnarReader();
+
+    ColumnarReader(const ColumnarReader&) = delete;
+    ColumnarReader& operator=(const ColumnarReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    const columnar::FileHeader& header() const { return *m_header; }
+    uint32_t trading_day() const { return m_header->trading_day; }
+    uint64_t tick_count() const { return m_header->tick_count; }
+    size_t instrument_count() const { return m_header->instrument_count; }
+    const columnar::InstrumentEntry& instrument(uint16_t id) const { return m_instruments[id]; }
+    // 按合约代码查找，线性扫描合约表，未找到返回 INVALID_ID
+    uint16_t find_instrument(const char* instrument_id) const;
+
+    size_t block_count(uint16_t id) const { return m_instruments[id].block_count; }
+    const columnar::BlockEntry& block(uint16_t id, size_t i) const {
+        return m_blocks[m_instruments[id].first_block + i];
+    }
+
+    // 解码一个块到 out (至少 entry.tick_count 个)，返回解码的条数，数据损坏返回 0
+    size_t decode_block(const columnar::BlockEntry& entry, Tick* out,
+                        uint32_t columns = columnar::ALL_COLUMNS) const;
+
+    // 依次回调合约 id 在 [from_ns, to_ns) 内 (按 exchange_ts_ns) 的 tick，返回回调次数
+    // 只解码时间范围与查询区间相交的块
+    template<typename Fn>
+    size_t scan(uint16_t id, int64_t from_ns, int64_t to_ns, Fn&& fn, uint32_t columns = columnar::ALL_COLUMNS) {
+        columns |= columnar::column_bit(columnar::COL_EXCHANGE_TS);
+        size_t matched = 0;
+        for (size_t b = 0; b < block_count(id); ++b) {
+            const columnar::BlockEntry& entry = block(id, b);
+            if (entry.max_exchange_ts < from_ns || entry.min_exchange_ts >= to_ns) continue;
+            if (m_scratch.size() < entry.tick_count) m_scratch.resize(entry.tick_count);
+            const size_t n = decode_block(entry, m_scratch.data(), columns);
+            m_blocksDecoded++;
+            for (size_t i = 0; i < n; ++i) {
+                const Tick& tick = m_scratch[i];
+                if (tick.exchange_ts_ns >= from_ns && tick.exchange_ts_ns < to_ns) {
+                    fn(tick);
+                    matched++;
+                }
+            }
+        }
+        return matched;
+    }
+
+    // scan() 累计解码的块数，用于确认查询只读了必要的块
+    uint64_t blocks_decoded() const { return m_blocksDecoded; }
+    size_t size() const { return m_size; }
+
+private:
+    int m_fd;
+    const uint8_t* m_base;
+    size_t m_size;
+    const columnar::FileHeader* m_header;
+    const columnar::InstrumentEntry* m_instruments;
+    const columnar::BlockEntry* m_blocks;
+    std::vector<Tick, AlignedAllocator<Tick> > m_scratch;
+    uint64_t m_blocksDecoded;
+};
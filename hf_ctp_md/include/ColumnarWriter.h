@@ -0,0 +1,80 @@
+#pragma once
+
+#include "AlignedAllocator.h"
+#include "ColumnarFormat.h"
+#include "Tick.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 列式行情文件写入 (格式见 ColumnarFormat.h)，离线转换用，不在行情热路径上
+// - 每个合约缓存尚未写出的 tick，攒满 block_ticks 条即编码写出一块
+// - 所有合约缓存的 tick 总数 (按缓冲区容量计) 超过 max_pending_ticks 时，从缓存最多的合约开始
+//   提前写出不满的块并释放缓冲区，直到降到预算的一半；内存占用上限约为 max_pending_ticks x sizeof(Tick)。
+//   同一合约因此可能有多个不满的块，各块有自己的最小最大值，不影响区间查询
+// - 不同合约的块在文件中交错存放，close() 时写出按合约排序的块目录和合约表，最后回填文件头
+//
+// 用法：open() -> add_instrument() 注册合约 -> append() ... -> close()
+class ColumnarWriter {
+public:
+    static const size_t DEFAULT_BLOCK_TICKS = 4096;
+    static const size_t DEFAULT_MAX_PENDING_TICKS = 1 << 20;   // 128 MB
+
+    // max_pending_ticks 小于 block_ticks 时按 block_ticks 计
+    explicit ColumnarWriter(size_t block_ticks = DEFAULT_BLOCK_TICKS,
+                            size_t max_pending_ticks = DEFAULT_MAX_PENDING_TICKS);
+    ~ColumnarWriter();
+
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    bool open(const std::string& path, uint32_t trading_day);
+
+    // 注册合约，返回文件内的合约 id (已存在则返回原 id)；合约数超过 65535 返回 0xFFFF
+    uint16_t add_instrument(const char* instrument_id, double price_tick);
+
+    // tick.instrument_id 须为 add_instrument() 返回的 id；同一合约按追加顺序存放
+    bool append(const Tick& tick);
+
+    // 写出未满的块、合约表和块目录，回填文件头并关闭，失败返回 false
+    bool close();
+
+    uint64_t tick_count() const { return m_tickCount; }
+    uint64_t file_size() const { return m_offset; }
+    size_t block_count() const { return m_blockCount; }
+    uint64_t budget_flushes() const { return m_budgetFlushes; }
+    uint64_t column_bytes(int column) const { return m_columnBytes[column]; }
+
+private:
+    struct InstrumentState {
+        std::string id;
+        double price_tick;
+        uint64_t tick_count;
+        std::vector<Tick, AlignedAllocator<Tick> > pending;
+        std::vector<columnar::BlockEntry> blocks;
+    };
+
+    bool flush_block(uint16_t id);
+    bool flush_over_budget();
+    bool write_all(const void* data, size_t len);
+
+private:
+    size_t m_blockTicks;
+    size_t m_maxPendingTicks;
+    size_t m_pendingTicks;      // 各合约 pending 缓冲区容量之和
+    uint64_t m_budgetFlushes;   // 因超出预算提前写出的块数
+    int m_fd;
+    std::string m_path;
+    uint32_t m_tradingDay;
+    uint64_t m_offset;
+    uint64_t m_tickCount;
+    size_t m_blockCount;
+    bool m_failed;
+
+    std::vector<InstrumentState> m_instruments;
+    std::unordered_map<std::string, uint16_t> m_ids;
+
+    // 编码缓冲：每列按最坏情况预留，块内各列依次拼接后写出
+    std::vector<uint8_t> m_columns[columnar::NUM_COLUMNS];
+    uint64_t m_columnBytes[columnar::NUM_COLUMNS];
+};
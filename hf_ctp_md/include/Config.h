@@ -0,0 +1,25 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+// 简单的 INI 配置读取：[Section] 下的 Key=Value，# 或 ; 开头为注释
+// 只在启动阶段使用，热路径不访问
+class Config {
+public:
+    // 文件打不开返回 false，此时所有 get 返回默认值
+    bool load(const std::string& path);
+
+    bool has(const std::string& section, const std::string& key) const;
+    std::string get_string(const std::string& section, const std::string& key, const std::string& def = "") const;
+    long long get_int(const std::string& section, const std::string& key, long long def = 0) const;
+    double get_double(const std::string& section, const std::string& key, double def = 0.0) const;
+    // true/false/yes/no/on/off/1/0，不区分大小写
+    bool get_bool(const std::string& section, const std::string& key, bool def = false) const;
+    // 逗号分隔的列表，去掉空白和空项
+    std::vector<std::string> get_list(const std::string& section, const std::string& key) const;
+
+private:
+    std::map<std::string, std::string> m_values; // "Section.Key" -> Value
+};
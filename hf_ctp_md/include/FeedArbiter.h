@@ -0,0 +1,142 @@
+#pragma once
+
+#include "ThostFtdcUserApiStruct.h"
+#include "Tick.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <immintrin.h> // _mm_pause
+
+// 多前置 A/B 仲裁：同一份行情经多个前置 (各自一个 MdApi 实例、各自的网络线程) 到达，
+// 最先到达的一笔发布，其余前置随后到达的同一笔丢弃
+//
+// - 同一笔行情按 (合约, 交易所时间, Volume) 识别；每个合约记住最后发布的 (交易所时间, 成交量)，
+//   新到的必须严格更新才发布：相等为重复，更旧为过期 (该前置落后或重发了旧快照)
+// - 交易所时间带日期 (resolve_exchange_time_ns，按各交易所夜盘的日期填法求出)，登录时推送的上一交易日
+//   收盘快照、跨零点的夜盘、日盘与夜盘之间都按真实先后比较
+// - 所有前置都断开后第一个重新连上的前置清空记录：新会话的行情可能比断开前的旧 (如仿真环境重放历史行情)；
+//   还有其他前置在线时不清空，否则在线前置随后到达的重复行情会被再次发布
+// - 判重和写入队列必须在同一把锁内完成，否则两个前置交替胜出时同一合约的 tick 会乱序；
+//   锁只在多个前置几乎同时收到行情时才有竞争，临界区是一次归一化加一次入队
+// - 每个前置统计胜出/重复/过期笔数，以及重复时落后于胜出前置的时间，用来判断哪条线路更快
+class FeedArbiter {
+public:
+    static const size_t MAX_FRONTS = 8;
+
+    // 按前置的统计，只在持锁时写入 (relaxed load+store)，报告线程可随时读取近似值；
+    // unknown 例外，由该前置的回调线程不持锁单写
+    struct FrontStats {
+        std::atomic<uint64_t> received;  // 已注册合约的 tick
+        std::atomic<uint64_t> won;       // 最先到达，已发布
+        std::atomic<uint64_t> duplicate; // 其他前置已发布过同一笔
+        std::atomic<uint64_t> stale;     // 比已发布的更旧
+        std::atomic<uint64_t> behind_ns; // 重复时落后于胜出前置的累计纳秒
+        std::atomic<uint64_t> unknown;   // 未注册合约的 tick，不参与仲裁，直接丢弃
+        std::atomic<bool> connected;
+        char pad[CACHELINE_SIZE - 6 * sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<bool>)];
+    };
+
+    FeedArbiter(size_t instrument_count, size_t front_count)
+        : m_locked(false), m_frontCount(front_count < MAX_FRONTS ? front_count : MAX_FRONTS),
+          m_last(instrument_count) {
+        for (size_t i = 0; i < m_last.size(); ++i) m_last[i].front = NONE;
+        for (size_t i = 0; i < MAX_FRONTS; ++i) {
+            m_stats[i].received.store(0, std::memory_order_relaxed);
+            m_stats[i].won.store(0, std::memory_order_relaxed);
+            m_stats[i].duplicate.store(0, std::memory_order_relaxed);
+            m_stats[i].stale.store(0, std::memory_order_relaxed);
+            m_stats[i].behind_ns.store(0, std::memory_order_relaxed);
+            m_stats[i].unknown.store(0, std::memory_order_relaxed);
+            m_stats[i].connected.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    FeedArbiter(const FeedArbiter&) = delete;
+    FeedArbiter& operator=(const FeedArbiter&) = delete;
+
+    size_t front_count() const { return m_frontCount; }
+
+    inline void lock() {
+        while (m_locked.exchange(true, std::memory_order_acquire)) {
+            while (m_locked.load(std::memory_order_relaxed)) _mm_pause();
+        }
+    }
+
+    inline void unlock() { m_locked.store(false, std::memory_order_release); }
+
+    // 判定 front 收到的这笔行情是否应当发布，必须持有锁；返回 true 时调用方在释放锁之前写入队列
+    inline bool accept(uint8_t front, uint16_t id, const CThostFtdcDepthMarketDataField& md, int64_t receive_ns) {
+        FrontStats& stats = m_stats[front];
+        bump(stats.received);
+
+        const int64_t ts = resolve_exchange_time_ns(md.TradingDay, md.ActionDay, md.UpdateTime, md.UpdateMillisec,
+                                                    receive_ns);
+        const uint32_t volume = (uint32_t)md.Volume;
+        Last& last = m_last[id];
+        if (last.front != NONE) {
+            const bool newer = ts != last.ts ? ts > last.ts : volume > last.volume;
+            if (!newer) {
+                if (ts == last.ts && volume == last.volume) {
+                    bump(stats.duplicate);
+                    if (receive_ns > last.receive_ns) {
+                        stats.behind_ns.store(stats.behind_ns.load(std::memory_order_relaxed) +
+                                              (uint64_t)(receive_ns - last.receive_ns), std::memory_order_relaxed);
+                    }
+                } else {
+                    bump(stats.stale);
+                }
+                return false;
+            }
+        }
+        last.ts = ts;
+        last.volume = volume;
+        last.front = front;
+        last.receive_ns = receive_ns;
+        bump(stats.won);
+        return true;
+    }
+
+    // front 收到未注册合约的 tick，由该前置的回调线程调用，不需要持锁
+    inline void count_unknown(uint8_t front) { bump(m_stats[front].unknown); }
+
+    // 前置连接状态，由各前置的 OnFrontConnected/OnFrontDisconnected 设置
+    // 所有前置都断开后重新连上时清空各合约最后发布的记录
+    void set_connected(uint8_t front, bool connected) {
+        lock();
+        if (connected) {
+            bool others = false;
+            for (size_t i = 0; i < m_frontCount; ++i) {
+                if (i != front && m_stats[i].connected.load(std::memory_order_relaxed)) others = true;
+            }
+            if (!others) {
+                for (size_t i = 0; i < m_last.size(); ++i) m_last[i].front = NONE;
+            }
+        }
+        m_stats[front].connected.store(connected, std::memory_order_relaxed);
+        unlock();
+    }
+
+    const FrontStats& stats(size_t front) const { return m_stats[front]; }
+
+private:
+    static const uint8_t NONE = 0xFF;
+
+    struct Last {
+        int64_t ts;         // 交易所时间 (UTC epoch 纳秒)
+        int64_t receive_ns; // 胜出前置的接收时间
+        uint32_t volume;
+        uint8_t front;      // 胜出的前置，NONE 表示该合约还没有行情
+    };
+
+    static inline void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<bool> m_locked;
+    char m_pad[CACHELINE_SIZE - sizeof(std::atomic<bool>)];
+    size_t m_frontCount;
+    std::vector<Last> m_last;
+    FrontStats m_stats[MAX_FRONTS];
+};
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "Tick.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <immintrin.h>
+
+// 全部合约的滚动指标 (单写者，在引擎线程内更新)，每笔 O(1)：
+// - EMA：最新价的指数移动平均，alpha = 2 / (period + 1)
+// - VWAP：交易日内按逐笔成交量加权的均价，成交量由累计 Volume 相减，交易日切换 (夜盘开盘) 时重新累计；
+//   交易日由交易所时间求出 (session_day_of)，不用郑商所夜盘填自然日的 Tick::trading_day
+// - 波动率：逐笔价格变动 (tick 数) 平方的指数移动平均开方，即每笔的 EWMA 标准差
+// - OBI：一档盘口不平衡 (买一量 - 卖一量) / (买一量 + 卖一量)，范围 [-1, 1]
+// 价格均为 tick 数。每个合约的全部状态放在一条缓存行里 (下标为合约 id)，更新一笔只碰一条缓存行；
+// 交易日按 18:00 起的 24 小时窗口缓存，越过窗口才重新计算。
+// - update(tick)：逐笔标量更新
+// - update_batch(ticks, n)：整批更新，AVX2 每次处理 4 笔不同合约的 tick (4 条缓存行各两次 256 位读写，
+//   4x4 转置成按指标的向量)；4 笔中有重复合约时这一组退回逐笔更新，保证同一合约按顺序计算
+class IndicatorTable {
+public:
+    IndicatorTable(size_t instrument_count, double ema_period, double vol_period)
+        : capacity_(instrument_count), alpha_ema_(2.0 / (ema_period + 1)), alpha_vol_(2.0 / (vol_period + 1)),
+          window_begin_(session_window_begin_ns(0)), window_day_((double)session_day_of(0)) {
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, CACHELINE_SIZE, sizeof(State) * (capacity_ ? capacity_ : 1)) != 0) {
+            throw std::bad_alloc();
+        }
+        memset(ptr, 0, sizeof(State) * capacity_);
+        state_ = static_cast<State*>(ptr);
+    }
+
+    ~IndicatorTable() { free(state_); }
+
+    IndicatorTable(const IndicatorTable&) = delete;
+    IndicatorTable& operator=(const IndicatorTable&) = delete;
+
+    size_t capacity() const { return capacity_; }
+
+    // 读取 (引擎线程内)；合约还没有行情时均为 0
+    double ema(uint16_t id) const { return state_[id].ema; }
+    double vwap(uint16_t id) const { return state_[id].vol > 0 ? state_[id].pv / state_[id].vol : state_[id].prev_px; }
+    double volatility(uint16_t id) const { return std::sqrt(state_[id].var); }
+    double obi(uint16_t id) const { return state_[id].obi; }
+    double last_px(uint16_t id) const { return state_[id].prev_px; }
+
+    inline void update(const Tick& tick) __attribute__((always_inline)) {
+        State& s = state_[tick.instrument_id];
+        const double px = (double)tick.last_px;
+        const double volume = (double)tick.volume;
+        const double day = session_day(tick.exchange_ts_ns);
+        double dv;
+        if (day != s.day) {
+            // 合约的第一笔只作为基准；交易日切换时累计成交量从 0 开始，VWAP 重新累计
+            const bool first = s.day == 0;
+            if (first) {
+                s.prev_px = px;
+                s.ema = px;
+                s.var = 0;
+            }
+            s.pv = 0;
+            s.vol = 0;
+            dv = first ? 0 : volume;
+            s.day = day;
+        } else {
+            dv = volume > s.prev_vol ? volume - s.prev_vol : 0;
+        }
+        const double r = px - s.prev_px;
+        s.var += alpha_vol_ * (r * r - s.var);
+        s.ema += alpha_ema_ * (px - s.ema);
+        s.pv += px * dv;
+        s.vol += dv;
+        const double bid = (double)tick.bid_vol[0], ask = (double)tick.ask_vol[0];
+        s.obi = bid + ask > 0 ? (bid - ask) / (bid + ask) : 0;
+        s.prev_px = px;
+        s.prev_vol = volume;
+    }
+
+    void update_batch(const Tick* ticks, size_t n) {
+        size_t i = 0;
+#ifdef __AVX2__
+        for (; i + 4 <= n; i += 4) {
+            const uint16_t a = ticks[i].instrument_id, b = ticks[i + 1].instrument_id;
+            const uint16_t c = ticks[i + 2].instrument_id, d = ticks[i + 3].instrument_id;
+            if (a == b || a == c || a == d || b == c || b == d || c == d) {
+                for (size_t k = 0; k < 4; ++k) update(ticks[i + k]);
+            } else {
+                update4(ticks + i);
+            }
+        }
+#endif
+        for (; i < n; ++i) update(ticks[i]);
+    }
+
+private:
+    // 一个合约的状态，前后两半各对应一个 256 位向量：day..ema / var..obi
+    struct alignas(CACHELINE_SIZE) State {
+        double day;      // 交易日 (session_day_of)，0 表示该合约还没有行情
+        double prev_px;  // 上一笔最新价
+        double prev_vol; // 上一笔累计成交量
+        double ema;
+        double var;      // 价格变动平方的 EWMA
+        double pv;       // 交易日内 sum(价格 x 成交量)
+        double vol;      // 交易日内成交量
+        double obi;
+    };
+    static_assert(sizeof(State) == CACHELINE_SIZE, "State must fill exactly one cache line");
+
+    inline double session_day(int64_t exchange_ts_ns) {
+        if ((uint64_t)exchange_ts_ns - (uint64_t)window_begin_ >= (uint64_t)tick_detail::DAY_NS) {
+            window_begin_ = session_window_begin_ns(exchange_ts_ns);
+            window_day_ = (double)session_day_of(exchange_ts_ns);
+        }
+        return window_day_;
+    }
+
+#ifdef __AVX2__
+    // 4x4 转置：4 个合约的同一组字段 <-> 4 个字段的 4 个合约，转两次还原
+    static inline void transpose4(__m256d& r0, __m256d& r1, __m256d& r2, __m256d& r3) {
+        const __m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+        const __m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+        r0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+        r1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+        r2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+        r3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+    }
+
+    // 4 笔不同合约的 tick，与 update() 逐项对应
+    inline void update4(const Tick* t) {
+        double* s[4];
+        for (size_t k = 0; k < 4; ++k) s[k] = &state_[t[k].instrument_id].day;
+        __m256d old_day = _mm256_load_pd(s[0]), prev_px = _mm256_load_pd(s[1]);
+        __m256d prev_vol = _mm256_load_pd(s[2]), ema = _mm256_load_pd(s[3]);
+        __m256d var = _mm256_load_pd(s[0] + 4), pv = _mm256_load_pd(s[1] + 4);
+        __m256d vol = _mm256_load_pd(s[2] + 4), obi = _mm256_load_pd(s[3] + 4);
+        transpose4(old_day, prev_px, prev_vol, ema);
+        transpose4(var, pv, vol, obi);
+
+        const __m256d px = _mm256_setr_pd((double)t[0].last_px, (double)t[1].last_px, (double)t[2].last_px,
+                                          (double)t[3].last_px);
+        const __m256d volume = _mm256_setr_pd((double)t[0].volume, (double)t[1].volume, (double)t[2].volume,
+                                              (double)t[3].volume);
+        const __m256d day = _mm256_setr_pd(session_day(t[0].exchange_ts_ns), session_day(t[1].exchange_ts_ns),
+                                           session_day(t[2].exchange_ts_ns), session_day(t[3].exchange_ts_ns));
+        const __m256d bid = _mm256_setr_pd((double)t[0].bid_vol[0], (double)t[1].bid_vol[0], (double)t[2].bid_vol[0],
+                                           (double)t[3].bid_vol[0]);
+        const __m256d ask = _mm256_setr_pd((double)t[0].ask_vol[0], (double)t[1].ask_vol[0], (double)t[2].ask_vol[0],
+                                           (double)t[3].ask_vol[0]);
+        const __m256d zero = _mm256_setzero_pd();
+
+        const __m256d new_day = _mm256_cmp_pd(day, old_day, _CMP_NEQ_OQ);
+        const __m256d first = _mm256_cmp_pd(old_day, zero, _CMP_EQ_OQ);
+        prev_px = _mm256_blendv_pd(prev_px, px, first);
+        ema = _mm256_blendv_pd(ema, px, first);
+        var = _mm256_blendv_pd(var, zero, first);
+        pv = _mm256_blendv_pd(pv, zero, new_day);
+        vol = _mm256_blendv_pd(vol, zero, new_day);
+
+        const __m256d dv_same = _mm256_max_pd(_mm256_sub_pd(volume, prev_vol), zero);
+        const __m256d dv_new = _mm256_blendv_pd(volume, zero, first);
+        const __m256d dv = _mm256_blendv_pd(dv_same, dv_new, new_day);
+        const __m256d r = _mm256_sub_pd(px, prev_px);
+        var = _mm256_add_pd(var, _mm256_mul_pd(_mm256_set1_pd(alpha_vol_), _mm256_sub_pd(_mm256_mul_pd(r, r), var)));
+        ema = _mm256_add_pd(ema, _mm256_mul_pd(_mm256_set1_pd(alpha_ema_), _mm256_sub_pd(px, ema)));
+        pv = _mm256_add_pd(pv, _mm256_mul_pd(px, dv));
+        vol = _mm256_add_pd(vol, dv);
+        const __m256d den = _mm256_add_pd(bid, ask);
+        const __m256d empty = _mm256_cmp_pd(den, zero, _CMP_LE_OQ);
+        obi = _mm256_blendv_pd(
+            _mm256_div_pd(_mm256_sub_pd(bid, ask), _mm256_blendv_pd(den, _mm256_set1_pd(1.0), empty)), zero, empty);
+
+        __m256d out_day = day, out_px = px, out_vol = volume;
+        transpose4(out_day, out_px, out_vol, ema);
+        transpose4(var, pv, vol, obi);
+        _mm256_store_pd(s[0], out_day);
+        _mm256_store_pd(s[1], out_px);
+        _mm256_store_pd(s[2], out_vol);
+        _mm256_store_pd(s[3], ema);
+        _mm256_store_pd(s[0] + 4, var);
+        _mm256_store_pd(s[1] + 4, pv);
+        _mm256_store_pd(s[2] + 4, vol);
+        _mm256_store_pd(s[3] + 4, obi);
+    }
+#endif
+
+private:
+    size_t capacity_;
+    double alpha_ema_;
+    double alpha_vol_;
+    int64_t window_begin_; // 缓存的交易日窗口起点和对应的交易日
+    double window_day_;
+    State* state_;
+};
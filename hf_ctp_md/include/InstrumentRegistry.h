@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <emmintrin.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 合约注册表：订阅时把合约代码映射为稠密整数 id (0..size-1)，
+// 并记录最小变动价位，供热路径上的按合约统计/缓存和 tick 归一化使用。
+// 用法：add() 注册全部合约 -> build() 生成完美哈希 -> 之后只读，find() 可在任意线程调用
+//
+// 完美哈希采用 hash-and-displace：
+// - 合约代码补零到 32 字节，按 4 个 64 位字逐个乘法混合
+// - 高位选桶，每个桶一个位移值 disp，槽位 = mix(h + disp) & mask，构建时为每个桶搜索无冲突的 disp
+// - 槽位 32 字节：30 字节合约代码 + 2 字节 id，一次缓存行访问完成比较
+// 查找 = 一次哈希 + 两次数组访问 + 一次 32 字节 SIMD 比较，无分支搜索、无内存分配
+class InstrumentRegistry {
+public:
+    static const uint16_t INVALID_ID = 0xFFFF;
+    // 与 TThostFtdcOldInstrumentIDType 一致，现有合约代码均不超过 30 个字符
+    static const size_t MAX_ID_LENGTH = 30;
+    static const size_t MAX_INSTRUMENTS = INVALID_ID;
+
+    InstrumentRegistry();
+
+    // 槽位表按缓存行对齐，内部保存了对齐后的指针，不可拷贝
+    InstrumentRegistry(const InstrumentRegistry&) = delete;
+    InstrumentRegistry& operator=(const InstrumentRegistry&) = delete;
+
+    // 注册合约，已存在则返回原 id (价位以首次注册为准)
+    // 合约代码超过 MAX_ID_LENGTH 或合约数超过上限时抛出 std::invalid_argument
+    // 注册后需重新 build()，在此之前 find() 退化为线性查找
+    uint16_t add(const char* instrument_id, double price_tick = 1.0);
+
+    // 从 ctp_test/query_instruments 导出的 CSV 批量注册 (取 合约代码、最小变动价位 两列)
+    // 返回新注册的合约数，文件打不开返回 -1
+    int load_csv(const char* path);
+
+    // 生成完美哈希，返回 false 表示搜索失败 (实际不会发生，调用方可报错退出)
+    bool build();
+    bool built() const { return m_built; }
+
+    inline uint16_t find(const char* instrument_id) const __attribute__((always_inline)) {
+        if (__builtin_expect(!m_built, 0)) return find_linear(instrument_id);
+
+        Key key;
+        if (!make_key(instrument_id, key)) return INVALID_ID;
+        return lookup(key);
+    }
+
+    // 热路径版本：参数是 CTP 结构体里的定长字段 (如 81 字节的 InstrumentID)，
+    // 可以直接用两条 16 字节加载读取，免去 strnlen/memcpy
+    template<size_t N>
+    inline __attribute__((always_inline)) uint16_t find_field(const char (&instrument_id)[N]) const {
+        static_assert(N >= sizeof(Key), "field must be at least 32 bytes for the SIMD key load");
+        if (__builtin_expect(!m_built, 0)) return find_linear(instrument_id);
+
+        Key key;
+        if (!make_key_fixed(instrument_id, key)) return INVALID_ID;
+        return lookup(key);
+    }
+
+    const char* name(uint16_t id) const { return m_names[id].c_str(); }
+    double price_tick(uint16_t id) const { return m_priceTicks[id]; }
+    // 归一化时用乘法代替除法
+    double inv_price_tick(uint16_t id) const { return m_invPriceTicks[id]; }
+    size_t size() const { return m_names.size(); }
+
+private:
+    // 补零后的合约代码，按 64 位字哈希
+    union Key {
+        char bytes[32];
+        uint64_t words[4];
+    };
+
+    struct Slot {
+        char key[MAX_ID_LENGTH];
+        uint16_t id;
+    };
+
+    inline uint16_t lookup(const Key& key) const __attribute__((always_inline)) {
+        const uint64_t h = hash_key(key);
+        const Slot& slot = m_slots[slot_index(h, m_disp[h >> m_bucketShift])];
+
+        // 32 字节整体比较，忽略最后 2 字节 (槽位里存放的是 id)
+        const __m128i* s = reinterpret_cast<const __m128i*>(&slot);
+        const __m128i* k = reinterpret_cast<const __m128i*>(key.bytes);
+        const uint32_t eq = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(s), _mm_loadu_si128(k)))
+                          | ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(s + 1), _mm_loadu_si128(k + 1))) << 16);
+        if ((eq | 0xC0000000u) != 0xFFFFFFFFu) return INVALID_ID;
+        return slot.id;
+    }
+
+    // p 至少可读 32 字节：定位第一个 '\0'，把其后的字节清零
+    static inline bool make_key_fixed(const char* p, Key& key) __attribute__((always_inline)) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+        const uint32_t nul = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(lo, zero))
+                           | ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(hi, zero)) << 16);
+        // 前 31 字节内没有结束符 => 长度超过 MAX_ID_LENGTH
+        if ((nul & 0x7FFFFFFFu) == 0) return false;
+
+        const __m128i len = _mm_set1_epi8((char)__builtin_ctz(nul));
+        const __m128i idx_lo = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        const __m128i idx_hi = _mm_setr_epi8(16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+        lo = _mm_and_si128(lo, _mm_cmplt_epi8(idx_lo, len));
+        hi = _mm_and_si128(hi, _mm_cmplt_epi8(idx_hi, len));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(key.bytes), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(key.bytes + 16), hi);
+        return true;
+    }
+
+    static inline bool make_key(const char* instrument_id, Key& key) __attribute__((always_inline)) {
+        const size_t len = strnlen(instrument_id, MAX_ID_LENGTH + 1);
+        if (len > MAX_ID_LENGTH) return false;
+        key.words[0] = key.words[1] = key.words[2] = key.words[3] = 0;
+        memcpy(key.bytes, instrument_id, len);
+        return true;
+    }
+
+    static inline uint64_t mix(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    static inline uint64_t hash_key(const Key& key) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (int i = 0; i < 4; ++i) {
+            h = (h ^ key.words[i]) * 0x9E3779B97F4A7C15ULL;
+            h ^= h >> 32;
+        }
+        return mix(h);
+    }
+
+    inline size_t slot_index(uint64_t h, uint32_t disp) const {
+        return (size_t)(mix(h + disp * 0x9E3779B97F4A7C15ULL) & m_slotMask);
+    }
+
+    uint16_t find_linear(const char* instrument_id) const;
+
+private:
+    std::vector<std::string> m_names;
+    std::vector<double> m_priceTicks;
+    std::vector<double> m_invPriceTicks;
+    std::unordered_map<std::string, uint16_t> m_index; // 仅注册阶段去重用
+
+    // 完美哈希表 (build() 生成)
+    bool m_built;
+    unsigned m_bucketShift;
+    size_t m_slotMask;
+    std::vector<uint32_t> m_disp;
+    std::vector<Slot> m_slotStorage;
+    Slot* m_slots; // m_slotStorage 内按 64 字节对齐的起点，保证槽位不跨缓存行
+};
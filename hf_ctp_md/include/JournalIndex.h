@@ -0,0 +1,102 @@
+#pragma once
+
+#include "JournalReader.h"
+#include "Tick.h"
+#include "TickJournal.h"
+#include <string>
+#include <vector>
+
+// journal 的 (合约, 时间桶) -> 文件偏移 稀疏索引 (格式见 TickJournal.h)
+//
+// 建索引：TickRecorder 的写线程边写边 add()，stop() 时写出 <journal>.idx；
+//         没有索引或索引过期的 journal 可以用 JournalIndexBuilder::build() 顺序扫描一遍补建
+// 查询：JournalIndex::open() 后 query(合约, 起, 止) 得到 TickCursor，next() 逐条取出匹配的 tick
+//       定位为对排序条目的二分查找，之后只扫描命中条目覆盖的记录
+
+class JournalIndexBuilder {
+public:
+    static const int64_t DEFAULT_BUCKET_NS = 60LL * 1000000000LL;
+
+    explicit JournalIndexBuilder(int64_t bucket_ns = DEFAULT_BUCKET_NS);
+
+    void set_bucket_ns(int64_t bucket_ns);
+    int64_t bucket_ns() const { return m_bucketNs; }
+
+    // 记录 offset 处的 tick (offset 为其 RecordHeader 的文件偏移)，须按文件顺序调用
+    void add(const Tick& tick, uint64_t offset);
+
+    // 条目排序后写出，journal_size 为对应 journal 的最终长度
+    bool write(const std::string& path, size_t instrument_count, uint64_t journal_size);
+
+    // 顺序扫描已有的 journal 建索引，写到 <journal>.idx
+    static bool build(const std::string& journal_path, int64_t bucket_ns = DEFAULT_BUCKET_NS);
+
+    // 取出排好序的全部条目 (之后 builder 为空)
+    void take_entries(std::vector<journal::IndexEntry>& out);
+
+    size_t entry_count() const;
+    void clear();
+
+private:
+    int64_t m_bucketNs;
+    // 按合约分开存放，同一合约的条目基本按时间递增追加
+    std::vector<std::vector<journal::IndexEntry> > m_entries;
+};
+
+class JournalIndex;
+
+// 一次查询的结果游标，生命周期不能超过产生它的 JournalIndex
+// 按时间桶先后、桶内按文件顺序返回，与记录时该合约的先后顺序一致
+class TickCursor {
+public:
+    bool next(Tick& out);
+
+    // 已扫描的记录数 (包括其他合约的记录)，用于评估索引的选择性
+    uint64_t scanned() const { return m_scanned; }
+
+private:
+    friend class JournalIndex;
+    TickCursor(const JournalReader* pReader, const journal::IndexEntry* first, const journal::IndexEntry* last,
+               uint16_t instrument_id, int64_t bucket_ns, int64_t from_ns, int64_t to_ns);
+
+    const JournalReader* m_pReader;
+    const journal::IndexEntry* m_entry; // 下一个要扫描的条目
+    const journal::IndexEntry* m_last;  // 条目区间末尾 (不含)
+    int64_t m_bucketNs;
+    int64_t m_fromNs;
+    int64_t m_toNs;
+    uint16_t m_instrumentId;
+    int64_t m_bucket;                   // 当前条目的桶起点
+    uint64_t m_offset;                  // 当前条目内下一条记录的偏移
+    uint64_t m_end;                     // 当前条目的最后一条记录偏移
+    uint64_t m_scanned;
+};
+
+class JournalIndex {
+public:
+    JournalIndex();
+
+    // 打开 journal 及其 <journal>.idx；索引不存在或已过期时顺序扫描一遍在内存中重建
+    bool open(const std::string& journal_path, int64_t bucket_ns = JournalIndexBuilder::DEFAULT_BUCKET_NS);
+
+    // 合约在 [from_ns, to_ns) (交易所时间) 内的全部 tick
+    TickCursor query(uint16_t instrument_id, int64_t from_ns, int64_t to_ns) const;
+
+    // 按合约代码查找 journal 合约表中的 id，未找到返回 0xFFFF
+    uint16_t find_instrument(const char* instrument_id) const;
+
+    const JournalReader& reader() const { return m_reader; }
+    int64_t bucket_ns() const { return m_bucketNs; }
+    size_t entry_count() const { return m_entries.size(); }
+    // 索引来自 .idx 文件 (false 表示本次打开时现场重建)
+    bool loaded() const { return m_loaded; }
+
+private:
+    bool load(const std::string& index_path);
+
+private:
+    JournalReader m_reader;
+    std::vector<journal::IndexEntry> m_entries;
+    int64_t m_bucketNs;
+    bool m_loaded;
+};
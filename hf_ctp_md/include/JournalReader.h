@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Tick.h"
+#include "TickJournal.h"
+#include <cstdint>
+#include <string>
+
+// 行情日志读取：整个文件只读 mmap，按记录顺序遍历
+// - 打开时 MADV_SEQUENTIAL，内核加大预读并尽快回收已读页面
+// - 遍历过程中对游标前方的窗口发 MADV_WILLNEED，对已读过的区域发 MADV_DONTNEED，
+//   回放数 GB 的日志时常驻内存只有一个窗口大小
+// - 不认识的记录类型按长度跳过；遇到长度为 0 的记录头或文件末尾即结束
+class JournalReader {
+public:
+    static const size_t DEFAULT_WINDOW_SIZE = 64 << 20; // 预读/回收窗口 64 MB
+
+    JournalReader();
+    ~JournalReader();
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    // 映射文件并校验文件头 (魔数、版本、sizeof(Tick))，失败返回 false 并打印原因
+    bool open(const std::string& path, size_t window_size = DEFAULT_WINDOW_SIZE);
+    void close();
+
+    const journal::FileHeader& header() const { return *m_header; }
+    uint32_t trading_day() const { return m_header->trading_day; }
+    size_t instrument_count() const { return m_header->instrument_count; }
+    const char* instrument_id(size_t id) const { return m_instruments[id].instrument_id; }
+    double price_tick(size_t id) const { return m_instruments[id].price_tick; }
+
+    // 读取下一条 tick 记录，没有更多数据时返回 false
+    // 记录在文件中只保证 8 字节对齐，按值拷贝到调用方的 Tick
+    inline bool next(Tick& out) {
+        for (;;) {
+            if (m_offset + sizeof(journal::RecordHeader) > m_size) return false;
+            const journal::RecordHeader* rh = reinterpret_cast<const journal::RecordHeader*>(m_base + m_offset);
+            if (rh->length == 0 || m_offset + sizeof(journal::RecordHeader) + rh->length > m_size) return false;
+
+            const char* payload = m_base + m_offset + sizeof(journal::RecordHeader);
+            m_recordOffset = m_offset;
+            m_offset += sizeof(journal::RecordHeader) + rh->length;
+            if (__builtin_expect(m_offset >= m_adviseMark, 0)) advise();
+            if (rh->type == journal::RECORD_TICK && rh->length == sizeof(Tick)) {
+                memcpy(&out, payload, sizeof(Tick));
+                return true;
+            }
+        }
+    }
+
+    // 回到第一条记录
+    void rewind();
+
+    // 按偏移随机读取 (索引查询用)，不移动顺序游标；偏移处没有完整记录时返回 nullptr
+    inline const journal::RecordHeader* record_at(size_t offset) const {
+        if (offset < m_header->header_size || offset + sizeof(journal::RecordHeader) > m_size) return nullptr;
+        const journal::RecordHeader* rh = reinterpret_cast<const journal::RecordHeader*>(m_base + offset);
+        if (rh->length == 0 || offset + sizeof(journal::RecordHeader) + rh->length > m_size) return nullptr;
+        return rh;
+    }
+
+    // 改为随机访问模式：撤销顺序预读，只按索引读取少量记录时避免把整段文件读进来
+    void advise_random();
+
+    size_t size() const { return m_size; }
+    size_t offset() const { return m_offset; }
+    // 最近一次 next() 返回的记录的偏移
+    size_t record_offset() const { return m_recordOffset; }
+
+private:
+    void advise();
+
+private:
+    int m_fd;
+    const char* m_base;
+    size_t m_size;
+    size_t m_offset;
+    size_t m_recordOffset;
+    size_t m_window;
+    size_t m_adviseMark;   // 游标越过此偏移时推进预读/回收窗口
+    size_t m_releasedUpTo; // 已 MADV_DONTNEED 的前缀 (页对齐)
+    const journal::FileHeader* m_header;
+    const journal::InstrumentEntry* m_instruments;
+};
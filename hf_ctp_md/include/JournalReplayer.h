@@ -0,0 +1,69 @@
+#pragma once
+
+#include "JournalReader.h"
+#include "SPSCQueue.h"
+#include "ShardMap.h"
+#include "SnapshotTable.h"
+#include "Tick.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// 行情回放：在独立线程上按记录顺序把 journal 中的 tick 推入引擎队列，替代 CTP 回调线程作为生产者
+// - 队列满时自旋等待，从不丢弃，同一文件每次回放进入引擎的 tick 序列完全一致
+// - speed = 0 尽快回放 (压测吞吐)；speed = 1 按记录时的接收间隔 (receive_ns 差值) 回放；
+//   speed = N 为 N 倍速
+// - 入队时把 receive_ns 改写为当前时间，引擎统计的仍是 "入队 -> 处理" 的延迟；
+//   set_restamp(false) 保留原始接收时间
+// - 合约 id 沿用文件中的合约表，调用方须按 JournalReader 的合约表构建注册表；
+//   id 超出合约表的记录 (文件损坏) 跳过并计入 skipped()
+class JournalReplayer {
+public:
+    JournalReplayer(JournalReader* pReader, SPSCQueue<Tick>* pQueue);
+    ~JournalReplayer();
+
+    JournalReplayer(const JournalReplayer&) = delete;
+    JournalReplayer& operator=(const JournalReplayer&) = delete;
+
+    // 以下设置须在 start() 之前调用
+    void set_speed(double speed);
+    void set_cpu_affinity(int cpu_id);
+    void set_restamp(bool restamp);
+    // 与 CTPMdSpi 一样同时更新按合约的最新快照表
+    void set_snapshot_table(SnapshotTable<Tick>* pSnapshots);
+    // 与 CTPMdSpi::SetShards 相同：按合约写入对应分片的队列和快照表 (snapshots 可以为空)
+    void set_shards(const ShardMap& map, const std::vector<SPSCQueue<Tick>*>& queues,
+                    const std::vector<SnapshotTable<Tick>*>& snapshots);
+
+    void start();
+    // 中途停止回放 (回放结束后调用只负责回收线程)
+    void stop();
+
+    // 文件已全部推入队列
+    bool done() const { return m_done.load(std::memory_order_acquire); }
+    // 已推入队列的 tick 数 (中途停止时未能入队的不计)
+    uint64_t replayed() const { return m_replayed.load(std::memory_order_relaxed); }
+    uint64_t skipped() const { return m_skipped.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    // 推入队列，等待期间被 stop() 时返回 false
+    inline bool push(const Tick& tick);
+
+private:
+    JournalReader* m_pReader;
+    SPSCQueue<Tick>* m_pQueue;
+    SnapshotTable<Tick>* m_pSnapshots;
+    // 分片时按合约 id 查表，为空表示不分片
+    std::vector<SPSCQueue<Tick>*> m_shardQueues;
+    std::vector<SnapshotTable<Tick>*> m_shardSnapshots;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_done;
+    std::atomic<uint64_t> m_replayed; // 回放线程单写
+    std::atomic<uint64_t> m_skipped;  // 回放线程单写
+    size_t m_instrumentCount;         // 文件合约表大小，合法 id 为 [0, m_instrumentCount)
+    double m_speed;
+    int m_cpuId;
+    bool m_restamp;
+};
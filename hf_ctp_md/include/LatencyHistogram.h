@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+struct HistogramSnapshot;
+
+// 对数-线性延迟直方图 (HdrHistogram 的简化版)，固定内存，O(1) 记录
+// - 数值 < 64 时每个值一个桶 (精确)
+// - 之后每个 2 的幂次区间均分为 32 个子桶，相对误差 < 1/32 (~3%)
+// - 覆盖完整的 uint64 范围，无需预设上限，共 1920 个桶 (15 KB)
+//
+// 线程模型：单写多读
+// - record() 只能由一个线程调用 (行情引擎线程或交易回报线程)，
+//   计数用 relaxed load+store 代替原子加，热路径上没有 lock 前缀、分配和 I/O
+// - snapshot() 可在任意线程调用，得到累计计数的近似一致副本；
+//   写入方从不清零，"重置" 由读取方用两次快照相减实现 (HistogramSnapshot::subtract)，
+//   这样读写双方不需要任何同步
+class LatencyHistogram {
+public:
+    static const unsigned SUB_BUCKET_BITS = 5;
+    static const size_t SUB_BUCKET_COUNT = (size_t)1 << SUB_BUCKET_BITS;      // 32
+    static const size_t LINEAR_LIMIT = SUB_BUCKET_COUNT * 2;                  // 64
+    static const size_t BUCKET_COUNT = LINEAR_LIMIT + (64 - SUB_BUCKET_BITS - 1) * SUB_BUCKET_COUNT; // 1920
+
+    // 数值 -> 桶下标
+    static inline size_t bucket_index(uint64_t value) {
+        if (value < LINEAR_LIMIT) return (size_t)value;
+        const unsigned msb = 63 - (unsigned)__builtin_clzll(value);
+        const unsigned shift = msb - SUB_BUCKET_BITS;                     // >= 1
+        const size_t top = (size_t)(value >> shift) - SUB_BUCKET_COUNT;   // 0..31
+        return LINEAR_LIMIT + (size_t)(shift - 1) * SUB_BUCKET_COUNT + top;
+    }
+
+    // 桶内最小值 / 最大值
+    static inline uint64_t bucket_lowest(size_t index) {
+        if (index < LINEAR_LIMIT) return index;
+        const size_t k = index - LINEAR_LIMIT;
+        const unsigned shift = (unsigned)(k / SUB_BUCKET_COUNT) + 1;
+        return (uint64_t)(k % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT) << shift;
+    }
+
+    static inline uint64_t bucket_highest(size_t index) {
+        if (index < LINEAR_LIMIT) return index;
+        const unsigned shift = (unsigned)((index - LINEAR_LIMIT) / SUB_BUCKET_COUNT) + 1;
+        return bucket_lowest(index) + (((uint64_t)1 << shift) - 1);
+    }
+
+    LatencyHistogram() {
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) m_counts[i].store(0, std::memory_order_relaxed);
+        m_total.store(0, std::memory_order_relaxed);
+        m_sum.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // 仅写入线程调用
+    inline void record(uint64_t value) __attribute__((always_inline)) {
+        bump(m_counts[bucket_index(value)], 1);
+        bump(m_total, 1);
+        bump(m_sum, value);
+        if (value > m_max.load(std::memory_order_relaxed)) {
+            m_max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // 任意线程调用：复制累计计数
+    void snapshot(HistogramSnapshot& out) const;
+
+private:
+    static inline void bump(std::atomic<uint64_t>& c, uint64_t n) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> m_counts[BUCKET_COUNT];
+    std::atomic<uint64_t> m_total;
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max; // 累计最大值 (区间最大值由快照差分得到)
+};
+
+// 直方图快照：普通内存，由读取线程持有，可以相减、求分位数
+// 用法 (报告线程)：
+//   hist.snapshot(cur); interval = cur; interval.subtract(last); last = cur;
+//   interval.percentile(0.99) ...
+struct HistogramSnapshot {
+    uint64_t counts[LatencyHistogram::BUCKET_COUNT];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t max;
+
+    HistogramSnapshot() { clear(); }
+
+    void clear() {
+        memset(counts, 0, sizeof(counts));
+        total = sum = max = 0;
+    }
+
+    // this = this - prev，得到两次快照之间的区间分布
+    // 区间最大值取最高非空桶的上界，与累计最大值取较小者
+    void subtract(const HistogramSnapshot& prev) {
+        size_t highest = 0;
+        bool any = false;
+        for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+            // 快照之间写入方可能只完成了部分计数的更新，按 0 截断
+            counts[i] = counts[i] > prev.counts[i] ? counts[i] - prev.counts[i] : 0;
+            if (counts[i]) {
+                highest = i;
+                any = true;
+            }
+        }
+        total = total > prev.total ? total - prev.total : 0;
+        sum = sum > prev.sum ? sum - prev.sum : 0;
+        if (!any) {
+            max = 0;
+        } else if (LatencyHistogram::bucket_highest(highest) < max) {
+            max = LatencyHistogram::bucket_highest(highest);
+        }
+    }
+
+    // 分位数 (0~1)，返回所在桶的上界 (不超过 max)，与 HdrHistogram 的 highest equivalent value 一致
+    uint64_t percentile(double p) const {
+        uint64_t n = 0;
+        for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) n += counts[i];
+        if (n == 0) return 0;
+        uint64_t rank = (uint64_t)(p * (double)n + 0.5);
+        if (rank < 1) rank = 1;
+        if (rank > n) rank = n;
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                const uint64_t v = LatencyHistogram::bucket_highest(i);
+                return v < max || max == 0 ? v : max;
+            }
+        }
+        return max;
+    }
+
+    double mean() const { return total ? (double)sum / (double)total : 0.0; }
+};
+
+inline void LatencyHistogram::snapshot(HistogramSnapshot& out) const {
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) out.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+    out.total = m_total.load(std::memory_order_relaxed);
+    out.sum = m_sum.load(std::memory_order_relaxed);
+    out.max = m_max.load(std::memory_order_relaxed);
+}
@@ -2,26 +2,224 @@
 
 #include "SPSCQueue.h"
 #include "CTPMdSpi.h"
+#include "LatencyHistogram.h"
+#include "TickRecorder.h"
+#include "ShmBus.h"
+#include "UdpFeed.h"
+#include "BarAggregator.h"
+#include "IndicatorTable.h"
+#include "OrderBook.h"
+#include "TickHandler.h"
+#include "TscClock.h"
+#include <string>
 #include <thread>
 #include <atomic>
+#include <vector>
+#include <immintrin.h> // _mm_pause
 
+// 引擎线程的放置与内存设置 (配置文件 [ENGINE] 段)
+// 热循环开始前在引擎线程内依次执行，结果打印到启动日志
+struct EngineThreadConfig {
+    int cpu_id;       // 绑定的核心，< 0 不绑核
+    int rt_priority;  // SCHED_FIFO 优先级 (1~99)，0 保持默认调度策略
+    bool lock_memory; // mlockall(MCL_CURRENT | MCL_FUTURE)，需要 CAP_IPC_LOCK 或足够的 memlock 限额
+    bool prefault;    // 预先触碰队列和统计缓冲区，避免热循环里的缺页
+
+    EngineThreadConfig() : cpu_id(-1), rt_priority(0), lock_memory(false), prefault(true) {}
+};
+
+// 行情消费引擎：引擎线程轮询队列，记录延迟并转发给记录/总线/UDP；
+// 本身不带策略 (NullTickHandler)，挂策略用 StrategyEngine<Handler>
 class MarketDataEngine {
 public:
-    MarketDataEngine(SPSCQueue<MdData>* pQueue);
-    ~MarketDataEngine();
+    MarketDataEngine(SPSCQueue<Tick>* pQueue);
+    virtual ~MarketDataEngine();
 
+    // 启动引擎线程，阻塞到线程完成绑核/预热等准备工作后返回，
+    // 保证预热队列缓冲区时生产者还未开始写入
     void start();
     void stop();
     
-    // 设置线程亲和性 (绑定 CPU 核心)
+    // 设置线程亲和性 (绑定 CPU 核心)，等价于只修改 EngineThreadConfig::cpu_id
     void set_cpu_affinity(int cpu_id);
 
+    // 线程放置与内存设置，必须在 start() 之前调用
+    void set_thread_config(const EngineThreadConfig& config);
+
+    // 每次从队列批量取出的最大条数，整批处理完才归还槽位
+    void set_batch_size(size_t batch_size);
+
+    static const size_t DEFAULT_BATCH_SIZE = 64;
+
+    // 关联生产者侧的丢弃计数，统计输出时按合约打印新增丢弃，
+    // 用来区分是策略处理慢还是行情突发
+    void set_drop_counters(const DropCounters* pDrops, const InstrumentRegistry* pRegistry);
+
+    // 关联按合约的最新快照表，队列空闲时扫描有变化的合约
+    void set_snapshot_table(SnapshotTable<Tick>* pSnapshots);
+
+    // 关联行情记录，引擎处理的每个 tick 都推入记录环 (环满时丢弃，不阻塞)
+    // 可以在引擎运行后调用：记录文件要等登录拿到交易日才能打开，open() 成功后再挂上，
+    // 否则引擎会一直往没有写线程取走的环里追加
+    void set_recorder(TickRecorder* pRecorder);
+
+    // 关联共享内存行情总线，引擎处理的每个 tick 都广播给本机其他进程 (写端从不等待读端)
+    void set_bus(ShmBusWriter* pBus);
+
+    // 关联 UDP 组播转发，引擎处理的每个 tick 都推入转发环 (环满时丢弃，不阻塞)
+    void set_udp_publisher(UdpPublisher* pUdp);
+
+    // 关联多前置仲裁，统计输出时按前置打印胜出笔数与占比，判断哪条线路更快
+    void set_feed_arbiter(const FeedArbiter* pArbiter);
+
+    // 关联按合约的五档盘口，引擎线程逐笔更新，有变化的档位以 BookDelta 交给 Handler::onBookDelta
+    void set_order_book(OrderBookTable* pBook);
+
+    // 关联 K 线聚合，引擎线程逐笔更新，收盘的 bar 交给 Handler::onBar；停止时未收盘的 bar 一并交出
+    // 聚合器按全部合约推进交易所时钟，分片时每个引擎各用一个
+    void set_bar_aggregator(BarAggregator* pBars);
+
+    // 关联滚动指标表，引擎线程更新：batch 为 false 时逐笔更新 (onTick 时已包含当前 tick)，
+    // 为 true 时整批取出后批量更新 (onBatchEnd 时包含整批)；分片时每个引擎各用一个
+    void set_indicators(IndicatorTable* pIndicators, bool batch);
+
+    // 分片编号：多个引擎各自消费一个分片的队列时，日志前缀带上编号以区分各分片的吞吐和延迟
+    void set_shard(size_t index);
+
+    // 统计输出间隔，由独立的报告线程按此周期对延迟直方图做快照并打印
+    void set_report_interval_ms(unsigned interval_ms);
+
+    static const unsigned DEFAULT_REPORT_INTERVAL_MS = 1000;
+
+    // 累计延迟分布 (CTP 回调接收 -> 引擎处理，纳秒)，可在任意线程读取快照
+    const LatencyHistogram& latency() const { return m_latency; }
+
+    // 已处理的 tick 数 (每批更新一次)，可在任意线程读取
+    uint64_t tick_count() const { return m_tick_count.load(std::memory_order_relaxed); }
+
+protected:
+    // 引擎线程入口，子类改用自己的 Handler 调 poll_loop；虚函数只在线程启动时调用一次
+    virtual void run();
+
+    // 热循环：Handler 的回调在编译期绑定并内联
+    template<typename Handler>
+    void poll_loop(Handler& handler);
+
 private:
-    void run();
+    void thread_begin();
+    void thread_end(uint64_t count, uint64_t book_ticks, uint64_t book_deltas);
+    void report_loop();
+    void setup_thread();
+    void report_drops(std::vector<uint64_t>& last_drops);
+    // last 为上次打印时每个前置的 won/duplicate/stale/behind_ns，打印区间增量后更新
+    void report_fronts(std::vector<uint64_t>& last, const char* label);
 
 private:
-    SPSCQueue<MdData>* m_pQueue;
+    SPSCQueue<Tick>* m_pQueue;
     std::thread m_thread;
+    std::thread m_reporter;
     std::atomic<bool> m_running;
-    int m_cpu_id;
+    std::atomic<bool> m_ready;
+    EngineThreadConfig m_thread_cfg;
+    size_t m_batch_size;
+    const DropCounters* m_pDrops;
+    const InstrumentRegistry* m_pRegistry;
+    SnapshotTable<Tick>* m_pSnapshots;
+    std::atomic<TickRecorder*> m_pRecorder; // 运行中可能被挂上，引擎线程每批读取一次
+    ShmBusWriter* m_pBus;
+    UdpPublisher* m_pUdp;
+    const FeedArbiter* m_pArbiter;
+    OrderBookTable* m_pBook;
+    BarAggregator* m_pBars;
+    IndicatorTable* m_pIndicators;
+    bool m_indicator_batch;
+    unsigned m_report_interval_ms;
+    std::string m_tag; // 日志前缀中的分片编号，不分片时为空
+
+    // 引擎线程单写，报告线程只读
+    LatencyHistogram m_latency;
+    std::atomic<uint64_t> m_tick_count;
+    std::atomic<uint64_t> m_snapshot_count;
 };
+
+// 带策略的引擎：Handler 按值持有，在引擎线程内调用，见 TickHandler.h
+// 运行时选择策略时使用 StrategyEngine<VirtualTickHandler>
+template<typename Handler>
+class StrategyEngine : public MarketDataEngine {
+public:
+    explicit StrategyEngine(SPSCQueue<Tick>* pQueue, const Handler& handler = Handler())
+        : MarketDataEngine(pQueue), m_handler(handler) {}
+    // 必须在 m_handler 析构之前停止引擎线程
+    ~StrategyEngine() { stop(); }
+
+    // 引擎运行时只能由引擎线程访问
+    Handler& handler() { return m_handler; }
+
+protected:
+    virtual void run() { poll_loop(m_handler); }
+
+private:
+    Handler m_handler;
+};
+
+template<typename Handler>
+void MarketDataEngine::poll_loop(Handler& handler) {
+    uint64_t count = 0;
+    uint64_t snapshot_count = 0;
+    uint64_t book_ticks = 0;  // 五档有变化的 tick 数
+    uint64_t book_deltas = 0; // 产生的 BookDelta 总数
+    Tick snapshot; // 快照扫描的暂存区
+    BookDelta deltas[OrderBookTable::MAX_DELTAS];
+
+    thread_begin();
+
+    while (m_running) {
+        SPSCQueue<Tick>::Span batch = m_pQueue->peek_batch(m_batch_size);
+        if (!batch.empty()) {
+            // === 关键路径：无IO、无内存分配，原地读取整批槽位 ===
+            TickRecorder* const pRecorder = m_pRecorder.load(std::memory_order_acquire);
+            for (const Tick& tick : batch) {
+                const int64_t latency_ns = TscClock::wall_ns() - tick.receive_ns;
+                m_latency.record(latency_ns > 0 ? (uint64_t)latency_ns : 0);
+                if (pRecorder) pRecorder->append(tick);
+                if (m_pBus) m_pBus->publish(tick);
+                if (m_pUdp) m_pUdp->append(tick);
+                if (m_pBars) m_pBars->update(tick, handler);
+                if (m_pBook) {
+                    const size_t n = m_pBook->update(tick, deltas);
+                    if (n) {
+                        book_ticks++;
+                        book_deltas += n;
+                        handler.onBookDelta(deltas, n);
+                    }
+                }
+                if (m_pIndicators && !m_indicator_batch) m_pIndicators->update(tick);
+                handler.onTick(tick);
+            }
+            if (m_pIndicators && m_indicator_batch) m_pIndicators->update_batch(batch.data, batch.size());
+            handler.onBatchEnd();
+            count += batch.size();
+            m_tick_count.store(count, std::memory_order_relaxed);
+
+            // 整批处理完毕再一次性归还槽位
+            m_pQueue->release(batch.size());
+        } else {
+            // 队列空闲时扫描最新快照表：只看最新盘口的策略在这里处理，工作量以合约数为上限
+            size_t visited = 0;
+            if (m_pSnapshots) {
+                visited = m_pSnapshots->scan(snapshot, [&](size_t id, const Tick& tick) {
+                    snapshot_count++;
+                    handler.onSnapshot((uint16_t)id, tick);
+                });
+                m_snapshot_count.store(snapshot_count, std::memory_order_relaxed);
+            }
+            handler.onIdle();
+            if (visited == 0) {
+                _mm_pause();
+            }
+        }
+    }
+
+    if (m_pBars) m_pBars->flush(handler);
+    thread_end(count, book_ticks, book_deltas);
+}
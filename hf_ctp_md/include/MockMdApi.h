@@ -0,0 +1,111 @@
+#pragma once
+
+#include "ThostFtdcMdApi.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 模拟行情前置的参数 (配置文件 [MOCK] 段)
+struct MockMdConfig {
+    uint64_t rate;          // 平均每秒推送的 tick 数，0 表示不限速
+    size_t burst;           // 每次突发连续推送的 tick 数，突发之间空闲以维持平均速率
+    size_t instrument_count;// 只对订阅列表中前 N 个合约推送，0 表示全部
+    uint64_t max_ticks;     // 推送总数上限，0 表示不限
+    uint64_t seed;          // 价格随机游走的种子，相同参数下行情序列完全一致
+    int cpu_id;             // 推送线程绑定的核心，< 0 不绑核
+    std::string trading_day;// YYYYMMDD
+    int64_t start_ns;       // 行情时间轴起点 (UTC epoch 纳秒)，0 表示登录并订阅完成时
+    uint64_t delay_us;      // 注入的前置延迟：每次突发在其交易所时间之后 delay_us 才回调
+
+    MockMdConfig()
+        : rate(10000), burst(1), instrument_count(0), max_ticks(0), seed(1), cpu_id(-1),
+          trading_day("20250101"), start_ns(0), delay_us(0) {}
+};
+
+// 进程内模拟的 CThostFtdcMdApi，不依赖 CTP 动态库，用于离线压测 CTPMdSpi + MarketDataEngine
+// - Init() 启动自己的线程 (对应 CTP 的网络线程)，所有 Spi 回调都在该线程上触发
+// - 依次回调 OnFrontConnected / OnRspUserLogin / OnRspSubMarketData，
+//   登录并订阅后按 MockMdConfig 的速率与突发参数推送 OnRtnDepthMarketData
+// - 价格按最小变动价位随机游走 (SetPriceTick 设置，默认 1)，五档盘口围绕最新价展开
+// - 第 k 次突发的交易所时间为 起点 + k * 突发间隔 (不限速时取当前时间)；多个实例用相同参数和
+//   相同 start_ns 时生成完全一致的行情，各自的 delay_us 模拟不同前置的线路延迟 (A/B 仲裁测试)。
+//   就绪之前时间轴上的突发只生成不推送，就绪后两个实例的行情序列仍然对齐
+// - 与真实 API 一样通过 Release() 销毁
+class MockMdApi final : public CThostFtdcMdApi {
+public:
+    explicit MockMdApi(const MockMdConfig& config);
+
+    // 合约的最小变动价位，生成的价格都是它的整数倍；须在 SubscribeMarketData 之前设置
+    void SetPriceTick(const char* instrument_id, double price_tick);
+
+    // 已推送的 tick 数
+    uint64_t SentCount() const { return m_sent.load(std::memory_order_relaxed); }
+
+    // CThostFtdcMdApi 接口
+    virtual void Release() override;
+    virtual void Init() override;
+    virtual int Join() override;
+    virtual const char* GetTradingDay() override;
+    virtual void RegisterFront(char* pszFrontAddress) override;
+    virtual void RegisterNameServer(char* pszNsAddress) override;
+    virtual void RegisterFensUserInfo(CThostFtdcFensUserInfoField* pFensUserInfo) override;
+    virtual void RegisterSpi(CThostFtdcMdSpi* pSpi) override;
+    virtual int SubscribeMarketData(char* ppInstrumentID[], int nCount) override;
+    virtual int UnSubscribeMarketData(char* ppInstrumentID[], int nCount) override;
+    virtual int SubscribeForQuoteRsp(char* ppInstrumentID[], int nCount) override;
+    virtual int UnSubscribeForQuoteRsp(char* ppInstrumentID[], int nCount) override;
+    virtual int ReqUserLogin(CThostFtdcReqUserLoginField* pReqUserLoginField, int nRequestID) override;
+    virtual int ReqUserLogout(CThostFtdcUserLogoutField* pUserLogout, int nRequestID) override;
+    virtual int ReqQryMulticastInstrument(CThostFtdcQryMulticastInstrumentField* pQryMulticastInstrument, int nRequestID) override;
+
+private:
+    // 单个合约的行情状态
+    struct Instrument {
+        std::string id;
+        double price_tick;
+        int64_t last;     // 最新价 (tick 数)
+        int volume;
+        double turnover;
+        double open_interest;
+    };
+
+    // 基类析构函数是 protected 且非虚，只能经 Release() 销毁
+    ~MockMdApi();
+
+    void run();
+    void post(const std::function<void()>& request);
+    void drain_requests();
+    // exchange_ns 为这次突发的交易所时间 (UTC epoch 纳秒)；deliver 为 false 时只推进行情状态不回调
+    void publish_burst(size_t count, uint64_t& rng, int64_t exchange_ns, bool deliver);
+    // 下一次突发的 tick 数 (受 MaxTicks 限制)
+    size_t burst_size() const;
+    void fill_tick(Instrument& inst, uint64_t& rng, CThostFtdcDepthMarketDataField& md);
+
+private:
+    MockMdConfig m_config;
+    std::atomic<CThostFtdcMdSpi*> m_pSpi;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::atomic<uint64_t> m_sent;
+
+    // 请求 (登录/订阅) 由调用线程投递，模拟线程执行并回调
+    std::mutex m_requestMutex;
+    std::vector<std::function<void()> > m_requests;
+    std::atomic<bool> m_hasRequests;
+
+    // Init() 之前设置，之后只读
+    std::vector<std::pair<std::string, double> > m_priceTicks;
+
+    // 以下只在模拟线程上访问
+    bool m_loggedIn;
+    uint64_t m_generated;  // 已生成的 tick 数 (含就绪前只生成不推送的)，MaxTicks 按它计数
+    std::vector<Instrument> m_instruments;
+    size_t m_cursor;
+    char m_updateTime[9];
+    char m_actionDay[9];
+    int m_updateMillisec;
+};
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "Tick.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <immintrin.h>
+
+// 五档盘口的一次变化：某个合约某一边的某一档价格或数量变了
+// 档位按位置编号 (0 为买一/卖一)，价格整体移动时后面各档都会报告变化
+struct BookDelta {
+    uint16_t instrument_id;
+    uint8_t  side;     // 0 买，1 卖
+    uint8_t  level;    // 0~4
+    int32_t  px;       // 新价格 (tick 数)，0 表示该档为空
+    int32_t  vol;      // 新数量
+    int32_t  prev_px;  // 变化前的价格和数量，合约的第一笔行情为 0
+    int32_t  prev_vol;
+};
+
+namespace orderbook_detail {
+
+// Tick 中 bid_px/ask_px/bid_vol/ask_vol 连续存放，共 20 个 int32，按这个顺序整体比较
+static const size_t FIELDS = 20;
+static_assert(offsetof(Tick, ask_px) == offsetof(Tick, bid_px) + 5 * sizeof(int32_t) &&
+              offsetof(Tick, bid_vol) == offsetof(Tick, bid_px) + 10 * sizeof(int32_t) &&
+              offsetof(Tick, ask_vol) == offsetof(Tick, bid_px) + 15 * sizeof(int32_t),
+              "Tick depth fields must be contiguous");
+
+// 逐个比较，返回不相等字段的位图 (bit i 对应第 i 个字段)；作为 SIMD 版本的参照
+inline uint32_t changed_fields_scalar(const int32_t* a, const int32_t* b) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < FIELDS; ++i) mask |= (uint32_t)(a[i] != b[i]) << i;
+    return mask;
+}
+
+// 同上，20 个字段 = 16 + 4：前 16 个用一次 512 位 (AVX-512) 或两次 256 位 (AVX2) 比较，后 4 个用一次 128 位比较，
+// 各次比较互不重叠；都没有时用五次 SSE2 比较
+inline uint32_t changed_fields(const int32_t* a, const int32_t* b) {
+    const uint32_t tail_equal = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(
+        _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(a + 16)), _mm_loadu_si128((const __m128i*)(b + 16)))));
+#if defined(__AVX512F__)
+    const uint32_t head_changed = (uint32_t)_mm512_cmpneq_epi32_mask(_mm512_loadu_si512(a), _mm512_loadu_si512(b));
+    return head_changed | (~tail_equal & 0xF) << 16;
+#elif defined(__AVX2__)
+    const __m256i eq0 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)a),
+                                           _mm256_loadu_si256((const __m256i*)b));
+    const __m256i eq1 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(a + 8)),
+                                           _mm256_loadu_si256((const __m256i*)(b + 8)));
+    const uint32_t equal = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(eq0)) |
+                           (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(eq1)) << 8 | tail_equal << 16;
+    return ~equal & ((1u << FIELDS) - 1);
+#else
+    uint32_t equal = tail_equal << 16;
+    for (size_t i = 0; i < 16; i += 4) {
+        const __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(a + i)),
+                                           _mm_loadu_si128((const __m128i*)(b + i)));
+        equal |= (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(eq)) << i;
+    }
+    return ~equal & ((1u << FIELDS) - 1);
+#endif
+}
+
+// 字段位图 -> 档位位图：bit 0~4 买一~买五，bit 5~9 卖一~卖五，价格或数量任一变化即算该档变化
+inline uint32_t changed_levels(uint32_t fields) {
+    return (fields | fields >> 10) & 0x3FF;
+}
+
+} // namespace orderbook_detail
+
+// 按合约的五档盘口 (单写者，在引擎线程内更新)
+// - 每个合约一个缓存行对齐的 Book，价格和数量按边各存一个数组，与 Tick 的字段顺序相同，
+//   一次 SIMD 比较就能得出 20 个字段中哪些变了
+// - update() 只把变化的档位写成 BookDelta，下游不用每笔重读全部 20 个字段
+// - 分片时多个引擎可以共用一张表：各分片的合约互不相同，Book 独占缓存行，不存在共享写
+class OrderBookTable {
+public:
+    static const size_t LEVELS = 5;
+    static const size_t MAX_DELTAS = 2 * LEVELS; // 一笔行情最多产生的 BookDelta 数
+
+    struct alignas(CACHELINE_SIZE) Book {
+        int32_t bid_px[LEVELS];
+        int32_t ask_px[LEVELS];
+        int32_t bid_vol[LEVELS];
+        int32_t ask_vol[LEVELS];
+        int64_t exchange_ts_ns; // 最后一次更新的交易所时间
+        uint64_t updates;       // 盘口有变化的行情笔数
+    };
+    static_assert(offsetof(Book, exchange_ts_ns) == orderbook_detail::FIELDS * sizeof(int32_t),
+                  "Book depth fields must be contiguous");
+
+    explicit OrderBookTable(size_t instrument_count) : capacity_(instrument_count) {
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, CACHELINE_SIZE, sizeof(Book) * (capacity_ ? capacity_ : 1)) != 0) {
+            throw std::bad_alloc();
+        }
+        books_ = static_cast<Book*>(ptr);
+        memset(static_cast<void*>(books_), 0, sizeof(Book) * capacity_);
+    }
+
+    ~OrderBookTable() { free(books_); }
+
+    OrderBookTable(const OrderBookTable&) = delete;
+    OrderBookTable& operator=(const OrderBookTable&) = delete;
+
+    size_t capacity() const { return capacity_; }
+
+    const Book& book(uint16_t id) const { return books_[id]; }
+
+    // 用 tick 更新盘口，返回变化的档位位图 (见 orderbook_detail::changed_levels)
+    inline uint32_t update(const Tick& tick) __attribute__((always_inline)) {
+        Book& book = books_[tick.instrument_id];
+        const uint32_t fields = orderbook_detail::changed_fields(book.bid_px, tick.bid_px);
+        if (fields) store(book, tick);
+        return orderbook_detail::changed_levels(fields);
+    }
+
+    // 同上，把变化的档位写入 out (至少 MAX_DELTAS 个)，按买一~买五、卖一~卖五的顺序，返回个数
+    inline size_t update(const Tick& tick, BookDelta* out) __attribute__((always_inline)) {
+        Book& book = books_[tick.instrument_id];
+        const uint32_t fields = orderbook_detail::changed_fields(book.bid_px, tick.bid_px);
+        if (!fields) return 0;
+
+        uint32_t levels = orderbook_detail::changed_levels(fields);
+        size_t n = 0;
+        while (levels) {
+            const unsigned bit = (unsigned)__builtin_ctz(levels);
+            levels &= levels - 1;
+            const bool ask = bit >= LEVELS;
+            const unsigned level = ask ? bit - LEVELS : bit;
+            BookDelta& delta = out[n++];
+            delta.instrument_id = tick.instrument_id;
+            delta.side = ask ? 1 : 0;
+            delta.level = (uint8_t)level;
+            delta.px = ask ? tick.ask_px[level] : tick.bid_px[level];
+            delta.vol = ask ? tick.ask_vol[level] : tick.bid_vol[level];
+            delta.prev_px = ask ? book.ask_px[level] : book.bid_px[level];
+            delta.prev_vol = ask ? book.ask_vol[level] : book.bid_vol[level];
+        }
+        store(book, tick);
+        return n;
+    }
+
+private:
+    static inline void store(Book& book, const Tick& tick) {
+        memcpy(book.bid_px, tick.bid_px, orderbook_detail::FIELDS * sizeof(int32_t));
+        book.exchange_ts_ns = tick.exchange_ts_ns;
+        book.updates++;
+    }
+
+private:
+    Book* books_;
+    size_t capacity_;
+};
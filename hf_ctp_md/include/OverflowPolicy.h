@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// 行情队列满时的处理策略
+// 生产者是 CTP 自己的网络线程，任何策略都不能无限期阻塞它
+enum class OverflowPolicy {
+    DropNewest,      // 丢弃新到的 tick 并计数
+    OverwriteOldest, // 淘汰队列里最旧的 tick 为新 tick 腾位 (消费者正在读队头时退化为丢弃新 tick)
+    Conflate,        // 按合约合并：暂存每个合约最新的一笔，队列有空位时再补发
+    SpinTimeout      // 自旋等待空位，超过 spin_timeout_ns 仍满则丢弃
+};
+
+struct OverflowConfig {
+    OverflowPolicy policy;
+    uint64_t spin_timeout_ns;
+
+    OverflowConfig() : policy(OverflowPolicy::DropNewest), spin_timeout_ns(20000) {}
+};
+
+inline const char* overflow_policy_name(OverflowPolicy policy) {
+    switch (policy) {
+        case OverflowPolicy::DropNewest:      return "drop_newest";
+        case OverflowPolicy::OverwriteOldest: return "overwrite_oldest";
+        case OverflowPolicy::Conflate:        return "conflate";
+        case OverflowPolicy::SpinTimeout:     return "spin_timeout";
+    }
+    return "unknown";
+}
+
+// overflow_policy_name() 的逆操作，用于读取配置；无法识别时返回 false 且不修改 policy
+inline bool parse_overflow_policy(const char* name, OverflowPolicy& policy) {
+    static const OverflowPolicy all[] = {
+        OverflowPolicy::DropNewest, OverflowPolicy::OverwriteOldest,
+        OverflowPolicy::Conflate, OverflowPolicy::SpinTimeout
+    };
+    for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); ++i) {
+        if (strcmp(name, overflow_policy_name(all[i])) == 0) {
+            policy = all[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+// 按合约的丢弃计数
+// 只有生产者 (CTP 线程) 写入，用 relaxed load+store 代替原子加，避免 lock 前缀；
+// 引擎/统计线程可随时读取，读到的是近似最新值
+class DropCounters {
+public:
+    struct Counters {
+        std::atomic<uint64_t> dropped;     // 新 tick 被丢弃 (含自旋超时)
+        std::atomic<uint64_t> overwritten; // 旧 tick 被淘汰
+        std::atomic<uint64_t> conflated;   // 暂存的 tick 被同合约更新的 tick 覆盖
+    };
+
+    // 最后一个槽位记录未注册合约
+    explicit DropCounters(size_t instrument_count)
+        : m_size(instrument_count + 1), m_counters(new Counters[instrument_count + 1]) {
+        for (size_t i = 0; i < m_size; ++i) {
+            m_counters[i].dropped.store(0, std::memory_order_relaxed);
+            m_counters[i].overwritten.store(0, std::memory_order_relaxed);
+            m_counters[i].conflated.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ~DropCounters() { delete[] m_counters; }
+
+    DropCounters(const DropCounters&) = delete;
+    DropCounters& operator=(const DropCounters&) = delete;
+
+    // 槽位数 = 合约数 + 1 (未注册合约)
+    size_t size() const { return m_size; }
+
+    // 超出范围的 id (含 InstrumentRegistry::INVALID_ID) 记到未注册槽位
+    Counters& at(size_t id) { return m_counters[id < m_size ? id : m_size - 1]; }
+    const Counters& at(size_t id) const { return m_counters[id < m_size ? id : m_size - 1]; }
+
+    static inline void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    uint64_t total() const {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < m_size; ++i) {
+            sum += m_counters[i].dropped.load(std::memory_order_relaxed)
+                 + m_counters[i].overwritten.load(std::memory_order_relaxed)
+                 + m_counters[i].conflated.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+private:
+    size_t m_size;
+    Counters* m_counters;
+};
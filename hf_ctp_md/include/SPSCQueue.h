@@ -2,66 +2,232 @@
 
 #include <atomic>
 #include <cstdlib>
+#include <cstring>
 #include <new>
 #include <cassert>
+#include <stdexcept>
 
 #ifndef CACHELINE_SIZE
 #define CACHELINE_SIZE 64
 #endif
 
+// 单生产者单消费者环形队列
+// - 容量必须是 2 的幂次，下标用 & mask_ 代替取模
+// - head_/tail_ 为单调递增计数，实际槽位为 index & mask_，可用容量即 capacity
+// - 生产者持有 head_ 的本地副本，消费者持有 tail_ 的本地副本，
+//   只有本地副本显示"满"或"空"时才去读取对端的原子变量，避免每次操作都跨核拉取缓存行
+// - 可选覆盖模式 (set_overwrite)：队列满时生产者可以淘汰最旧的一条为新数据腾位，
+//   消费者读取期间用 head_ 的 HELD_BIT 标记占用，生产者只淘汰未被占用的槽位
 template<typename T>
 class SPSCQueue {
 public:
-    explicit SPSCQueue(size_t capacity) : capacity_(capacity) {
+    // 批量读取返回的一段连续槽位 (不跨越环形缓冲区末尾)
+    struct Span {
+        T* data;
+        size_t count;
+
+        T* begin() const { return data; }
+        T* end() const { return data + count; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        T& operator[](size_t i) const { return data[i]; }
+    };
+
+    explicit SPSCQueue(size_t capacity) : capacity_(capacity), mask_(capacity - 1) {
+        if (capacity_ < 2 || (capacity_ & mask_) != 0) {
+            throw std::invalid_argument("SPSCQueue capacity must be a power of two");
+        }
+
         // 手动分配对齐内存
         // C++17 以前用 posix_memalign，C++17 可以用 std::aligned_alloc
         // 这里为了兼容性使用 posix_memalign
         void* ptr = nullptr;
-        if (posix_memalign(&ptr, CACHELINE_SIZE, sizeof(T) * (capacity_ + 1)) != 0) {
+        if (posix_memalign(&ptr, CACHELINE_SIZE, sizeof(T) * capacity_) != 0) {
             throw std::bad_alloc();
         }
         buffer_ = static_cast<T*>(ptr);
-        
-        head_.store(0, std::memory_order_relaxed);
+
         tail_.store(0, std::memory_order_relaxed);
+        head_cache_ = 0;
+        head_.store(0, std::memory_order_relaxed);
+        tail_cache_ = 0;
+        overwrite_ = false;
     }
 
     ~SPSCQueue() {
         free(buffer_);
     }
 
-    // 强制内联
-    inline bool push(const T& item) __attribute__((always_inline)) {
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    // 堆上分配 (如每个分片一个队列) 时同样保持缓存行对齐，C++17 以前全局 new 不保证
+    static void* operator new(size_t size) {
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, CACHELINE_SIZE, size) != 0) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+    static void operator delete(void* ptr) { free(ptr); }
+
+    // === 生产者零拷贝接口 ===
+    // claim() 返回下一个可写槽位，队列满时返回 nullptr；
+    // 调用方原地填充后调用 commit() 发布，两次调用之间不得再 claim
+    inline T* claim() __attribute__((always_inline)) {
         const size_t current_tail = tail_.load(std::memory_order_relaxed);
-        const size_t next_tail = (current_tail + 1) % (capacity_ + 1);
 
-        if (next_tail == head_.load(std::memory_order_acquire)) {
-            return false;
+        if (current_tail - head_cache_ == capacity_) {
+            // 本地副本显示已满，才刷新一次对端的 head_
+            head_cache_ = head_.load(std::memory_order_acquire) & ~HELD_BIT;
+            if (current_tail - head_cache_ == capacity_) {
+                return nullptr;
+            }
         }
+        return &buffer_[current_tail & mask_];
+    }
 
-        buffer_[current_tail] = item;
-        tail_.store(next_tail, std::memory_order_release);
-        return true;
+    // 覆盖模式下 claim() 失败后调用：淘汰最旧的一条并返回腾出的槽位，之后照常 commit()。
+    // 消费者正持有队头槽位时无法淘汰，返回 nullptr；*evicted 置为是否真的淘汰了旧数据，
+    // 为 true 时返回的槽位里仍是被淘汰的旧元素，调用方覆写前可读取用于统计
+    inline T* claim_overwrite(bool* evicted) {
+        assert(overwrite_);
+        const size_t current_tail = tail_.load(std::memory_order_relaxed);
+        size_t current_head = head_.load(std::memory_order_acquire);
+
+        *evicted = false;
+        if (current_head & HELD_BIT) {
+            return nullptr;
+        }
+        if (current_tail - current_head != capacity_) {
+            // 消费者刚刚腾出了空间，不必淘汰
+            head_cache_ = current_head;
+            return &buffer_[current_tail & mask_];
+        }
+        if (!head_.compare_exchange_strong(current_head, current_head + 1,
+                                           std::memory_order_acq_rel, std::memory_order_acquire)) {
+            // 消费者抢先占用了队头
+            return nullptr;
+        }
+        head_cache_ = current_head + 1;
+        *evicted = true;
+        return &buffer_[current_tail & mask_];
     }
 
-    inline bool pop(T& item) __attribute__((always_inline)) {
+    inline void commit() __attribute__((always_inline)) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // === 消费者零拷贝接口 ===
+    // peek() 返回队头元素的指针，队列空时返回 nullptr；
+    // 原地读取完毕后调用 release() 归还槽位，之后指针失效
+    inline T* peek() __attribute__((always_inline)) {
+        const Span span = peek_batch(1);
+        return span.empty() ? nullptr : span.data;
+    }
+
+    inline void release() __attribute__((always_inline)) {
+        release(1);
+    }
+
+    // === 消费者批量接口 ===
+    // 返回最多 max_count 个已就绪的连续槽位，处理完毕后用 release(n) 一次性归还，
+    // 整批只发布一次 head_。环形回绕处会截断，剩余部分由下一次调用取得
+    inline Span peek_batch(size_t max_count) __attribute__((always_inline)) {
+        if (__builtin_expect(overwrite_, 0)) {
+            return peek_batch_shared(max_count);
+        }
+
         const size_t current_head = head_.load(std::memory_order_relaxed);
 
-        if (current_head == tail_.load(std::memory_order_acquire)) {
-            return false;
+        size_t available = tail_cache_ - current_head;
+        if (available < max_count) {
+            // 本地副本不够一整批，刷新一次对端的 tail_
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            available = tail_cache_ - current_head;
         }
 
-        item = buffer_[current_head];
-        head_.store((current_head + 1) % (capacity_ + 1), std::memory_order_release);
+        return make_span(current_head, available, max_count);
+    }
+
+    inline void release(size_t n) __attribute__((always_inline)) {
+        // 覆盖模式下同时清除 HELD_BIT；持有期间生产者不会修改 head_
+        head_.store((head_.load(std::memory_order_relaxed) & ~HELD_BIT) + n, std::memory_order_release);
+    }
+
+    // === 拷贝接口 (基于上面的零拷贝接口) ===
+    // 强制内联
+    inline bool push(const T& item) __attribute__((always_inline)) {
+        T* slot = claim();
+        if (!slot) return false;
+        *slot = item;
+        commit();
+        return true;
+    }
+
+    inline bool pop(T& item) __attribute__((always_inline)) {
+        const T* slot = peek();
+        if (!slot) return false;
+        item = *slot;
+        release();
         return true;
     }
 
+    size_t capacity() const { return capacity_; }
+
+    // 开启覆盖模式，必须在生产者/消费者线程启动前调用
+    void set_overwrite(bool enable) { overwrite_ = enable; }
+    bool overwrite() const { return overwrite_; }
+
+    // 逐页写零，让缓冲区在进入热循环前就有物理页 (posix_memalign 只分配虚拟地址)
+    // 会覆盖槽位内容，必须在生产者开始写入前调用
+    void prefault() { memset(static_cast<void*>(buffer_), 0, sizeof(T) * capacity_); }
+
 private:
+    static const size_t HELD_BIT = (size_t)1 << (sizeof(size_t) * 8 - 1);
+
+    inline Span make_span(size_t current_head, size_t available, size_t max_count) const {
+        const size_t offset = current_head & mask_;
+        size_t count = available < max_count ? available : max_count;
+        if (count > capacity_ - offset) {
+            count = capacity_ - offset;
+        }
+
+        Span span;
+        span.data = &buffer_[offset];
+        span.count = count;
+        return span;
+    }
+
+    // 覆盖模式的消费者路径：head_ 可能被生产者推进，不能使用本地副本；
+    // 有数据时用 CAS 置 HELD_BIT 占住队头，直到 release()
+    Span peek_batch_shared(size_t max_count) {
+        size_t current_head = head_.load(std::memory_order_acquire);
+        for (;;) {
+            const size_t available = tail_.load(std::memory_order_acquire) - current_head;
+            if (available == 0) {
+                return make_span(current_head, 0, max_count);
+            }
+            if (head_.compare_exchange_weak(current_head, current_head | HELD_BIT,
+                                            std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return make_span(current_head, available, max_count);
+            }
+        }
+    }
+
+    // 只读区：构造后不再修改，两端共享
     T* buffer_; // 裸指针
     size_t capacity_;
+    size_t mask_;
+    bool overwrite_;
 
+    // 生产者缓存行：tail_ 与 head_ 的本地副本
     alignas(CACHELINE_SIZE) std::atomic<size_t> tail_;
+    size_t head_cache_;
+
+    // 消费者缓存行：head_ 与 tail_ 的本地副本
     alignas(CACHELINE_SIZE) std::atomic<size_t> head_;
-    
-    char padding_[CACHELINE_SIZE - sizeof(std::atomic<size_t>)]; 
-};
\ No newline at end of file
+    size_t tail_cache_;
+
+    char padding_[CACHELINE_SIZE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+};
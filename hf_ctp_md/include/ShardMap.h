@@ -0,0 +1,63 @@
+#pragma once
+
+#include "InstrumentRegistry.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 合约 -> 分片的映射：每个分片一个 SPSC 队列和一个引擎线程
+// - 同一合约永远进同一分片，分片内按入队顺序处理，合约内的先后顺序不变
+// - 默认按合约 id 轮转分配；assign() 按 "合约代码:分片" 或 "前缀*:分片" 覆盖，
+//   如把同一标的的期权 (IO2506-C-*) 集中到一个分片
+// - 生产者按 id 查表 (每个合约一个字节)，分片数不超过 MAX_SHARDS
+class ShardMap {
+public:
+    static const size_t MAX_SHARDS = 64;
+
+    ShardMap(const InstrumentRegistry& registry, size_t shard_count)
+        : m_registry(registry), m_shardCount(shard_count == 0 ? 1 : shard_count < MAX_SHARDS ? shard_count : MAX_SHARDS),
+          m_shardOf(registry.size()) {
+        for (size_t id = 0; id < m_shardOf.size(); ++id) m_shardOf[id] = (uint8_t)(id % m_shardCount);
+    }
+
+    size_t shard_count() const { return m_shardCount; }
+    size_t instrument_count() const { return m_shardOf.size(); }
+
+    inline size_t shard_of(uint16_t id) const { return m_shardOf[id]; }
+
+    // 解析一项 "合约代码:分片" 或 "前缀*:分片"，返回匹配的合约数；格式错误或分片越界返回 -1
+    int assign(const std::string& item) {
+        const size_t colon = item.rfind(':');
+        if (colon == std::string::npos || colon == 0) return -1;
+        char* end = nullptr;
+        const long shard = strtol(item.c_str() + colon + 1, &end, 10);
+        if (end == item.c_str() + colon + 1 || *end != '\0' || shard < 0 || (size_t)shard >= m_shardCount) return -1;
+
+        std::string pattern = item.substr(0, colon);
+        const bool prefix = pattern[pattern.size() - 1] == '*';
+        if (prefix) pattern.erase(pattern.size() - 1);
+        int matched = 0;
+        for (size_t id = 0; id < m_shardOf.size(); ++id) {
+            const char* name = m_registry.name((uint16_t)id);
+            if (prefix ? strncmp(name, pattern.c_str(), pattern.size()) == 0 : pattern == name) {
+                m_shardOf[id] = (uint8_t)shard;
+                ++matched;
+            }
+        }
+        return matched;
+    }
+
+    // 分到 shard 的合约数
+    size_t instruments_in(size_t shard) const {
+        size_t count = 0;
+        for (size_t id = 0; id < m_shardOf.size(); ++id) count += m_shardOf[id] == shard;
+        return count;
+    }
+
+private:
+    const InstrumentRegistry& m_registry;
+    size_t m_shardCount;
+    std::vector<uint8_t> m_shardOf;
+};
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "Tick.h"
+#include "TickJournal.h"
+#include "InstrumentRegistry.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// 共享内存行情总线：hf_ctp_md 的引擎线程把归一化 tick 广播给本机的多个策略进程
+//
+// 单写多读的广播环，写端从不等待读端：
+// - 每个槽位带序号 (seqlock)，写入第 n 条 (从 0 计) 时先置 2n+1 (写入中)，写完置 2n+2
+// - 读端各自维护游标，只读共享内存 (PROT_READ)，读端之间、读端与写端之间没有任何共享的可写状态
+// - 读端落后超过一圈时槽位序号会大于期望值，即被套圈：计数后跳到最新位置继续读
+// - 优先在 hugetlbfs (默认 /dev/hugepages) 上建文件，使用 2MB 大页；
+//   没有挂载或大页不足时退回 POSIX shm (/dev/shm)，并对映射做 MADV_HUGEPAGE (shmem THP 开启时生效)
+//
+// 布局：[BusHeader][InstrumentEntry x instrument_count][补零到 header_size][Slot x capacity]
+namespace shmbus {
+
+const char MAGIC[8] = {'H', 'F', 'T', 'S', 'H', 'M', 'B', '\0'};
+const uint32_t VERSION = 1;
+const size_t PAGE_SIZE = 4096;
+const size_t HUGE_PAGE_SIZE = 2 << 20;
+
+enum BusState : uint32_t {
+    STATE_INIT = 0,    // 写端正在初始化
+    STATE_RUNNING = 1,
+    STATE_CLOSED = 2   // 写端已退出，不会再有新数据
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared-memory atomics must be lock-free");
+
+struct BusHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;       // 头 + 合约表，按页对齐，即第一个槽位的偏移
+    uint64_t capacity;          // 槽位数，2 的幂次
+    uint32_t slot_size;         // sizeof(Slot)，结构变化时拒绝挂载
+    uint32_t instrument_count;  // 合约表条数，下标即 Tick::instrument_id
+    uint32_t writer_pid;
+    uint32_t huge_pages;        // 1 表示映射在 hugetlbfs 上
+    int64_t created_ns;         // 总线创建时间 (UTC epoch 纳秒)，写端重启后变化
+    char reserved[80];
+
+    // 写端单写，单独占一个缓存行
+    alignas(CACHELINE_SIZE) std::atomic<uint64_t> write_seq; // 已发布的条数
+    std::atomic<uint32_t> state;                             // BusState
+    char pad[CACHELINE_SIZE - sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<uint32_t>)];
+};
+
+struct alignas(CACHELINE_SIZE) Slot {
+    std::atomic<uint64_t> seq;  // 2n+1 写入中，2n+2 第 n 条已写完，0 从未写入
+    char pad[CACHELINE_SIZE - sizeof(std::atomic<uint64_t>)];
+    Tick tick;
+};
+
+static_assert(sizeof(BusHeader) == 192, "BusHeader layout changed");
+static_assert(sizeof(Slot) == 3 * CACHELINE_SIZE, "Slot layout changed");
+
+inline size_t header_size_for(size_t instrument_count) {
+    const size_t raw = sizeof(BusHeader) + instrument_count * sizeof(journal::InstrumentEntry);
+    return (raw + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+}
+
+} // namespace shmbus
+
+// 写端：只能有一个进程、一个线程调用 publish()
+class ShmBusWriter {
+public:
+    static const size_t DEFAULT_CAPACITY = 65536;  // 12 MB，约 65ms@1M/s 的读端停顿不会被套圈
+
+    ShmBusWriter();
+    ~ShmBusWriter();
+
+    ShmBusWriter(const ShmBusWriter&) = delete;
+    ShmBusWriter& operator=(const ShmBusWriter&) = delete;
+
+    // 创建总线 (同名的旧总线先删除，已挂载的读端看到 STATE_CLOSED)
+    // name 为总线名 (不含 /)，hugepage_dir 为空时不尝试大页；capacity 须为 2 的幂次
+    bool open(const std::string& name, size_t capacity, const InstrumentRegistry& registry,
+              const std::string& hugepage_dir = "/dev/hugepages");
+    // 标记 STATE_CLOSED 并删除总线文件，已挂载的读端仍可读完剩余数据
+    void close();
+
+    // === 引擎线程调用 ===
+    inline void publish(const Tick& tick) __attribute__((always_inline)) {
+        shmbus::Slot& slot = m_slots[m_seq & m_mask];
+        slot.seq.store(2 * m_seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&slot.tick, &tick, sizeof(Tick));
+        slot.seq.store(2 * m_seq + 2, std::memory_order_release);
+        m_header->write_seq.store(++m_seq, std::memory_order_release);
+    }
+
+    bool is_open() const { return m_header != nullptr; }
+    bool huge_pages() const { return m_hugePages; }
+    size_t capacity() const { return m_mask + 1; }
+    size_t mapped_bytes() const { return m_size; }
+    uint64_t published() const { return m_seq; }
+    const std::string& path() const { return m_path; }
+
+private:
+    bool map(const std::string& path, size_t size, bool huge);
+
+private:
+    shmbus::BusHeader* m_header;
+    shmbus::Slot* m_slots;
+    uint64_t m_mask;
+    uint64_t m_seq;     // 下一条的序号，仅写线程访问
+    size_t m_size;
+    bool m_hugePages;
+    std::string m_path; // 实际的文件路径 (hugetlbfs 或 /dev/shm 下)
+    std::string m_shmName;
+};
+
+// 读端 (客户端库)：每个读线程一个实例，挂载后用 read() 拷贝或 poll() 零拷贝读取
+//
+//   ShmBusReader bus;
+//   bus.open("hf_md");
+//   Tick tick;
+//   while (running) { if (bus.read(tick)) on_tick(tick); }
+class ShmBusReader {
+public:
+    ShmBusReader();
+    ~ShmBusReader();
+
+    ShmBusReader(const ShmBusReader&) = delete;
+    ShmBusReader& operator=(const ShmBusReader&) = delete;
+
+    // 挂载总线并把游标放到最新位置 (只读新数据)，总线不存在或格式不符返回 false
+    bool open(const std::string& name, const std::string& hugepage_dir = "/dev/hugepages");
+    void close();
+
+    // 游标移到最新位置 / 仍在环内的最老位置
+    void seek_latest();
+    void seek_oldest();
+
+    // 拷贝读取下一条，没有新数据返回 false；被套圈时计数并跳到最新位置
+    inline bool read(Tick& out) {
+        for (;;) {
+            const shmbus::Slot& slot = m_slots[m_cursor & m_mask];
+            const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+            const uint64_t expected = 2 * m_cursor + 2;
+            if (seq < expected) return false;
+            if (__builtin_expect(seq == expected, 1)) {
+                memcpy(&out, &slot.tick, sizeof(Tick));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (__builtin_expect(slot.seq.load(std::memory_order_relaxed) == expected, 1)) {
+                    ++m_cursor;
+                    ++m_received;
+                    return true;
+                }
+            }
+            on_lapped();
+        }
+    }
+
+    // 零拷贝读取：对最多 max 条新数据依次调用 fn(const Tick&)，tick 直接指向共享内存，返回处理的条数
+    // fn 返回后再校验槽位序号；fn 执行期间被写端覆盖时 (读端落后整整一圈) 它看到的数据可能不一致，
+    // 此时计入 torn() 并跳到最新位置。不能容忍这种情况的读端用 read()
+    template<typename Fn>
+    size_t poll(Fn fn, size_t max = 64) {
+        size_t n = 0;
+        while (n < max) {
+            const shmbus::Slot& slot = m_slots[m_cursor & m_mask];
+            const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+            const uint64_t expected = 2 * m_cursor + 2;
+            if (seq < expected) break;
+            if (__builtin_expect(seq != expected, 0)) {
+                on_lapped();
+                continue;
+            }
+            fn(slot.tick);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (__builtin_expect(slot.seq.load(std::memory_order_relaxed) != expected, 0)) {
+                ++m_torn;
+                on_lapped();
+                continue;
+            }
+            ++m_cursor;
+            ++m_received;
+            ++n;
+        }
+        return n;
+    }
+
+    // 写端已退出 (正常关闭、进程已不存在或已重建总线) 且本读端已读完剩余数据
+    bool writer_closed() const;
+
+    bool is_open() const { return m_header != nullptr; }
+    uint64_t cursor() const { return m_cursor; }
+    uint64_t received() const { return m_received; }
+    uint64_t lapped() const { return m_lapped; }   // 被套圈的次数
+    uint64_t missed() const { return m_missed; }   // 因套圈跳过的条数
+    uint64_t torn() const { return m_torn; }       // poll() 回调期间被覆盖的次数
+    // 写端已发布但本读端未读的条数
+    uint64_t backlog() const { return m_header->write_seq.load(std::memory_order_acquire) - m_cursor; }
+
+    size_t capacity() const { return m_mask + 1; }
+    bool huge_pages() const { return m_header->huge_pages != 0; }
+    uint32_t writer_pid() const { return m_header->writer_pid; }
+    size_t instrument_count() const { return m_header->instrument_count; }
+    const char* instrument_id(size_t i) const { return m_instruments[i].instrument_id; }
+    double price_tick(size_t i) const { return m_instruments[i].price_tick; }
+    // 按合约代码查找 id，未找到返回 0xFFFF
+    uint16_t find_instrument(const char* instrument_id) const;
+    const std::string& path() const { return m_path; }
+
+private:
+    void on_lapped();
+
+private:
+    const shmbus::BusHeader* m_header;
+    const shmbus::Slot* m_slots;
+    const journal::InstrumentEntry* m_instruments;
+    uint64_t m_mask;
+    uint64_t m_cursor;
+    uint64_t m_received;
+    uint64_t m_lapped;
+    uint64_t m_missed;
+    uint64_t m_torn;
+    size_t m_size;
+    std::string m_path;
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifndef CACHELINE_SIZE
+#define CACHELINE_SIZE 64
+#endif
+
+// 按合约的最新快照表 (单写多读，seqlock 保护)
+// - 每个合约一个缓存行对齐的槽位，写端只保留最新一笔，内存占用与行情突发程度无关
+// - 写端每次更新后置位脏位图，读端 scan() 只访问上次扫描以来有变化的合约
+// - 与 SPSCQueue 互补：队列保证逐笔不丢，快照表保证读端工作量有界
+template<typename T>
+class SnapshotTable {
+public:
+    struct alignas(CACHELINE_SIZE) Slot {
+        std::atomic<uint32_t> seq; // 奇数表示正在写
+        T value;
+    };
+
+    explicit SnapshotTable(size_t capacity)
+        : capacity_(capacity), words_((capacity + 63) / 64) {
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, CACHELINE_SIZE, sizeof(Slot) * (capacity_ ? capacity_ : 1)) != 0) {
+            throw std::bad_alloc();
+        }
+        slots_ = static_cast<Slot*>(ptr);
+        memset(static_cast<void*>(slots_), 0, sizeof(Slot) * capacity_);
+
+        dirty_ = new std::atomic<uint64_t>[words_ ? words_ : 1];
+        for (size_t i = 0; i < words_; ++i) {
+            dirty_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ~SnapshotTable() {
+        free(slots_);
+        delete[] dirty_;
+    }
+
+    SnapshotTable(const SnapshotTable&) = delete;
+    SnapshotTable& operator=(const SnapshotTable&) = delete;
+
+    size_t capacity() const { return capacity_; }
+
+    // === 写端 (单线程) ===
+    // begin_write() 返回槽位供原地写入，写完调用 end_write() 发布并置脏位
+    inline T* begin_write(size_t id) __attribute__((always_inline)) {
+        Slot& slot = slots_[id];
+        slot.seq.store(slot.seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return &slot.value;
+    }
+
+    inline void end_write(size_t id) __attribute__((always_inline)) {
+        Slot& slot = slots_[id];
+        slot.seq.store(slot.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        // 必须是原子 RMW：先读后写会与读端的 exchange 竞争而丢失脏标记
+        dirty_[id / 64].fetch_or(1ULL << (id % 64), std::memory_order_release);
+    }
+
+    // === 读端 ===
+    // 单次尝试，不等待：写端正在写或读到一半被改写时返回 false
+    inline bool try_read(size_t id, T& out) const {
+        const Slot& slot = slots_[id];
+        const uint32_t begin = slot.seq.load(std::memory_order_acquire);
+        if (begin & 1) return false;
+        memcpy(static_cast<void*>(&out), &slot.value, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.seq.load(std::memory_order_relaxed) == begin;
+    }
+
+    // 重试直到读到一致的快照；从未写过的槽位返回 false
+    inline bool read(size_t id, T& out) const {
+        for (;;) {
+            const uint32_t seq = slots_[id].seq.load(std::memory_order_relaxed);
+            if (seq == 0) return false;
+            if (try_read(id, out)) return true;
+        }
+    }
+
+    // 扫描上次调用以来更新过的合约，对每个合约的最新快照调用 fn(id, const T&)
+    // out 是调用方提供的暂存区，避免每次扫描在栈上构造 T。返回访问的合约数
+    template<typename Fn>
+    size_t scan(T& out, Fn fn) {
+        size_t visited = 0;
+        for (size_t w = 0; w < words_; ++w) {
+            // 先普通读，干净的字不做 RMW
+            if (dirty_[w].load(std::memory_order_relaxed) == 0) continue;
+            uint64_t bits = dirty_[w].exchange(0, std::memory_order_acquire);
+            while (bits) {
+                const size_t id = w * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                if (read(id, out)) {
+                    fn(id, static_cast<const T&>(out));
+                    ++visited;
+                }
+            }
+        }
+        return visited;
+    }
+
+private:
+    Slot* slots_;
+    size_t capacity_;
+    size_t words_;
+    std::atomic<uint64_t>* dirty_;
+};
@@ -0,0 +1,269 @@
+#pragma once
+
+#include "ThostFtdcUserApiStruct.h"
+#include <cfloat>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#ifndef CACHELINE_SIZE
+#define CACHELINE_SIZE 64
+#endif
+
+// 归一化 tick：在 CTP 回调里从 CThostFtdcDepthMarketDataField (~500 字节) 转换而来，
+// 固定 128 字节 (两个缓存行)，队列每个槽位的数据量约为原来的 1/4
+// - 合约用 InstrumentRegistry 分配的稠密 id 表示
+// - 价格统一为 PriceTick 的整数倍；五档价格用 int32 (单合约价格/最小变动价位远小于 2^31)，
+//   否则 5 档 x 2 边的 int64 放不进 128 字节
+// - 交易所时间、接收时间均为 epoch 纳秒时间戳，可以直接相减
+// - 空档位 (CTP 填 DBL_MAX) 归一化为价格 0、数量 0
+struct alignas(CACHELINE_SIZE) Tick {
+    int64_t  exchange_ts_ns;  // 交易所时间 (UTC epoch 纳秒)
+    int64_t  receive_ns;      // 接收时间 (UTC epoch 纳秒，TscClock 换算)
+    int64_t  last_px;         // 最新价 (tick 数)
+    double   turnover;        // 累计成交额
+    uint16_t instrument_id;   // 稠密合约 id
+    uint8_t  source;          // 行情来源 (前置编号)
+    uint8_t  flags;
+    int32_t  volume;          // 累计成交量
+    int32_t  open_interest;   // 持仓量
+    uint32_t trading_day;     // 交易日 YYYYMMDD
+    int32_t  bid_px[5];       // 买一~买五 (tick 数)
+    int32_t  ask_px[5];       // 卖一~卖五 (tick 数)
+    int32_t  bid_vol[5];
+    int32_t  ask_vol[5];
+};
+
+static_assert(sizeof(Tick) == 2 * CACHELINE_SIZE, "Tick must occupy exactly two cache lines");
+
+namespace tick_detail {
+
+// CTP 用 DBL_MAX 表示无效价格
+inline bool valid_price(double px) {
+    return px > -1e15 && px < 1e15;
+}
+
+inline int64_t to_ticks(double px, double inv_tick) {
+    if (!valid_price(px)) return 0;
+    const double t = px * inv_tick;
+    return (int64_t)(t >= 0 ? t + 0.5 : t - 0.5);
+}
+
+// SWAR 解析：一次 8 字节加载，在 64 位寄存器里按字节并行减 '0'、两两合并，无循环无分支
+// 输入必须是 CTP 定长字段的合法格式 (不做校验)；小端序，第一个字符在最低字节
+inline uint64_t load8(const char* s) {
+    uint64_t v;
+    memcpy(&v, s, sizeof(v));
+    return v;
+}
+
+// 每字节 b[i] (0~10) -> 字节 i 为 b[i] * 10 + b[i + 1]，各字节不超过 110，不会进位
+inline uint64_t swar_pairs(uint64_t v) {
+    return v * 10 + (v >> 8);
+}
+
+// "YYYYMMDD" -> 年、月、日
+inline void parse_date(const char* s, uint32_t& y, uint32_t& m, uint32_t& d) {
+    const uint64_t v = swar_pairs(load8(s) - 0x3030303030303030ULL);
+    y = (uint32_t)(v & 0xFF) * 100 + (uint32_t)(v >> 16 & 0xFF);
+    m = (uint32_t)(v >> 32 & 0xFF);
+    d = (uint32_t)(v >> 48 & 0xFF);
+}
+
+// "YYYYMMDD" -> 整数 YYYYMMDD
+inline uint32_t parse_yyyymmdd(const char* s) {
+    uint64_t v = swar_pairs(load8(s) - 0x3030303030303030ULL) & 0x00FF00FF00FF00FFULL;
+    v = (v * 100 + (v >> 16)) & 0x0000FFFF0000FFFFULL;
+    return (uint32_t)(v & 0xFFFF) * 10000 + (uint32_t)(v >> 32);
+}
+
+// "HH:MM:SS" -> 日内秒；冒号减 '0' 后为 10，只落在不取的字节上
+inline uint32_t parse_hhmmss(const char* s) {
+    const uint64_t v = swar_pairs(load8(s) - 0x3030303030303030ULL);
+    return (uint32_t)(v & 0xFF) * 3600 + (uint32_t)(v >> 24 & 0xFF) * 60 + (uint32_t)(v >> 48 & 0xFF);
+}
+
+// 上面几个函数的逆操作：v 的低 n 位十进制数字写入 out[0..n)，高位补 0，不写结束符
+inline void write_digits(char* out, uint32_t v, int n) {
+    for (int i = n - 1; i >= 0; --i) {
+        out[i] = (char)('0' + v % 10);
+        v /= 10;
+    }
+}
+
+// 公历日期 -> 1970-01-01 以来的天数 (Howard Hinnant days_from_civil)
+inline int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+// 同上，只对 1901-03-01 ~ 2100-02-28 有效：这段时间闰年就是能被 4 整除的年份，省掉按 400 年分纪元的
+// 有符号除法。日期从 3 月起算，2 月 (可能有 29 日) 排在年末，(153 * mp + 2) / 5 为 3 月 1 日起的累计天数
+inline int64_t days_from_civil_2100(uint32_t y, uint32_t m, uint32_t d) {
+    const uint32_t yy = y - (m <= 2);
+    const uint32_t mp = m > 2 ? m - 3 : m + 9;
+    return (int64_t)(365 * yy + yy / 4 + (153 * mp + 2) / 5 + d) - 719484;
+}
+
+inline void civil_from_days(int64_t z, int& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = (unsigned)(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = (int)(yoe + era * 400 + (m <= 2));
+}
+
+// 北京时间 (UTC+8)
+const int64_t CST_OFFSET_NS = 8LL * 3600 * 1000000000LL;
+const int64_t DAY_NS = 86400LL * 1000000000LL;
+
+} // namespace tick_detail
+
+// "YYYYMMDD" + "HH:MM:SS" + 毫秒 -> UTC epoch 纳秒
+inline int64_t exchange_time_ns(const char* day, const char* time, int millisec) {
+    using namespace tick_detail;
+    uint32_t y, m, d;
+    parse_date(day, y, m, d);
+    const int64_t secs = days_from_civil_2100(y, m, d) * 86400 + parse_hhmmss(time);
+    return secs * 1000000000LL + millisec * 1000000LL - CST_OFFSET_NS;
+}
+
+// 按交易所的日期语义求 tick 的交易所时间。夜盘 (18:00 之后、06:00 之前) 各交易所的日期填法不同：
+// - 上期所/能源中心：ActionDay 为自然日，TradingDay 为下一交易日 —— 两者不同，直接用 ActionDay
+// - 大商所：ActionDay 与 TradingDay 都填下一交易日 (周五夜盘填下周一)
+// - 郑商所：ActionDay 与 TradingDay 都填自然日
+// 后两种字段上无法区分，也不能只靠交易日历推算，这时以本地接收时间为准：
+// 按 ActionDay 算出的时间对齐到离 receive_ns 最近的同一时刻 (相差整数天)，行情延迟远小于 12 小时。
+// receive_ns <= 0 (没有接收时间) 时退回 ActionDay；日盘直接用 ActionDay (为空时用 TradingDay)
+inline int64_t resolve_exchange_time_ns(const char* trading_day, const char* action_day, const char* time,
+                                        int millisec, int64_t receive_ns) {
+    using namespace tick_detail;
+    const char* day = action_day[0] ? action_day : trading_day;
+    const int64_t ts = exchange_time_ns(day, time, millisec);
+    const uint32_t tod = parse_hhmmss(time);
+    const bool night = tod >= 18 * 3600 || tod < 6 * 3600;
+    if (!night || receive_ns <= 0 || load8(day) != load8(trading_day)) return ts;
+    const int64_t q = receive_ns - ts + DAY_NS / 2;
+    const int64_t days = q / DAY_NS - (q % DAY_NS < 0);
+    return ts + days * DAY_NS;
+}
+
+// 交易所时间 -> 所属交易日 (1970-01-01 以来的天数)：18:00 之后的夜盘算下一天，落在周六、周日的顺延到周一
+// (周五夜盘及其零点后的部分属于下周一)。不查节假日日历：节假日前一晚没有夜盘。
+// 郑商所夜盘的 TradingDay 填自然日，按交易日分段 (K 线、日内 VWAP) 时用这个而不是 Tick::trading_day
+inline int64_t session_day_of(int64_t exchange_ts_ns) {
+    using namespace tick_detail;
+    const int64_t q = exchange_ts_ns + CST_OFFSET_NS + 6 * 3600 * 1000000000LL;
+    const int64_t days = q / DAY_NS - (q % DAY_NS < 0);
+    const int64_t weekday = (days % 7 + 11) % 7; // 0 为周日
+    return days + (weekday == 6 ? 2 : weekday == 0 ? 1 : 0);
+}
+
+// session_day_of() 在 [session_window_begin_ns(ts), + DAY_NS) 内不变 (北京时间 18:00 起的 24 小时)，
+// 逐笔求交易日时可以缓存这个窗口，越过窗口才重新计算
+inline int64_t session_window_begin_ns(int64_t exchange_ts_ns) {
+    using namespace tick_detail;
+    const int64_t shift = CST_OFFSET_NS + 6 * 3600 * 1000000000LL;
+    const int64_t q = exchange_ts_ns + shift;
+    return (q / DAY_NS - (q % DAY_NS < 0)) * DAY_NS - shift;
+}
+
+// 1970-01-01 以来的天数 -> 整数 YYYYMMDD
+inline uint32_t yyyymmdd_of(int64_t days) {
+    int y;
+    unsigned m, d;
+    tick_detail::civil_from_days(days, y, m, d);
+    return (uint32_t)y * 10000 + m * 100 + d;
+}
+
+// CTP 原始行情 -> 归一化 tick
+// 交易所时间见 resolve_exchange_time_ns
+inline void normalize_tick(const CThostFtdcDepthMarketDataField& raw, uint16_t instrument_id,
+                           double inv_price_tick, int64_t receive_ns, Tick& out) {
+    using tick_detail::to_ticks;
+
+    out.exchange_ts_ns = resolve_exchange_time_ns(raw.TradingDay, raw.ActionDay, raw.UpdateTime,
+                                                  raw.UpdateMillisec, receive_ns);
+    out.receive_ns = receive_ns;
+    out.last_px = to_ticks(raw.LastPrice, inv_price_tick);
+    out.turnover = raw.Turnover;
+    out.instrument_id = instrument_id;
+    out.source = 0;
+    out.flags = 0;
+    out.volume = raw.Volume;
+    out.open_interest = (int32_t)raw.OpenInterest;
+    out.trading_day = tick_detail::parse_yyyymmdd(raw.TradingDay);
+
+    out.bid_px[0] = (int32_t)to_ticks(raw.BidPrice1, inv_price_tick);
+    out.bid_px[1] = (int32_t)to_ticks(raw.BidPrice2, inv_price_tick);
+    out.bid_px[2] = (int32_t)to_ticks(raw.BidPrice3, inv_price_tick);
+    out.bid_px[3] = (int32_t)to_ticks(raw.BidPrice4, inv_price_tick);
+    out.bid_px[4] = (int32_t)to_ticks(raw.BidPrice5, inv_price_tick);
+    out.ask_px[0] = (int32_t)to_ticks(raw.AskPrice1, inv_price_tick);
+    out.ask_px[1] = (int32_t)to_ticks(raw.AskPrice2, inv_price_tick);
+    out.ask_px[2] = (int32_t)to_ticks(raw.AskPrice3, inv_price_tick);
+    out.ask_px[3] = (int32_t)to_ticks(raw.AskPrice4, inv_price_tick);
+    out.ask_px[4] = (int32_t)to_ticks(raw.AskPrice5, inv_price_tick);
+
+    out.bid_vol[0] = raw.BidVolume1;
+    out.bid_vol[1] = raw.BidVolume2;
+    out.bid_vol[2] = raw.BidVolume3;
+    out.bid_vol[3] = raw.BidVolume4;
+    out.bid_vol[4] = raw.BidVolume5;
+    out.ask_vol[0] = raw.AskVolume1;
+    out.ask_vol[1] = raw.AskVolume2;
+    out.ask_vol[2] = raw.AskVolume3;
+    out.ask_vol[3] = raw.AskVolume4;
+    out.ask_vol[4] = raw.AskVolume5;
+}
+
+// 归一化 tick -> CTP 原始行情 (只还原 Tick 中保留的字段，其余清零)
+// 用于回放/模拟前置把 tick 重新喂给 CTPMdSpi，以及与原始结构的往返校验
+inline void denormalize_tick(const Tick& tick, const char* instrument_id, double price_tick,
+                             CThostFtdcDepthMarketDataField& out) {
+    using namespace tick_detail;
+    memset(&out, 0, sizeof(out));
+
+    const int64_t local_ns = tick.exchange_ts_ns + CST_OFFSET_NS;
+    int64_t days = local_ns / DAY_NS;
+    if (local_ns < 0 && local_ns % DAY_NS != 0) --days;
+    const int64_t in_day_ns = local_ns - days * DAY_NS;
+    const int64_t secs = in_day_ns / 1000000000LL;
+    int y; unsigned m, d;
+    civil_from_days(days, y, m, d);
+
+    // 各字段已清零，写满 8 个字符后仍以 '\0' 结尾
+    write_digits(out.ActionDay, (uint32_t)y * 10000 + m * 100 + d, 8);
+    write_digits(out.TradingDay, tick.trading_day, 8);
+    write_digits(out.UpdateTime, (uint32_t)(secs / 3600), 2);
+    write_digits(out.UpdateTime + 3, (uint32_t)(secs / 60 % 60), 2);
+    write_digits(out.UpdateTime + 6, (uint32_t)(secs % 60), 2);
+    out.UpdateTime[2] = out.UpdateTime[5] = ':';
+    out.UpdateMillisec = (int)(in_day_ns / 1000000 % 1000);
+    strncpy(out.InstrumentID, instrument_id, sizeof(out.InstrumentID) - 1);
+
+    out.LastPrice = tick.last_px * price_tick;
+    out.Turnover = tick.turnover;
+    out.Volume = tick.volume;
+    out.OpenInterest = tick.open_interest;
+
+    double* bid_px[5] = {&out.BidPrice1, &out.BidPrice2, &out.BidPrice3, &out.BidPrice4, &out.BidPrice5};
+    double* ask_px[5] = {&out.AskPrice1, &out.AskPrice2, &out.AskPrice3, &out.AskPrice4, &out.AskPrice5};
+    int* bid_vol[5] = {&out.BidVolume1, &out.BidVolume2, &out.BidVolume3, &out.BidVolume4, &out.BidVolume5};
+    int* ask_vol[5] = {&out.AskVolume1, &out.AskVolume2, &out.AskVolume3, &out.AskVolume4, &out.AskVolume5};
+    for (int i = 0; i < 5; ++i) {
+        // 空档位还原为 CTP 的 DBL_MAX
+        *bid_px[i] = (tick.bid_px[i] || tick.bid_vol[i]) ? tick.bid_px[i] * price_tick : DBL_MAX;
+        *ask_px[i] = (tick.ask_px[i] || tick.ask_vol[i]) ? tick.ask_px[i] * price_tick : DBL_MAX;
+        *bid_vol[i] = tick.bid_vol[i];
+        *ask_vol[i] = tick.ask_vol[i];
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "BarAggregator.h"
+#include "OrderBook.h"
+#include "Tick.h"
+#include <cstddef>
+
+// 策略回调：StrategyEngine<Handler> 在引擎线程内调用，Handler 是任意提供以下成员函数的类型
+//   void onTick(const Tick& tick);  // 每个 tick 一次，tick 指向队列槽位，只在回调内有效
+//   void onBookDelta(const BookDelta* deltas, size_t count);
+//                                   // 引擎挂了 OrderBookTable 时，五档有变化的 tick 在 onTick 之前调用一次
+//   void onBar(const Bar& bar);     // 引擎挂了 BarAggregator 时，每根收盘的 K 线一次 (在触发收盘的 tick 之前)
+//   void onBatchEnd();              // 一批 tick 处理完、槽位归还之前 (适合批量下单/刷新信号)
+//   void onSnapshot(uint16_t id, const Tick& tick);
+//                                   // 引擎挂了 SnapshotTable 时，队列空闲期间扫描到的有变化合约的最新快照，
+//                                   // 每个合约一次 (期间的中间 tick 已合并)，tick 只在回调内有效
+//   void onIdle();                  // 队列为空的每一轮轮询，必须很短
+// 调用点在编译期确定，可以完全内联，热循环里没有虚函数调用
+
+// 不做任何事的 Handler，MarketDataEngine 自身使用，回调全部优化掉
+struct NullTickHandler {
+    inline void onTick(const Tick&) {}
+    inline void onBookDelta(const BookDelta*, size_t) {}
+    inline void onBar(const Bar&) {}
+    inline void onBatchEnd() {}
+    inline void onSnapshot(uint16_t, const Tick&) {}
+    inline void onIdle() {}
+};
+
+// 虚函数接口，用于不在关键路径上的策略 (监控、调试、运行时选择的插件)
+class TickHandler {
+public:
+    virtual ~TickHandler() {}
+    virtual void onTick(const Tick& tick) = 0;
+    virtual void onBookDelta(const BookDelta*, size_t) {}
+    virtual void onBar(const Bar&) {}
+    virtual void onBatchEnd() {}
+    virtual void onSnapshot(uint16_t, const Tick&) {}
+    virtual void onIdle() {}
+};
+
+// 类型擦除适配器：StrategyEngine<VirtualTickHandler> 每次回调经一次虚函数分发
+// 不持有 pHandler，调用方保证其生命周期长于引擎
+class VirtualTickHandler {
+public:
+    explicit VirtualTickHandler(TickHandler* pHandler) : m_pHandler(pHandler) {}
+
+    inline void onTick(const Tick& tick) { m_pHandler->onTick(tick); }
+    inline void onBookDelta(const BookDelta* deltas, size_t count) { m_pHandler->onBookDelta(deltas, count); }
+    inline void onBar(const Bar& bar) { m_pHandler->onBar(bar); }
+    inline void onBatchEnd() { m_pHandler->onBatchEnd(); }
+    inline void onSnapshot(uint16_t id, const Tick& tick) { m_pHandler->onSnapshot(id, tick); }
+    inline void onIdle() { m_pHandler->onIdle(); }
+
+private:
+    TickHandler* m_pHandler;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Tick.h"
+#include <cstdint>
+#include <cstring>
+
+// 行情日志 (tick journal) 的文件格式，记录端 TickRecorder 与读取端共用
+//
+// 文件布局 (小端)：
+//   [FileHeader][InstrumentEntry x instrument_count][补零到 header_size]
+//   [RecordHeader][payload] [RecordHeader][payload] ...
+// - header_size 按 JOURNAL_BLOCK_SIZE 对齐，数据区可以直接用 O_DIRECT 写入
+// - 每条记录带长度前缀，读取端可以跳过不认识的记录类型
+// - 长度为 0 的记录头表示数据结束 (O_DIRECT 按块写入时块尾补零；进程异常退出时文件尾部同样是零)
+namespace journal {
+
+const char MAGIC[8] = {'H', 'F', 'T', 'J', 'R', 'N', 'L', '\0'};
+const uint32_t VERSION = 1;
+const size_t JOURNAL_BLOCK_SIZE = 4096;
+
+enum RecordType : uint16_t {
+    RECORD_TICK = 1 // payload 为 Tick
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;       // 文件头 + 合约表，按 JOURNAL_BLOCK_SIZE 对齐，即第一条记录的偏移
+    uint32_t trading_day;       // YYYYMMDD
+    uint32_t instrument_count;  // 合约表条数，下标即 Tick::instrument_id
+    uint32_t tick_size;         // sizeof(Tick)，结构变化时拒绝读取
+    uint32_t reserved0;
+    // 记录时的 TSC 标定参数 (TscClock)，Tick 中的时间已是纳秒，这里留作事后核对
+    double tsc_ghz;
+    uint64_t tsc_base;
+    int64_t tsc_base_wall_ns;
+    int64_t created_ns;         // 文件创建时间 (UTC epoch 纳秒)
+    char reserved[64];
+};
+
+struct InstrumentEntry {
+    char instrument_id[32];
+    double price_tick;
+    char reserved[8];
+};
+
+struct RecordHeader {
+    uint32_t length;   // payload 字节数，0 表示数据结束
+    uint16_t type;     // RecordType
+    uint16_t reserved;
+};
+
+const size_t TICK_RECORD_SIZE = sizeof(RecordHeader) + sizeof(Tick);
+
+static_assert(sizeof(FileHeader) == 128, "FileHeader layout changed");
+static_assert(sizeof(InstrumentEntry) == 48, "InstrumentEntry layout changed");
+static_assert(sizeof(RecordHeader) == 8, "RecordHeader layout changed");
+
+inline size_t header_size_for(size_t instrument_count) {
+    const size_t raw = sizeof(FileHeader) + instrument_count * sizeof(InstrumentEntry);
+    return (raw + JOURNAL_BLOCK_SIZE - 1) & ~(JOURNAL_BLOCK_SIZE - 1);
+}
+
+// === 稀疏索引 (<journal>.idx) ===
+//
+// 文件布局：[IndexHeader][IndexEntry x entry_count]，条目按 (instrument_id, bucket_start_ns) 排序
+// - 每个 (合约, 交易所时间桶) 一条，记录该合约落在此桶内的第一条和最后一条记录的偏移
+// - 查询时二分定位起始条目，只扫描各条目 [first_offset, last_offset] 内的记录；
+//   合约在某个桶内没有行情就没有条目，不活跃合约的查询几乎不读数据
+// - journal_size 与 journal 实际长度不一致 (进程异常退出、索引未写完) 时视为过期，需要重建
+const char INDEX_MAGIC[8] = {'H', 'F', 'T', 'J', 'I', 'D', 'X', '\0'};
+const uint32_t INDEX_VERSION = 1;
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t instrument_count;
+    int64_t bucket_ns;          // 时间桶宽度
+    uint64_t entry_count;
+    uint64_t journal_size;      // 建索引时 journal 的长度
+    char reserved[24];
+};
+
+struct IndexEntry {
+    uint16_t instrument_id;
+    uint16_t reserved;
+    uint32_t count;             // 桶内的 tick 数
+    int64_t bucket_start_ns;    // 桶起点 (UTC epoch 纳秒，bucket_ns 的整数倍)
+    uint64_t first_offset;      // 桶内第一条记录 (RecordHeader) 的文件偏移
+    uint64_t last_offset;       // 桶内最后一条记录的文件偏移
+};
+
+static_assert(sizeof(IndexHeader) == 64, "IndexHeader layout changed");
+static_assert(sizeof(IndexEntry) == 32, "IndexEntry layout changed");
+
+// 向下取整到桶起点 (时间戳为负时同样向下取整)
+inline int64_t bucket_start(int64_t ts_ns, int64_t bucket_ns) {
+    const int64_t q = ts_ns / bucket_ns;
+    return (ts_ns % bucket_ns < 0 ? q - 1 : q) * bucket_ns;
+}
+
+} // namespace journal
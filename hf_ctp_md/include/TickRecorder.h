@@ -0,0 +1,99 @@
+#pragma once
+
+#include "SPSCQueue.h"
+#include "Tick.h"
+#include "TickJournal.h"
+#include "InstrumentRegistry.h"
+#include "JournalIndex.h"
+#include <atomic>
+#include <string>
+#include <thread>
+
+// 行情记录：引擎线程把 tick 推入专用的 SPSC 环，独立的写线程批量写入 journal 文件
+// - append() 只做一次 128 字节拷贝 + 发布，环满时丢弃并计数，从不阻塞引擎线程
+// - 写线程把记录拼进按 4096 对齐的大缓冲区，整块用 O_DIRECT pwrite 写出，
+//   不经过页缓存，避免大量脏页回写时拖慢整机；文件系统不支持 O_DIRECT (如 tmpfs) 时退回普通写
+// - 缓冲区未满时按 flush_interval_ms 周期刷盘，最后一个不完整的块下次会被覆盖重写
+// - 写线程同时维护 (合约, 时间桶) 稀疏索引，stop() 时写出 <journal>.idx (见 JournalIndex.h)
+// - 写盘失败 (磁盘满、IO 错误) 后停止记录：文件截断到最后一次成功写出的块，不写索引，
+//   写线程继续取空记录环，之后的 tick 全部计入 dropped，引擎线程不受影响
+//
+// 用法：构造 -> (引擎 append 可以提前开始，数据先留在环里) -> open() -> start() -> ... -> stop()
+// 环在构造时分配 (未触碰的页面不占物理内存)，写缓冲在 open() 时分配
+class TickRecorder {
+public:
+    static const size_t DEFAULT_RING_SIZE = 65536;            // 8 MB，可吸收约 65ms@1M/s 的磁盘停顿
+    static const size_t DEFAULT_BUFFER_SIZE = 4 << 20;        // 写缓冲 4 MB
+    static const unsigned DEFAULT_FLUSH_INTERVAL_MS = 1000;
+
+    explicit TickRecorder(size_t ring_size = DEFAULT_RING_SIZE, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+    ~TickRecorder();
+
+    TickRecorder(const TickRecorder&) = delete;
+    TickRecorder& operator=(const TickRecorder&) = delete;
+
+    // 创建 journal 文件并写入文件头 (交易日、合约表、TSC 标定参数)，失败返回 false
+    bool open(const std::string& path, uint32_t trading_day, const InstrumentRegistry& registry);
+
+    void set_flush_interval_ms(unsigned interval_ms);
+
+    // 索引时间桶宽度，0 表示不建索引；须在 start() 之前调用
+    void set_index_bucket_ns(int64_t bucket_ns);
+
+    // 启动写线程
+    void start();
+    // 写完环中剩余数据，截断到实际长度并关闭文件，然后写出索引
+    void stop();
+
+    // === 引擎线程调用 ===
+    inline bool append(const Tick& tick) __attribute__((always_inline)) {
+        Tick* slot = m_ring.claim();
+        if (__builtin_expect(!slot, 0)) {
+            // 写盘失败后写线程也会累加，必须用原子加 (只在丢弃时发生，不在常规路径上)
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        *slot = tick;
+        m_ring.commit();
+        return true;
+    }
+
+    // 预先触碰记录环，必须在 start() 之前、引擎开始 append 之前调用
+    void prefault() { m_ring.prefault(); }
+    size_t ring_bytes() const { return m_ring.capacity() * sizeof(Tick); }
+
+    uint64_t written() const { return m_written.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    bool failed() const { return m_failed.load(std::memory_order_relaxed); }
+    bool direct_io() const { return m_directIO; }
+    const std::string& path() const { return m_path; }
+
+private:
+    void run();
+    bool flush();
+    void fail();
+
+private:
+    SPSCQueue<Tick> m_ring;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::atomic<uint64_t> m_written; // 写线程单写
+    std::atomic<uint64_t> m_dropped; // 引擎线程 (环满) 和写线程 (写盘失败后) 累加
+    std::atomic<bool> m_failed;      // 写盘失败，写线程单写
+
+    std::string m_path;
+    int m_fd;
+    bool m_directIO;
+    unsigned m_flushIntervalMs;
+    size_t m_instrumentCount;
+
+    // 索引只在写线程上更新，stop() 在线程结束后写出
+    bool m_indexEnabled;
+    JournalIndexBuilder m_index;
+
+    // 写缓冲：m_buffer[0] 对应文件偏移 m_fileOffset (块对齐)，m_used 之后的字节保持为 0
+    char* m_buffer;
+    size_t m_bufferSize;
+    size_t m_used;
+    uint64_t m_fileOffset;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+// TSC 时钟：行情/交易延迟统一使用的时间源
+// - 热路径只读 TSC (rdtsc ~20 周期，clock_gettime 的 vDSO 调用约 20ns)
+// - 启动时对照 CLOCK_MONOTONIC_RAW 标定频率，并记录一对 (TSC, CLOCK_REALTIME) 作为墙钟锚点
+// - 周期 -> 纳秒用 32.32 定点乘法，不做浮点除法
+// 要求 CPU 支持 invariant TSC (频率不随 P/C 状态变化、各核同步)，否则换算结果只能作参考
+//
+// 用法：main() 开始时调用一次 calibrate()，之后各线程只读
+class TscClock {
+public:
+    // 不带序列化的读取，可能被乱序执行提前或推后几十个周期
+    static inline uint64_t rdtsc() __attribute__((always_inline)) {
+        unsigned int lo, hi;
+        __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+        return ((uint64_t)hi << 32) | lo;
+    }
+
+    // rdtscp 等待之前的指令完成，后接 lfence 阻止之后的指令提前执行
+    // 测量很短的代码段时使用，比 rdtsc 多约 20~40 周期
+    static inline uint64_t rdtscp() __attribute__((always_inline)) {
+        unsigned int lo, hi, aux;
+        __asm__ __volatile__ ("rdtscp\n\tlfence" : "=a" (lo), "=d" (hi), "=c" (aux) : : "memory");
+        return ((uint64_t)hi << 32) | lo;
+    }
+
+    // 按 set_serialized() 的设置选择读取方式
+    static inline uint64_t now() __attribute__((always_inline)) {
+        return s_serialized ? rdtscp() : rdtsc();
+    }
+
+    // 周期数 -> 纳秒 (时间间隔)
+    static inline int64_t to_ns(int64_t cycles) __attribute__((always_inline)) {
+        return (int64_t)(((__int128)cycles * (__int128)s_mult) >> MULT_SHIFT);
+    }
+
+    // TSC 读数 -> UTC epoch 纳秒
+    static inline int64_t to_wall_ns(uint64_t tsc) __attribute__((always_inline)) {
+        return s_base_wall_ns + to_ns((int64_t)(tsc - s_base_tsc));
+    }
+
+    // 当前 UTC epoch 纳秒 (基于 TSC，同一台机器上各核单调一致)
+    static inline int64_t wall_ns() __attribute__((always_inline)) {
+        return to_wall_ns(now());
+    }
+
+    // CPUID.80000007H:EDX[8]
+    static bool invariant_tsc();
+
+    // 忙等 window_ns 标定频率并设置墙钟锚点，返回是否成功
+    // 未标定时按 1 周期 = 1 纳秒换算
+    static bool calibrate(uint64_t window_ns = 100000000ULL);
+
+    static void set_serialized(bool enable) { s_serialized = enable; }
+    static bool serialized() { return s_serialized; }
+
+    static bool calibrated() { return s_calibrated; }
+    // 标定得到的 TSC 频率 (GHz，即周期/纳秒)
+    static double ghz() { return s_ghz; }
+    // 墙钟锚点 (标定时同时读取的一对 TSC 与 CLOCK_REALTIME)
+    static uint64_t base_tsc() { return s_base_tsc; }
+    static int64_t base_wall_ns() { return s_base_wall_ns; }
+
+private:
+    static const unsigned MULT_SHIFT = 32;
+
+    static uint64_t s_mult;         // 纳秒/周期，32.32 定点
+    static uint64_t s_base_tsc;
+    static int64_t s_base_wall_ns;
+    static double s_ghz;
+    static bool s_serialized;
+    static bool s_calibrated;
+};
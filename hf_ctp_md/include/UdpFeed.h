@@ -0,0 +1,203 @@
+#pragma once
+
+#include "SPSCQueue.h"
+#include "Tick.h"
+#include "TscClock.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+// UDP 组播行情转发：给同机其他容器里的消费者 (共享内存挂载不进去的场景)
+//
+// 报文：[PacketHeader][Tick x tick_count]，每个报文带递增的报文序号，接收端据此检测丢包；
+// 报文头占满一个缓存行，接收缓冲里的 Tick 保持 64 字节对齐，回调可以直接按 const Tick& 使用
+// - 发布端：引擎线程 append() 推入专用 SPSC 环 (与 TickRecorder 相同，环满丢弃并计数)，
+//   发送线程把环里现有的 tick 按 ticks_per_packet 打包，一次 sendmmsg 发出多个报文；
+//   环里有数据就立即发送，不为凑满报文等待
+// - 接收端：recvmmsg 一次收取多个报文，按报文序号统计丢包、乱序/重复；发布端重启 (session 变化) 时重新计数
+// - 报文里带发送时刻，接收端可以分别统计 "CTP 接收 -> 发出" 与 "发出 -> 收到" 两段延迟
+//   (同机时两端共用同一 TSC 时钟源，标定误差在微秒级)
+namespace udpfeed {
+
+const uint32_t MAGIC = 0x55544648; // "HFTU"
+const uint16_t VERSION = 2; // 2: 报文头补齐到 64 字节
+
+struct PacketHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t tick_count;
+    uint32_t session;     // 发布端每次启动不同，接收端据此区分重启
+    uint32_t tick_size;   // sizeof(Tick)
+    uint64_t seq;         // 报文序号，从 1 开始连续递增
+    int64_t send_ns;      // sendmmsg 之前的时刻 (UTC epoch 纳秒)
+    uint8_t reserved[32]; // 补齐到一个缓存行，填 0
+};
+
+static_assert(sizeof(PacketHeader) == CACHELINE_SIZE, "PacketHeader must keep the ticks cache-line aligned");
+
+// 以太网 MTU 1500 - IP/UDP 头 28 字节，默认每包 10 条 (1344 字节) 不会分片
+const size_t DEFAULT_TICKS_PER_PACKET = 10;
+const size_t MAX_TICKS_PER_PACKET = 64;
+const size_t MAX_PACKET_SIZE = sizeof(PacketHeader) + MAX_TICKS_PER_PACKET * sizeof(Tick);
+// 收发缓冲按 MAX_PACKET_SIZE 等距排列报文，步长须为缓存行的整数倍
+static_assert(MAX_PACKET_SIZE % CACHELINE_SIZE == 0, "packet stride must be a multiple of the cache line");
+
+// "a.b.c.d" -> sockaddr_in，失败返回 false
+bool make_address(const std::string& host, uint16_t port, sockaddr_in& out);
+
+} // namespace udpfeed
+
+class UdpPublisher {
+public:
+    static const size_t DEFAULT_RING_SIZE = 65536;
+    static const size_t MAX_BATCH = 32;  // 每次 sendmmsg 最多的报文数
+
+    explicit UdpPublisher(size_t ring_size = DEFAULT_RING_SIZE);
+    ~UdpPublisher();
+
+    UdpPublisher(const UdpPublisher&) = delete;
+    UdpPublisher& operator=(const UdpPublisher&) = delete;
+
+    // group 为组播地址 (224.0.0.0/4) 或单播地址 (如 127.0.0.1)；iface 为发送组播用的本机接口地址
+    // ttl 为组播 TTL，同机容器经网桥转发时至少为 1
+    bool open(const std::string& group, uint16_t port, const std::string& iface = "127.0.0.1",
+              size_t ticks_per_packet = udpfeed::DEFAULT_TICKS_PER_PACKET, int ttl = 1);
+
+    // 发送线程绑定的核心，< 0 不绑核；必须在 start() 之前调用
+    void set_cpu_affinity(int cpu_id);
+    // 环为空时的睡眠时长，0 表示忙轮询 (发送线程独占核心时使用)
+    void set_idle_sleep_us(unsigned sleep_us);
+
+    void start();
+    // 发完环中剩余数据后关闭
+    void stop();
+
+    // === 引擎线程调用 ===
+    inline bool append(const Tick& tick) __attribute__((always_inline)) {
+        Tick* slot = m_ring.claim();
+        if (__builtin_expect(!slot, 0)) {
+            m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        *slot = tick;
+        m_ring.commit();
+        return true;
+    }
+
+    // 预先触碰转发环，必须在 start() 之前、引擎开始 append 之前调用
+    void prefault() { m_ring.prefault(); }
+    size_t ring_bytes() const { return m_ring.capacity() * sizeof(Tick); }
+
+    bool is_open() const { return m_fd >= 0; }
+    uint64_t packets() const { return m_packets.load(std::memory_order_relaxed); }
+    uint64_t ticks_sent() const { return m_ticks.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    uint64_t send_errors() const { return m_errors.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    size_t send(size_t count);
+
+private:
+    SPSCQueue<Tick> m_ring;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::atomic<uint64_t> m_packets; // 发送线程单写
+    std::atomic<uint64_t> m_ticks;   // 发送线程单写
+    std::atomic<uint64_t> m_errors;  // 发送线程单写
+    std::atomic<uint64_t> m_dropped; // 引擎线程单写
+
+    int m_fd;
+    sockaddr_in m_dest;
+    size_t m_ticksPerPacket;
+    int m_cpuId;
+    unsigned m_idleSleepUs;
+    uint32_t m_session;
+    uint64_t m_seq;
+
+    // 发送缓冲：MAX_BATCH 个报文，每个 MAX_PACKET_SIZE
+    char* m_buffer;
+    std::vector<mmsghdr> m_msgs;
+    std::vector<iovec> m_iovs;
+};
+
+// 接收端 (客户端库)：每个接收线程一个实例
+//
+//   UdpReceiver rx;
+//   rx.open("239.255.0.1", 30001);
+//   while (running) rx.poll([&](const Tick& t, const udpfeed::PacketHeader& h, int64_t recv_ns) { ... }, 100);
+class UdpReceiver {
+public:
+    static const size_t BATCH = 64;  // 每次 recvmmsg 最多的报文数
+
+    UdpReceiver();
+    ~UdpReceiver();
+
+    UdpReceiver(const UdpReceiver&) = delete;
+    UdpReceiver& operator=(const UdpReceiver&) = delete;
+
+    // 绑定 port 并在 iface 上加入组播组 (group 为单播地址时只绑定)；同机多个接收端可以绑定同一端口
+    // rcvbuf_bytes 为 0 时使用系统默认值，突发行情下接收缓冲太小会丢包
+    bool open(const std::string& group, uint16_t port, const std::string& iface = "127.0.0.1",
+              int rcvbuf_bytes = 4 << 20);
+    void close();
+
+    // 收取一批报文 (最多 BATCH 个)，对其中每条 tick 调用 fn(const Tick&, const PacketHeader&, int64_t recv_ns)
+    // timeout_ms > 0 时没有数据最多等待这么久，0 立即返回；返回本次交付的 tick 数
+    // tick 指向接收缓冲区，下次 poll() 之前有效
+    template<typename Fn>
+    size_t poll(Fn fn, int timeout_ms = 0) {
+        const int n = receive(timeout_ms);
+        if (n <= 0) return 0;
+        const int64_t recv_ns = TscClock::wall_ns();
+        size_t delivered = 0;
+        for (int i = 0; i < n; ++i) {
+            const char* data = m_buffer + (size_t)i * udpfeed::MAX_PACKET_SIZE;
+            const udpfeed::PacketHeader* header = reinterpret_cast<const udpfeed::PacketHeader*>(data);
+            if (!accept(header, m_msgs[i].msg_len)) continue;
+            const Tick* ticks = reinterpret_cast<const Tick*>(data + sizeof(udpfeed::PacketHeader));
+            for (uint16_t k = 0; k < header->tick_count; ++k) fn(ticks[k], *header, recv_ns);
+            delivered += header->tick_count;
+        }
+        m_ticks += delivered;
+        return delivered;
+    }
+
+    bool is_open() const { return m_fd >= 0; }
+    int fd() const { return m_fd; }
+
+    uint64_t packets() const { return m_packets; }
+    uint64_t ticks() const { return m_ticks; }
+    uint64_t gaps() const { return m_gaps; }           // 检测到序号跳跃的次数
+    uint64_t lost() const { return m_lost; }           // 跳过的报文数合计
+    uint64_t out_of_order() const { return m_outOfOrder; } // 序号回退 (乱序或重复)，这些报文被丢弃
+    uint64_t malformed() const { return m_malformed; }
+    uint64_t resets() const { return m_resets; }       // 发布端重启次数
+    uint64_t batches() const { return m_batches; }     // 有数据的 recvmmsg 调用次数
+
+private:
+    int receive(int timeout_ms);
+    bool accept(const udpfeed::PacketHeader* header, size_t length);
+
+private:
+    int m_fd;
+    char* m_buffer;
+    std::vector<mmsghdr> m_msgs;
+    std::vector<iovec> m_iovs;
+
+    uint32_t m_session;
+    uint64_t m_nextSeq;  // 期望的下一个报文序号，0 表示尚未收到任何报文
+    uint64_t m_packets;
+    uint64_t m_ticks;
+    uint64_t m_gaps;
+    uint64_t m_lost;
+    uint64_t m_outOfOrder;
+    uint64_t m_malformed;
+    uint64_t m_resets;
+    uint64_t m_batches;
+};
@@ -1,9 +1,16 @@
 #include "CTPMdSpi.h"
+#include "AsyncLog.h"
 #include <chrono>
 #include <pthread.h>
+#include <immintrin.h> // _mm_pause
 
-CTPMdSpi::CTPMdSpi(CThostFtdcMdApi* pUserApi, SPSCQueue<MdData>* pQueue)
-    : m_pUserApi(pUserApi), m_pQueue(pQueue), m_requestId(0) {
+CTPMdSpi::CTPMdSpi(CThostFtdcMdApi* pUserApi, SPSCQueue<Tick>* pQueue, const InstrumentRegistry* pRegistry)
+    : m_pUserApi(pUserApi), m_pRegistry(pRegistry), m_routes(pRegistry->size()), m_sharded(false),
+      m_requestId(0), m_pArbiter(nullptr), m_pPrimary(this), m_source(0), m_pDrops(nullptr), m_pendingCount(0) {
+    for (size_t id = 0; id < m_routes.size(); ++id) {
+        m_routes[id].queue = pQueue;
+        m_routes[id].snapshots = nullptr;
+    }
 }
 
 CTPMdSpi::~CTPMdSpi() {
@@ -11,11 +18,13 @@ CTPMdSpi::~CTPMdSpi() {
 
 void CTPMdSpi::OnFrontConnected() {
     // 不再绑核，仅打印连接信息
-    std::cout << "[CTPThread] Front Connected." << std::endl;
+    if (m_pArbiter) m_pArbiter->set_connected(m_source, true);
+    LOG_INFO("[CTPThread] Front {} Connected.", (int)m_source);
 }
 
 void CTPMdSpi::OnFrontDisconnected(int nReason) {
-    std::cout << "[MainThread] Front Disconnected. Reason: " << nReason << std::endl;
+    if (m_pArbiter) m_pArbiter->set_connected(m_source, false);
+    LOG_WARN("[MainThread] Front {} Disconnected. Reason: {}", (int)m_source, nReason);
 }
 
 void CTPMdSpi::ReqUserLogin(const char* brokerId, const char* userId, const char* password) {
@@ -27,51 +36,214 @@ void CTPMdSpi::ReqUserLogin(const char* brokerId, const char* userId, const char
     
     int ret = m_pUserApi->ReqUserLogin(&req, ++m_requestId);
     if (ret != 0) {
-        std::cerr << "[MainThread] ReqUserLogin failed: " << ret << std::endl;
+        LOG_ERROR("[MainThread] ReqUserLogin failed: {}", ret);
     }
 }
 
 void CTPMdSpi::OnRspUserLogin(CThostFtdcRspUserLoginField *pRspUserLogin, CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast) {
     if (pRspInfo && pRspInfo->ErrorID != 0) {
-        std::cerr << "[MainThread] Login Failed: " << pRspInfo->ErrorMsg << std::endl;
+        LOG_ERROR("[MainThread] Login Failed: {}", hf_log::gbk(pRspInfo->ErrorMsg));
     } else {
-        std::cout << "[MainThread] Login Success. TradingDay: " << pRspUserLogin->TradingDay << std::endl;
+        LOG_INFO("[MainThread] Login Success. TradingDay: {}", pRspUserLogin->TradingDay);
     }
 }
 
 void CTPMdSpi::SubscribeMarketData(char* ppInstrumentID[], int nCount) {
     int ret = m_pUserApi->SubscribeMarketData(ppInstrumentID, nCount);
     if (ret != 0) {
-        std::cerr << "[MainThread] SubscribeMarketData failed: " << ret << std::endl;
+        LOG_ERROR("[MainThread] SubscribeMarketData failed: {}", ret);
     }
 }
 
 void CTPMdSpi::OnRspSubMarketData(CThostFtdcSpecificInstrumentField *pSpecificInstrument, CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast) {
     if (pRspInfo && pRspInfo->ErrorID != 0) {
-        std::cerr << "[MainThread] Subscribe Failed: " << pRspInfo->ErrorMsg << std::endl;
+        LOG_ERROR("[MainThread] Subscribe Failed: {}", hf_log::gbk(pRspInfo->ErrorMsg));
     } else {
-        std::cout << "[MainThread] Subscribe Success: " << (pSpecificInstrument ? pSpecificInstrument->InstrumentID : "null") << std::endl;
+        LOG_INFO("[MainThread] Subscribe Success: {}", pSpecificInstrument ? pSpecificInstrument->InstrumentID : "null");
+    }
+}
+
+void CTPMdSpi::SetOverflowPolicy(const OverflowConfig& config, DropCounters* pDrops) {
+    m_overflow = config;
+    m_pDrops = pDrops;
+    m_pendingCount = 0;
+    m_pending.clear();
+    m_pendingBits.clear();
+    if (config.policy == OverflowPolicy::Conflate) {
+        // 预先分配好暂存表，回调里不做任何分配
+        m_pending.resize(m_pRegistry->size());
+        m_pendingBits.assign((m_pRegistry->size() + 63) / 64, 0);
+    }
+    LOG_INFO("[MainThread] Overflow policy: {}", overflow_policy_name(config.policy));
+}
+
+void CTPMdSpi::SetSnapshotTable(SnapshotTable<Tick>* pSnapshots) {
+    for (size_t id = 0; id < m_routes.size(); ++id) m_routes[id].snapshots = pSnapshots;
+}
+
+void CTPMdSpi::SetShards(const ShardMap& map, const std::vector<SPSCQueue<Tick>*>& queues,
+                         const std::vector<SnapshotTable<Tick>*>& snapshots) {
+    for (size_t id = 0; id < m_routes.size(); ++id) {
+        const size_t shard = map.shard_of((uint16_t)id);
+        m_routes[id].queue = queues[shard];
+        m_routes[id].snapshots = snapshots.empty() ? nullptr : snapshots[shard];
+    }
+    m_sharded = map.shard_count() > 1;
+}
+
+void CTPMdSpi::SetArbiter(FeedArbiter* pArbiter, uint8_t source, CTPMdSpi* pPrimary) {
+    m_pArbiter = pArbiter;
+    m_source = source;
+    m_pPrimary = pPrimary ? pPrimary : this;
+}
+
+void CTPMdSpi::FlushPending() {
+    for (size_t w = 0; w < m_pendingBits.size(); ++w) {
+        uint64_t bits = m_pendingBits[w];
+        while (bits) {
+            const size_t bit = __builtin_ctzll(bits);
+            bits &= bits - 1;
+            const size_t id = w * 64 + bit;
+            SPSCQueue<Tick>* pQueue = m_routes[id].queue;
+            Tick* slot = pQueue->claim();
+            if (!slot) {
+                // 不分片时队列满就停止；分片时只跳过这个分片，继续补发其他分片的合约
+                if (!m_sharded) return;
+                continue;
+            }
+            *slot = m_pending[id];
+            pQueue->commit();
+            m_pendingBits[w] &= ~(1ULL << bit);
+            --m_pendingCount;
+        }
     }
 }
 
-// 辅助函数：读取 CPU 时间戳计数器
-static inline uint64_t rdtsc() {
-    unsigned int lo, hi;
-    __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
-    return ((uint64_t)hi << 32) | lo;
+Tick* CTPMdSpi::HandleOverflow(SPSCQueue<Tick>* pQueue, const CThostFtdcDepthMarketDataField* pDepthMarketData,
+                               uint16_t id, int64_t receive_ns, uint8_t source) {
+    switch (m_overflow.policy) {
+        case OverflowPolicy::DropNewest:
+            break;
+
+        case OverflowPolicy::SpinTimeout: {
+            // 有界自旋，超时仍满则丢弃，不能长时间卡住 CTP 网络线程
+            const uint64_t start = TscClock::rdtsc();
+            do {
+                _mm_pause();
+                Tick* slot = pQueue->claim();
+                if (slot) return slot;
+            } while ((uint64_t)TscClock::to_ns((int64_t)(TscClock::rdtsc() - start)) < m_overflow.spin_timeout_ns);
+            break;
+        }
+
+        case OverflowPolicy::OverwriteOldest: {
+            bool evicted = false;
+            Tick* slot = pQueue->claim_overwrite(&evicted);
+            if (slot) {
+                if (evicted && m_pDrops) {
+                    DropCounters::bump(m_pDrops->at(slot->instrument_id).overwritten);
+                }
+                return slot;
+            }
+            break;
+        }
+
+        case OverflowPolicy::Conflate:
+            Conflate(pDepthMarketData, id, receive_ns, source);
+            return nullptr;
+    }
+
+    if (m_pDrops) DropCounters::bump(m_pDrops->at(id).dropped);
+    return nullptr;
+}
+
+void CTPMdSpi::Conflate(const CThostFtdcDepthMarketDataField* pDepthMarketData, uint16_t id, int64_t receive_ns,
+                        uint8_t source) {
+    uint64_t& word = m_pendingBits[id / 64];
+    const uint64_t bit = 1ULL << (id % 64);
+    if (word & bit) {
+        if (m_pDrops) DropCounters::bump(m_pDrops->at(id).conflated);
+    } else {
+        word |= bit;
+        ++m_pendingCount;
+    }
+    normalize_tick(*pDepthMarketData, id, m_pRegistry->inv_price_tick(id), receive_ns, m_pending[id]);
+    m_pending[id].source = source;
 }
 
 // === 关键路径 ===
 void CTPMdSpi::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField *pDepthMarketData) {
     if (!pDepthMarketData) return;
 
-    MdData md;
-    // 1. 极速记录时间 (RDTSC 指令)
-    md.receive_tsc = rdtsc();
+    // 1. 极速记录时间 (RDTSC 换算为 epoch 纳秒)
+    const int64_t receive_ns = TscClock::wall_ns();
+
+    // 2. 合约代码 -> 稠密 id；未注册的合约没有最小变动价位，无法归一化，计入丢弃
+    //    多前置时只有第一个前置持有 DropCounters，按前置计入仲裁器的统计 (各前置单写)
+    const uint16_t id = m_pRegistry->find_field(pDepthMarketData->InstrumentID);
+    if (id == InstrumentRegistry::INVALID_ID) {
+        if (m_pArbiter) {
+            m_pArbiter->count_unknown(m_source);
+        } else if (m_pDrops) {
+            DropCounters::bump(m_pDrops->at(id).dropped);
+        }
+        return;
+    }
+
+    // 3. 多前置时先仲裁：只有最先到达的一笔写入 (判重与入队在同一把锁内，保证同一合约的顺序)
+    if (!m_pArbiter) {
+        Publish(pDepthMarketData, id, receive_ns, m_source);
+        return;
+    }
+    m_pArbiter->lock();
+    if (m_pArbiter->accept(m_source, id, *pDepthMarketData, receive_ns)) {
+        m_pPrimary->Publish(pDepthMarketData, id, receive_ns, m_source);
+    }
+    m_pArbiter->unlock();
+}
 
-    // 2. 数据拷贝
-    std::memcpy(&md.data, pDepthMarketData, sizeof(CThostFtdcDepthMarketDataField));
+void CTPMdSpi::Publish(const CThostFtdcDepthMarketDataField* pDepthMarketData, uint16_t id, int64_t receive_ns,
+                       uint8_t source) {
+    const double inv_price_tick = m_pRegistry->inv_price_tick(id);
+    const Route& route = m_routes[id];
 
-    // 3. 推入无锁队列
-    m_pQueue->push(md);
-}
\ No newline at end of file
+    // 4. 更新最新快照 (与队列无关，队列满时快照照样是最新的)
+    const Tick* snap = nullptr;
+    if (route.snapshots) {
+        Tick* slot = route.snapshots->begin_write(id);
+        normalize_tick(*pDepthMarketData, id, inv_price_tick, receive_ns, *slot);
+        slot->source = source;
+        route.snapshots->end_write(id);
+        snap = slot;
+    }
+
+    // 5. 先补发按合约合并暂存的 tick，保证同一合约的先后顺序
+    //    本合约的暂存没能补发 (队列仍满，或分片时所在分片已满) 时，新 tick 只能合并进暂存：
+    //    补发停下之后消费者可能刚好腾出槽位，直接入队会越过更早的暂存 tick
+    if (m_pendingCount) {
+        FlushPending();
+        if (IsPending(id)) {
+            Conflate(pDepthMarketData, id, receive_ns, source);
+            return;
+        }
+    }
+
+    // 6. 直接申请队列槽位，行情原地写入，省去栈上临时对象和入队的两次拷贝
+    //    队列已满时按溢出策略处理，不再静默丢弃
+    Tick* tick = route.queue->claim();
+    if (!tick) {
+        tick = HandleOverflow(route.queue, pDepthMarketData, id, receive_ns, source);
+        if (!tick) return;
+    }
+
+    // 7. 归一化写入槽位 (已写过快照时直接拷贝 128 字节)
+    if (snap) {
+        *tick = *snap;
+    } else {
+        normalize_tick(*pDepthMarketData, id, inv_price_tick, receive_ns, *tick);
+        tick->source = source;
+    }
+
+    // 8. 发布到消费者
+    route.queue->commit();
+}
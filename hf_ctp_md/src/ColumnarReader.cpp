@@ -0,0 +1,216 @@
+#include "ColumnarReader.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace columnar;
+
+ColumnarReader::ColumnarReader()
+    : m_fd(-1), m_base(nullptr), m_size(0), m_header(nullptr), m_instruments(nullptr), m_blocks(nullptr),
+      m_blocksDecoded(0) {
+}
+
+ColumnarReader::~ColumnarReader() {
+    close();
+}
+
+bool ColumnarReader::open(const std::string& path) {
+    close();
+
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+        std::cerr << "[Columnar] Failed to open " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(m_fd, &st) != 0 || (size_t)st.st_size < sizeof(FileHeader)) {
+        std::cerr << "[Columnar] " << path << " is too small to be a columnar file." << std::endl;
+        close();
+        return false;
+    }
+    m_size = (size_t)st.st_size;
+
+    void* base = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (base == MAP_FAILED) {
+        std::cerr << "[Columnar] mmap failed: " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    m_base = static_cast<const uint8_t*>(base);
+    madvise(base, m_size, MADV_RANDOM);
+
+    m_header = reinterpret_cast<const FileHeader*>(m_base);
+    const char* error = nullptr;
+    if (memcmp(m_header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "bad magic";
+    } else if (m_header->version != VERSION) {
+        error = "unsupported version";
+    } else if (m_header->tick_size != sizeof(Tick)) {
+        error = "Tick layout differs from this build";
+    } else if (m_header->instrument_offset + (uint64_t)m_header->instrument_count * sizeof(InstrumentEntry) > m_size ||
+               m_header->block_offset + m_header->block_count * sizeof(BlockEntry) > m_size) {
+        error = "truncated directory";
+    }
+    if (error) {
+        std::cerr << "[Columnar] " << path << ": " << error << std::endl;
+        close();
+        return false;
+    }
+
+    m_instruments = reinterpret_cast<const InstrumentEntry*>(m_base + m_header->instrument_offset);
+    m_blocks = reinterpret_cast<const BlockEntry*>(m_base + m_header->block_offset);
+    for (size_t i = 0; i < m_header->instrument_count; ++i) {
+        if ((uint64_t)m_instruments[i].first_block + m_instruments[i].block_count > m_header->block_count) {
+            std::cerr << "[Columnar] " << path << ": corrupt instrument table" << std::endl;
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void ColumnarReader::close() {
+    if (m_base) munmap(const_cast<uint8_t*>(m_base), m_size);
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = -1;
+    m_base = nullptr;
+    m_size = 0;
+    m_header = nullptr;
+    m_instruments = nullptr;
+    m_blocks = nullptr;
+}
+
+uint16_t ColumnarReader::find_instrument(const char* instrument_id) const {
+    for (size_t i = 0; i < m_header->instrument_count; ++i) {
+        if (strncmp(m_instruments[i].instrument_id, instrument_id, sizeof(m_instruments[i].instrument_id)) == 0) {
+            return (uint16_t)i;
+        }
+    }
+    return INVALID_ID;
+}
+
+namespace {
+
+// 单列的顺序读取游标，越界或 varint 损坏后 ok 置为 false，之后读到的都是 0
+struct ColumnCursor {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok;
+
+    ColumnCursor(const uint8_t* begin, size_t len) : p(begin), end(begin + len), ok(true) {}
+
+    int64_t next_signed() {
+        uint64_t v = 0;
+        const uint8_t* q = ok ? get_varint(p, end, v) : nullptr;
+        if (!q) {
+            ok = false;
+            return 0;
+        }
+        p = q;
+        return unzigzag(v);
+    }
+
+    uint8_t next_byte() {
+        if (!ok || p >= end) {
+            ok = false;
+            return 0;
+        }
+        return *p++;
+    }
+
+    double next_double() {
+        double v = 0;
+        if (!ok || end - p < (ptrdiff_t)sizeof(double)) {
+            ok = false;
+            return 0;
+        }
+        memcpy(&v, p, sizeof(double));
+        p += sizeof(double);
+        return v;
+    }
+};
+
+} // namespace
+
+// 各列独立解码，未选中的列直接跳过 (按列存放的好处：只取时间和最新价时不触碰盘口列的页面)
+size_t ColumnarReader::decode_block(const BlockEntry& entry, Tick* out, uint32_t columns) const {
+    // 块须整体落在文件内，各列偏移单调不减且不越过块尾 (列长度由相邻偏移相减得到，乱序会下溢)
+    if (entry.offset > m_size || entry.length > m_size - entry.offset) return 0;
+    for (int c = 0; c < NUM_COLUMNS; ++c) {
+        const uint32_t end = c + 1 < NUM_COLUMNS ? entry.column_offset[c + 1] : entry.length;
+        if (entry.column_offset[c] > end || end > entry.length) return 0;
+    }
+    const uint8_t* block = m_base + entry.offset;
+    const size_t n = entry.tick_count;
+    memset(static_cast<void*>(out), 0, n * sizeof(Tick));
+    for (size_t i = 0; i < n; ++i) out[i].instrument_id = entry.instrument_id;
+
+    bool ok = true;
+    for (int c = 0; c < NUM_COLUMNS && ok; ++c) {
+        if (!(columns & (1u << c))) continue;
+        ColumnCursor col(block + entry.column_offset[c], entry.column_length(c));
+
+        switch (c) {
+        case COL_EXCHANGE_TS:
+        case COL_RECEIVE_TS: {
+            int64_t prev = 0, delta = 0;
+            for (size_t i = 0; i < n; ++i) {
+                delta += col.next_signed();
+                prev += delta;
+                if (c == COL_EXCHANGE_TS) out[i].exchange_ts_ns = prev;
+                else out[i].receive_ns = prev;
+            }
+            break;
+        }
+        case COL_LAST_PX: {
+            int64_t prev = 0;
+            for (size_t i = 0; i < n; ++i) out[i].last_px = prev += col.next_signed();
+            break;
+        }
+        case COL_VOLUME: {
+            int64_t prev = 0;
+            for (size_t i = 0; i < n; ++i) out[i].volume = (int32_t)(prev += col.next_signed());
+            break;
+        }
+        case COL_TURNOVER:
+            for (size_t i = 0; i < n; ++i) out[i].turnover = col.next_double();
+            break;
+        case COL_OPEN_INTEREST: {
+            int64_t prev = 0;
+            for (size_t i = 0; i < n; ++i) out[i].open_interest = (int32_t)(prev += col.next_signed());
+            break;
+        }
+        case COL_BID_PX:
+        case COL_ASK_PX: {
+            int64_t prev[5] = {0};
+            for (size_t i = 0; i < n; ++i) {
+                int32_t* px = c == COL_BID_PX ? out[i].bid_px : out[i].ask_px;
+                for (int k = 0; k < 5; ++k) px[k] = (int32_t)(prev[k] += col.next_signed());
+            }
+            break;
+        }
+        case COL_BID_VOL:
+        case COL_ASK_VOL:
+            for (size_t i = 0; i < n; ++i) {
+                int32_t* vol = c == COL_BID_VOL ? out[i].bid_vol : out[i].ask_vol;
+                for (int k = 0; k < 5; ++k) vol[k] = (int32_t)col.next_signed();
+            }
+            break;
+        case COL_META: {
+            int64_t prev = 0;
+            for (size_t i = 0; i < n; ++i) {
+                out[i].source = col.next_byte();
+                out[i].flags = col.next_byte();
+                out[i].trading_day = (uint32_t)(prev += col.next_signed());
+            }
+            break;
+        }
+        }
+        ok = col.ok;
+    }
+    return ok ? n : 0;
+}
@@ -0,0 +1,257 @@
+#include "ColumnarWriter.h"
+#include "TscClock.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <unistd.h>
+
+using namespace columnar;
+
+// 每条 tick 在各列中最多占用的字节数 (varint 最长 10 字节)
+static const size_t MAX_COLUMN_BYTES[NUM_COLUMNS] = {
+    10, 10, 10, 10, 8, 10, 50, 50, 50, 50, 12
+};
+
+ColumnarWriter::ColumnarWriter(size_t block_ticks, size_t max_pending_ticks)
+    : m_blockTicks(block_ticks > 0 ? block_ticks : DEFAULT_BLOCK_TICKS),
+      m_maxPendingTicks(std::max(max_pending_ticks, m_blockTicks)), m_pendingTicks(0), m_budgetFlushes(0),
+      m_fd(-1), m_tradingDay(0), m_offset(0), m_tickCount(0), m_blockCount(0), m_failed(false) {
+    for (int c = 0; c < NUM_COLUMNS; ++c) {
+        m_columns[c].resize(m_blockTicks * MAX_COLUMN_BYTES[c]);
+        m_columnBytes[c] = 0;
+    }
+}
+
+ColumnarWriter::~ColumnarWriter() {
+    close();
+}
+
+bool ColumnarWriter::open(const std::string& path, uint32_t trading_day) {
+    if (m_fd >= 0) return false;
+
+    m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0) {
+        std::cerr << "[Columnar] Failed to open " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    m_path = path;
+    m_tradingDay = trading_day;
+    m_offset = 0;
+    m_failed = false;
+
+    // 先写一个空文件头占位，close() 时回填
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    return write_all(&header, sizeof(header));
+}
+
+uint16_t ColumnarWriter::add_instrument(const char* instrument_id, double price_tick) {
+    std::unordered_map<std::string, uint16_t>::const_iterator it = m_ids.find(instrument_id);
+    if (it != m_ids.end()) return it->second;
+    if (m_instruments.size() >= 0xFFFF) return 0xFFFF;
+
+    const uint16_t id = (uint16_t)m_instruments.size();
+    m_instruments.push_back(InstrumentState());
+    InstrumentState& inst = m_instruments.back();
+    inst.id = instrument_id;
+    inst.price_tick = price_tick;
+    inst.tick_count = 0;
+    m_ids[inst.id] = id;
+    return id;
+}
+
+bool ColumnarWriter::append(const Tick& tick) {
+    if (m_fd < 0 || tick.instrument_id >= m_instruments.size()) return false;
+
+    InstrumentState& inst = m_instruments[tick.instrument_id];
+    const size_t capacity = inst.pending.capacity();
+    inst.pending.push_back(tick);
+    m_pendingTicks += inst.pending.capacity() - capacity;
+    if (inst.pending.size() >= m_blockTicks && !flush_block(tick.instrument_id)) return false;
+    if (m_pendingTicks > m_maxPendingTicks) return flush_over_budget();
+    return !m_failed;
+}
+
+// 缓存超出预算：先释放已写空的缓冲区，仍超出一半预算时从缓存最多的合约开始提前写出不满的块
+bool ColumnarWriter::flush_over_budget() {
+    std::vector<uint16_t> ids;
+    for (size_t i = 0; i < m_instruments.size(); ++i) {
+        InstrumentState& inst = m_instruments[i];
+        if (inst.pending.empty()) {
+            m_pendingTicks -= inst.pending.capacity();
+            std::vector<Tick, AlignedAllocator<Tick> >().swap(inst.pending);
+        } else {
+            ids.push_back((uint16_t)i);
+        }
+    }
+    std::sort(ids.begin(), ids.end(), [this](uint16_t a, uint16_t b) {
+        return m_instruments[a].pending.size() > m_instruments[b].pending.size();
+    });
+
+    for (size_t i = 0; i < ids.size() && m_pendingTicks > m_maxPendingTicks / 2; ++i) {
+        InstrumentState& inst = m_instruments[ids[i]];
+        if (!flush_block(ids[i])) return false;
+        m_pendingTicks -= inst.pending.capacity();
+        std::vector<Tick, AlignedAllocator<Tick> >().swap(inst.pending);
+        m_budgetFlushes++;
+    }
+    return !m_failed;
+}
+
+bool ColumnarWriter::write_all(const void* data, size_t len) {
+    const char* p = static_cast<const char*>(data);
+    while (len > 0) {
+        const ssize_t n = ::write(m_fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[Columnar] write failed: " << strerror(errno) << std::endl;
+            m_failed = true;
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+        m_offset += (uint64_t)n;
+    }
+    return true;
+}
+
+// 编码一个合约的一块 tick：各列分别编码到自己的缓冲区，再按列顺序拼接写出
+bool ColumnarWriter::flush_block(uint16_t id) {
+    InstrumentState& inst = m_instruments[id];
+    const std::vector<Tick, AlignedAllocator<Tick> >& ticks = inst.pending;
+    if (ticks.empty()) return !m_failed;
+
+    uint8_t* out[NUM_COLUMNS];
+    for (int c = 0; c < NUM_COLUMNS; ++c) out[c] = m_columns[c].data();
+
+    BlockEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.offset = m_offset;
+    entry.tick_count = (uint32_t)ticks.size();
+    entry.instrument_id = id;
+    entry.min_exchange_ts = entry.max_exchange_ts = ticks[0].exchange_ts_ns;
+    entry.min_last_px = entry.max_last_px = ticks[0].last_px;
+    entry.min_volume = entry.max_volume = ticks[0].volume;
+
+    int64_t prev_ts = 0, prev_ts_delta = 0;
+    int64_t prev_recv = 0, prev_recv_delta = 0;
+    int64_t prev_px = 0, prev_volume = 0, prev_oi = 0, prev_day = 0;
+    int64_t prev_bid[5] = {0}, prev_ask[5] = {0};
+
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        const Tick& t = ticks[i];
+
+        const int64_t ts_delta = t.exchange_ts_ns - prev_ts;
+        out[COL_EXCHANGE_TS] = put_varint(out[COL_EXCHANGE_TS], zigzag(ts_delta - prev_ts_delta));
+        prev_ts = t.exchange_ts_ns;
+        prev_ts_delta = ts_delta;
+
+        const int64_t recv_delta = t.receive_ns - prev_recv;
+        out[COL_RECEIVE_TS] = put_varint(out[COL_RECEIVE_TS], zigzag(recv_delta - prev_recv_delta));
+        prev_recv = t.receive_ns;
+        prev_recv_delta = recv_delta;
+
+        out[COL_LAST_PX] = put_varint(out[COL_LAST_PX], zigzag(t.last_px - prev_px));
+        prev_px = t.last_px;
+        out[COL_VOLUME] = put_varint(out[COL_VOLUME], zigzag(t.volume - prev_volume));
+        prev_volume = t.volume;
+        memcpy(out[COL_TURNOVER], &t.turnover, sizeof(double));
+        out[COL_TURNOVER] += sizeof(double);
+        out[COL_OPEN_INTEREST] = put_varint(out[COL_OPEN_INTEREST], zigzag(t.open_interest - prev_oi));
+        prev_oi = t.open_interest;
+
+        for (int k = 0; k < 5; ++k) {
+            out[COL_BID_PX] = put_varint(out[COL_BID_PX], zigzag(t.bid_px[k] - prev_bid[k]));
+            out[COL_ASK_PX] = put_varint(out[COL_ASK_PX], zigzag(t.ask_px[k] - prev_ask[k]));
+            out[COL_BID_VOL] = put_varint(out[COL_BID_VOL], zigzag(t.bid_vol[k]));
+            out[COL_ASK_VOL] = put_varint(out[COL_ASK_VOL], zigzag(t.ask_vol[k]));
+            prev_bid[k] = t.bid_px[k];
+            prev_ask[k] = t.ask_px[k];
+        }
+
+        *out[COL_META]++ = t.source;
+        *out[COL_META]++ = t.flags;
+        out[COL_META] = put_varint(out[COL_META], zigzag((int64_t)t.trading_day - prev_day));
+        prev_day = t.trading_day;
+
+        entry.min_exchange_ts = std::min(entry.min_exchange_ts, t.exchange_ts_ns);
+        entry.max_exchange_ts = std::max(entry.max_exchange_ts, t.exchange_ts_ns);
+        entry.min_last_px = std::min(entry.min_last_px, t.last_px);
+        entry.max_last_px = std::max(entry.max_last_px, t.last_px);
+        entry.min_volume = std::min(entry.min_volume, t.volume);
+        entry.max_volume = std::max(entry.max_volume, t.volume);
+    }
+
+    uint32_t column_offset = 0;
+    for (int c = 0; c < NUM_COLUMNS; ++c) {
+        const size_t len = (size_t)(out[c] - m_columns[c].data());
+        entry.column_offset[c] = column_offset;
+        column_offset += (uint32_t)len;
+        m_columnBytes[c] += len;
+        if (!write_all(m_columns[c].data(), len)) return false;
+    }
+    entry.length = column_offset;
+
+    inst.blocks.push_back(entry);
+    inst.tick_count += ticks.size();
+    m_tickCount += ticks.size();
+    m_blockCount++;
+    inst.pending.clear();
+    return true;
+}
+
+bool ColumnarWriter::close() {
+    if (m_fd < 0) return false;
+
+    bool ok = !m_failed;
+    for (size_t i = 0; ok && i < m_instruments.size(); ++i) {
+        ok = flush_block((uint16_t)i);
+    }
+
+    // 合约表 + 按合约排序的块目录
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.instrument_offset = m_offset;
+    uint32_t first_block = 0;
+    for (size_t i = 0; ok && i < m_instruments.size(); ++i) {
+        const InstrumentState& inst = m_instruments[i];
+        InstrumentEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        strncpy(entry.instrument_id, inst.id.c_str(), sizeof(entry.instrument_id) - 1);
+        entry.price_tick = inst.price_tick;
+        entry.tick_count = inst.tick_count;
+        entry.first_block = first_block;
+        entry.block_count = (uint32_t)inst.blocks.size();
+        first_block += entry.block_count;
+        ok = write_all(&entry, sizeof(entry));
+    }
+    header.block_offset = m_offset;
+    for (size_t i = 0; ok && i < m_instruments.size(); ++i) {
+        const std::vector<BlockEntry>& blocks = m_instruments[i].blocks;
+        if (!blocks.empty()) ok = write_all(blocks.data(), blocks.size() * sizeof(BlockEntry));
+    }
+
+    if (ok) {
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.tick_size = sizeof(Tick);
+        header.trading_day = m_tradingDay;
+        header.instrument_count = (uint32_t)m_instruments.size();
+        header.block_ticks = (uint32_t)m_blockTicks;
+        header.tick_count = m_tickCount;
+        header.block_count = m_blockCount;
+        header.created_ns = TscClock::calibrated() ? TscClock::wall_ns() : 0;
+        if (pwrite(m_fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+            std::cerr << "[Columnar] Failed to write header: " << strerror(errno) << std::endl;
+            ok = false;
+        }
+    }
+    if (ok && fdatasync(m_fd) != 0) ok = false;
+
+    ::close(m_fd);
+    m_fd = -1;
+    if (!ok) std::cerr << "[Columnar] " << m_path << " is incomplete." << std::endl;
+    return ok;
+}
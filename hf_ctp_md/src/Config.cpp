@@ -0,0 +1,78 @@
+#include "Config.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+
+static std::string trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(start, end - start + 1);
+}
+
+static std::string make_key(const std::string& section, const std::string& key) {
+    return section + "." + key;
+}
+
+bool Config::load(const std::string& path) {
+    std::ifstream in(path.c_str());
+    if (!in) return false;
+    std::string line, section;
+    while (std::getline(in, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#' || line[0] == ';') continue;
+        if (line[0] == '[' && line[line.size() - 1] == ']') {
+            section = trim(line.substr(1, line.size() - 2));
+            continue;
+        }
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        m_values[make_key(section, trim(line.substr(0, eq)))] = trim(line.substr(eq + 1));
+    }
+    return true;
+}
+
+bool Config::has(const std::string& section, const std::string& key) const {
+    return m_values.find(make_key(section, key)) != m_values.end();
+}
+
+std::string Config::get_string(const std::string& section, const std::string& key, const std::string& def) const {
+    std::map<std::string, std::string>::const_iterator it = m_values.find(make_key(section, key));
+    return it == m_values.end() ? def : it->second;
+}
+
+long long Config::get_int(const std::string& section, const std::string& key, long long def) const {
+    std::map<std::string, std::string>::const_iterator it = m_values.find(make_key(section, key));
+    if (it == m_values.end() || it->second.empty()) return def;
+    return strtoll(it->second.c_str(), nullptr, 0);
+}
+
+double Config::get_double(const std::string& section, const std::string& key, double def) const {
+    std::map<std::string, std::string>::const_iterator it = m_values.find(make_key(section, key));
+    if (it == m_values.end() || it->second.empty()) return def;
+    return strtod(it->second.c_str(), nullptr);
+}
+
+bool Config::get_bool(const std::string& section, const std::string& key, bool def) const {
+    std::map<std::string, std::string>::const_iterator it = m_values.find(make_key(section, key));
+    if (it == m_values.end()) return def;
+    std::string v = it->second;
+    std::transform(v.begin(), v.end(), v.begin(), ::tolower);
+    if (v == "true" || v == "yes" || v == "on" || v == "1") return true;
+    if (v == "false" || v == "no" || v == "off" || v == "0") return false;
+    return def;
+}
+
+std::vector<std::string> Config::get_list(const std::string& section, const std::string& key) const {
+    std::vector<std::string> items;
+    const std::string val = get_string(section, key);
+    for (size_t i = 0; i < val.size(); ) {
+        size_t j = val.find(',', i);
+        if (j == std::string::npos) j = val.size();
+        std::string item = trim(val.substr(i, j - i));
+        if (!item.empty()) items.push_back(item);
+        i = j + 1;
+    }
+    return items;
+}
@@ -0,0 +1,158 @@
+#include "InstrumentRegistry.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+static const uintptr_t CACHELINE = 64;
+
+InstrumentRegistry::InstrumentRegistry()
+    : m_built(false), m_bucketShift(63), m_slotMask(0), m_slots(nullptr) {
+}
+
+uint16_t InstrumentRegistry::add(const char* instrument_id, double price_tick) {
+    std::unordered_map<std::string, uint16_t>::const_iterator it = m_index.find(instrument_id);
+    if (it != m_index.end()) return it->second;
+
+    if (strnlen(instrument_id, MAX_ID_LENGTH + 1) > MAX_ID_LENGTH) {
+        throw std::invalid_argument(std::string("instrument id too long: ") + instrument_id);
+    }
+    if (m_names.size() >= MAX_INSTRUMENTS) {
+        throw std::invalid_argument("too many instruments");
+    }
+
+    m_names.push_back(instrument_id);
+    m_priceTicks.push_back(price_tick);
+    m_invPriceTicks.push_back(1.0 / price_tick);
+    m_built = false;
+    const uint16_t id = (uint16_t)(m_names.size() - 1);
+    m_index[m_names.back()] = id;
+    return id;
+}
+
+uint16_t InstrumentRegistry::find_linear(const char* instrument_id) const {
+    for (size_t i = 0; i < m_names.size(); ++i) {
+        if (strcmp(m_names[i].c_str(), instrument_id) == 0) return (uint16_t)i;
+    }
+    return INVALID_ID;
+}
+
+// 按逗号切分一行 CSV，支持双引号包裹的字段 (合约名称里可能有逗号)
+static void split_csv(const std::string& line, std::vector<std::string>& fields) {
+    fields.clear();
+    std::string field;
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        const char c = line[i];
+        if (c == '"') {
+            quoted = !quoted;
+        } else if (c == ',' && !quoted) {
+            fields.push_back(field);
+            field.clear();
+        } else if (c != '\r' && c != '\n') {
+            field += c;
+        }
+    }
+    fields.push_back(field);
+}
+
+int InstrumentRegistry::load_csv(const char* path) {
+    std::ifstream in(path);
+    if (!in) return -1;
+
+    // 列号与 query_instruments 输出的表头一致
+    const size_t COL_INSTRUMENT_ID = 0;
+    const size_t COL_PRICE_TICK = 12;
+
+    std::string line;
+    std::vector<std::string> fields;
+    std::getline(in, line); // 表头
+    const size_t before = m_names.size();
+    while (std::getline(in, line)) {
+        split_csv(line, fields);
+        if (fields.size() <= COL_PRICE_TICK || fields[COL_INSTRUMENT_ID].empty()) continue;
+        const double price_tick = atof(fields[COL_PRICE_TICK].c_str());
+        add(fields[COL_INSTRUMENT_ID].c_str(), price_tick > 0 ? price_tick : 1.0);
+    }
+    return (int)(m_names.size() - before);
+}
+
+bool InstrumentRegistry::build() {
+    const size_t n = m_names.size();
+
+    // 桶数 ~ n/2，槽位数 >= 1.25n，均取 2 的幂次
+    size_t buckets = 2;
+    while (buckets < n / 2) buckets <<= 1;
+    size_t slots = 2;
+    while (slots < n + n / 4 + 1) slots <<= 1;
+
+    unsigned bucket_bits = 0;
+    while (((size_t)1 << bucket_bits) < buckets) ++bucket_bits;
+    m_bucketShift = 64 - bucket_bits;
+    m_slotMask = slots - 1;
+
+    std::vector<uint64_t> hashes(n);
+    std::vector<std::vector<uint16_t> > bucket_keys(buckets);
+    for (size_t i = 0; i < n; ++i) {
+        Key key;
+        make_key(m_names[i].c_str(), key);
+        hashes[i] = hash_key(key);
+        bucket_keys[hashes[i] >> m_bucketShift].push_back((uint16_t)i);
+    }
+
+    // 大桶优先放置，越往后空槽越少，小桶更容易找到位移
+    std::vector<size_t> order(buckets);
+    for (size_t b = 0; b < buckets; ++b) order[b] = b;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return bucket_keys[a].size() > bucket_keys[b].size();
+    });
+
+    Slot empty;
+    memset(&empty, 0, sizeof(empty));
+    empty.id = INVALID_ID;
+    // 多分配两个槽位，用于把起点对齐到缓存行
+    // 对齐后的起点不一定落在元素边界上，因此按对齐后的视图重新填充空槽位
+    m_slotStorage.resize(slots + 2);
+    const uintptr_t base = reinterpret_cast<uintptr_t>(m_slotStorage.data());
+    m_slots = reinterpret_cast<Slot*>((base + CACHELINE - 1) & ~(uintptr_t)(CACHELINE - 1));
+    for (size_t i = 0; i < slots; ++i) m_slots[i] = empty;
+    m_disp.assign(buckets, 0);
+    std::vector<char> occupied(slots, 0);
+    std::vector<size_t> placed;
+
+    const uint32_t MAX_DISP = 1u << 24;
+    for (size_t b : order) {
+        const std::vector<uint16_t>& keys = bucket_keys[b];
+        if (keys.empty()) break;
+
+        uint32_t disp = 0;
+        for (; disp < MAX_DISP; ++disp) {
+            placed.clear();
+            bool ok = true;
+            for (uint16_t id : keys) {
+                const size_t s = slot_index(hashes[id], disp);
+                if (occupied[s] || std::find(placed.begin(), placed.end(), s) != placed.end()) {
+                    ok = false;
+                    break;
+                }
+                placed.push_back(s);
+            }
+            if (ok) break;
+        }
+        if (disp == MAX_DISP) {
+            m_built = false;
+            return false;
+        }
+
+        m_disp[b] = disp;
+        for (size_t k = 0; k < keys.size(); ++k) {
+            occupied[placed[k]] = 1;
+            Slot& slot = m_slots[placed[k]];
+            memcpy(slot.key, m_names[keys[k]].c_str(), m_names[keys[k]].size());
+            slot.id = keys[k];
+        }
+    }
+
+    m_built = true;
+    return true;
+}
@@ -0,0 +1,231 @@
+#include "JournalIndex.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+using namespace journal;
+
+static bool entry_less(const IndexEntry& a, const IndexEntry& b) {
+    if (a.instrument_id != b.instrument_id) return a.instrument_id < b.instrument_id;
+    return a.bucket_start_ns < b.bucket_start_ns;
+}
+
+// === JournalIndexBuilder ===
+
+JournalIndexBuilder::JournalIndexBuilder(int64_t bucket_ns) : m_bucketNs(DEFAULT_BUCKET_NS) {
+    set_bucket_ns(bucket_ns);
+}
+
+void JournalIndexBuilder::set_bucket_ns(int64_t bucket_ns) {
+    m_bucketNs = bucket_ns > 0 ? bucket_ns : DEFAULT_BUCKET_NS;
+}
+
+void JournalIndexBuilder::add(const Tick& tick, uint64_t offset) {
+    if (tick.instrument_id >= m_entries.size()) m_entries.resize((size_t)tick.instrument_id + 1);
+    std::vector<IndexEntry>& entries = m_entries[tick.instrument_id];
+    const int64_t bucket = bucket_start(tick.exchange_ts_ns, m_bucketNs);
+
+    // 绝大多数情况落在最后一个桶或开启新桶；交易所时间偶尔回退时向前找已有的桶
+    if (!entries.empty() && bucket <= entries.back().bucket_start_ns) {
+        for (size_t i = entries.size(); i-- > 0; ) {
+            if (entries[i].bucket_start_ns == bucket) {
+                entries[i].last_offset = offset;
+                entries[i].count++;
+                return;
+            }
+            if (entries[i].bucket_start_ns < bucket) break;
+        }
+    }
+
+    IndexEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.instrument_id = tick.instrument_id;
+    entry.count = 1;
+    entry.bucket_start_ns = bucket;
+    entry.first_offset = offset;
+    entry.last_offset = offset;
+    entries.push_back(entry);
+}
+
+size_t JournalIndexBuilder::entry_count() const {
+    size_t n = 0;
+    for (size_t i = 0; i < m_entries.size(); ++i) n += m_entries[i].size();
+    return n;
+}
+
+void JournalIndexBuilder::clear() {
+    m_entries.clear();
+}
+
+void JournalIndexBuilder::take_entries(std::vector<IndexEntry>& out) {
+    out.clear();
+    out.reserve(entry_count());
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        std::vector<IndexEntry>& entries = m_entries[i];
+        if (!std::is_sorted(entries.begin(), entries.end(), entry_less)) {
+            std::sort(entries.begin(), entries.end(), entry_less);
+        }
+        out.insert(out.end(), entries.begin(), entries.end());
+    }
+    m_entries.clear();
+}
+
+bool JournalIndexBuilder::write(const std::string& path, size_t instrument_count, uint64_t journal_size) {
+    std::vector<IndexEntry> entries;
+    take_entries(entries);
+
+    IndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = INDEX_VERSION;
+    header.instrument_count = (uint32_t)instrument_count;
+    header.bucket_ns = m_bucketNs;
+    header.entry_count = entries.size();
+    header.journal_size = journal_size;
+
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (!fp) {
+        std::cerr << "[Index] Failed to open " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    if (ok && !entries.empty()) {
+        ok = fwrite(entries.data(), sizeof(IndexEntry), entries.size(), fp) == entries.size();
+    }
+    ok = fclose(fp) == 0 && ok;
+    if (!ok) std::cerr << "[Index] Failed to write " << path << std::endl;
+    return ok;
+}
+
+bool JournalIndexBuilder::build(const std::string& journal_path, int64_t bucket_ns) {
+    JournalReader reader;
+    if (!reader.open(journal_path)) return false;
+
+    JournalIndexBuilder builder(bucket_ns);
+    Tick tick;
+    while (reader.next(tick)) {
+        builder.add(tick, reader.record_offset());
+    }
+    return builder.write(journal_path + ".idx", reader.instrument_count(), reader.size());
+}
+
+// === TickCursor ===
+
+TickCursor::TickCursor(const JournalReader* pReader, const IndexEntry* first, const IndexEntry* last,
+                       uint16_t instrument_id, int64_t bucket_ns, int64_t from_ns, int64_t to_ns)
+    : m_pReader(pReader), m_entry(first), m_last(last), m_bucketNs(bucket_ns), m_fromNs(from_ns), m_toNs(to_ns),
+      m_instrumentId(instrument_id), m_bucket(0), m_offset(1), m_end(0), m_scanned(0) {
+}
+
+bool TickCursor::next(Tick& out) {
+    for (;;) {
+        if (m_offset > m_end) {
+            if (m_entry == m_last) return false;
+            m_bucket = m_entry->bucket_start_ns;
+            m_offset = m_entry->first_offset;
+            m_end = m_entry->last_offset;
+            ++m_entry;
+        }
+
+        const RecordHeader* rh = m_pReader->record_at((size_t)m_offset);
+        if (!rh) {
+            m_offset = m_end + 1;
+            continue;
+        }
+        m_offset += sizeof(RecordHeader) + rh->length;
+        m_scanned++;
+        if (rh->type != RECORD_TICK || rh->length != sizeof(Tick)) continue;
+
+        // 先只读合约 id 和时间，不匹配的记录不做整条拷贝
+        // 同一条记录只在它所属的桶里返回，桶之间偏移区间重叠时不会重复
+        const char* payload = reinterpret_cast<const char*>(rh) + sizeof(RecordHeader);
+        uint16_t id;
+        memcpy(&id, payload + offsetof(Tick, instrument_id), sizeof(id));
+        if (id != m_instrumentId) continue;
+        int64_t ts;
+        memcpy(&ts, payload + offsetof(Tick, exchange_ts_ns), sizeof(ts));
+        if (ts < m_fromNs || ts >= m_toNs || bucket_start(ts, m_bucketNs) != m_bucket) continue;
+
+        memcpy(&out, payload, sizeof(Tick));
+        return true;
+    }
+}
+
+// === JournalIndex ===
+
+JournalIndex::JournalIndex() : m_bucketNs(JournalIndexBuilder::DEFAULT_BUCKET_NS), m_loaded(false) {
+}
+
+bool JournalIndex::load(const std::string& index_path) {
+    FILE* fp = fopen(index_path.c_str(), "rb");
+    if (!fp) return false;
+
+    IndexHeader header;
+    bool ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+              memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+              header.version == INDEX_VERSION &&
+              header.bucket_ns > 0 &&
+              header.journal_size == m_reader.size() &&
+              header.instrument_count == m_reader.instrument_count();
+    if (ok) {
+        m_entries.resize(header.entry_count);
+        ok = header.entry_count == 0 ||
+             fread(m_entries.data(), sizeof(IndexEntry), m_entries.size(), fp) == m_entries.size();
+    }
+    fclose(fp);
+    if (!ok) {
+        m_entries.clear();
+        std::cerr << "[Index] " << index_path << " is stale or corrupt, rebuilding." << std::endl;
+        return false;
+    }
+    m_bucketNs = header.bucket_ns;
+    return true;
+}
+
+bool JournalIndex::open(const std::string& journal_path, int64_t bucket_ns) {
+    m_entries.clear();
+    if (!m_reader.open(journal_path)) return false;
+
+    m_loaded = load(journal_path + ".idx");
+    if (!m_loaded) {
+        JournalIndexBuilder builder(bucket_ns);
+        Tick tick;
+        while (m_reader.next(tick)) {
+            builder.add(tick, m_reader.record_offset());
+        }
+        m_bucketNs = builder.bucket_ns();
+        builder.take_entries(m_entries);
+    }
+
+    // 之后只按索引随机读取
+    m_reader.rewind();
+    m_reader.advise_random();
+    return true;
+}
+
+TickCursor JournalIndex::query(uint16_t instrument_id, int64_t from_ns, int64_t to_ns) const {
+    const IndexEntry* begin = m_entries.data();
+    const IndexEntry* end = begin + m_entries.size();
+    if (to_ns <= from_ns) return TickCursor(&m_reader, end, end, instrument_id, m_bucketNs, from_ns, to_ns);
+
+    IndexEntry key;
+    memset(&key, 0, sizeof(key));
+    key.instrument_id = instrument_id;
+    key.bucket_start_ns = bucket_start(from_ns, m_bucketNs);
+    const IndexEntry* first = std::lower_bound(begin, end, key, entry_less);
+    key.bucket_start_ns = bucket_start(to_ns - 1, m_bucketNs) + 1;
+    const IndexEntry* last = std::lower_bound(first, end, key, entry_less);
+    return TickCursor(&m_reader, first, last, instrument_id, m_bucketNs, from_ns, to_ns);
+}
+
+uint16_t JournalIndex::find_instrument(const char* instrument_id) const {
+    for (size_t i = 0; i < m_reader.instrument_count(); ++i) {
+        if (strncmp(m_reader.instrument_id(i), instrument_id, sizeof(InstrumentEntry::instrument_id)) == 0) {
+            return (uint16_t)i;
+        }
+    }
+    return 0xFFFF;
+}
@@ -0,0 +1,114 @@
+#include "JournalReader.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace journal;
+
+JournalReader::JournalReader()
+    : m_fd(-1), m_base(nullptr), m_size(0), m_offset(0), m_recordOffset(0), m_window(DEFAULT_WINDOW_SIZE),
+      m_adviseMark(0), m_releasedUpTo(0), m_header(nullptr), m_instruments(nullptr) {
+}
+
+JournalReader::~JournalReader() {
+    close();
+}
+
+bool JournalReader::open(const std::string& path, size_t window_size) {
+    close();
+
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+        std::cerr << "[Replay] Failed to open " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(m_fd, &st) != 0 || (size_t)st.st_size < sizeof(FileHeader)) {
+        std::cerr << "[Replay] " << path << " is too small to be a journal." << std::endl;
+        close();
+        return false;
+    }
+    m_size = (size_t)st.st_size;
+
+    void* base = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (base == MAP_FAILED) {
+        std::cerr << "[Replay] mmap failed: " << strerror(errno) << std::endl;
+        m_base = nullptr;
+        close();
+        return false;
+    }
+    m_base = static_cast<const char*>(base);
+    madvise(base, m_size, MADV_SEQUENTIAL);
+
+    m_header = reinterpret_cast<const FileHeader*>(m_base);
+    const char* error = nullptr;
+    if (memcmp(m_header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "bad magic";
+    } else if (m_header->version != VERSION) {
+        error = "unsupported version";
+    } else if (m_header->tick_size != sizeof(Tick)) {
+        error = "Tick layout differs from this build";
+    } else if (m_header->header_size > m_size ||
+               sizeof(FileHeader) + (size_t)m_header->instrument_count * sizeof(InstrumentEntry) > m_header->header_size) {
+        error = "corrupt header";
+    }
+    if (error) {
+        std::cerr << "[Replay] " << path << ": " << error << std::endl;
+        close();
+        return false;
+    }
+
+    m_instruments = reinterpret_cast<const InstrumentEntry*>(m_base + sizeof(FileHeader));
+    const long page = sysconf(_SC_PAGESIZE);
+    m_window = window_size < (size_t)page ? (size_t)page : window_size;
+    rewind();
+    return true;
+}
+
+void JournalReader::close() {
+    if (m_base) munmap(const_cast<char*>(m_base), m_size);
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = -1;
+    m_base = nullptr;
+    m_size = 0;
+    m_offset = 0;
+    m_header = nullptr;
+    m_instruments = nullptr;
+}
+
+void JournalReader::rewind() {
+    m_offset = m_header->header_size;
+    m_recordOffset = m_offset;
+    m_releasedUpTo = 0;
+    m_adviseMark = m_offset;
+    advise();
+}
+
+// 每走过半个窗口调整一次：预读游标之后一个窗口，回收游标之前一个窗口以外的页面
+void JournalReader::advise() {
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t cursor = m_offset & ~(page - 1);
+
+    const size_t ahead_end = cursor + m_window < m_size ? cursor + m_window : m_size;
+    if (ahead_end > cursor) {
+        madvise(const_cast<char*>(m_base) + cursor, ahead_end - cursor, MADV_WILLNEED);
+    }
+
+    if (cursor > m_window) {
+        const size_t release_end = (cursor - m_window) & ~(page - 1);
+        if (release_end > m_releasedUpTo) {
+            madvise(const_cast<char*>(m_base) + m_releasedUpTo, release_end - m_releasedUpTo, MADV_DONTNEED);
+            m_releasedUpTo = release_end;
+        }
+    }
+    m_adviseMark = m_offset + m_window / 2;
+}
+
+void JournalReader::advise_random() {
+    madvise(const_cast<char*>(m_base), m_size, MADV_RANDOM);
+    m_adviseMark = (size_t)-1;
+}
@@ -0,0 +1,140 @@
+#include "JournalReplayer.h"
+#include "TscClock.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <immintrin.h> // _mm_pause
+
+JournalReplayer::JournalReplayer(JournalReader* pReader, SPSCQueue<Tick>* pQueue)
+    : m_pReader(pReader), m_pQueue(pQueue), m_pSnapshots(nullptr), m_running(false), m_done(false),
+      m_replayed(0), m_skipped(0), m_instrumentCount(0), m_speed(0), m_cpuId(-1), m_restamp(true) {
+}
+
+JournalReplayer::~JournalReplayer() {
+    stop();
+}
+
+void JournalReplayer::set_shards(const ShardMap& map, const std::vector<SPSCQueue<Tick>*>& queues,
+                                 const std::vector<SnapshotTable<Tick>*>& snapshots) {
+    m_shardQueues.resize(map.instrument_count());
+    m_shardSnapshots.resize(map.instrument_count());
+    for (size_t id = 0; id < map.instrument_count(); ++id) {
+        m_shardQueues[id] = queues[map.shard_of((uint16_t)id)];
+        m_shardSnapshots[id] = snapshots.empty() ? nullptr : snapshots[map.shard_of((uint16_t)id)];
+    }
+}
+
+void JournalReplayer::set_speed(double speed) {
+    m_speed = speed > 0 ? speed : 0;
+}
+
+void JournalReplayer::set_cpu_affinity(int cpu_id) {
+    m_cpuId = cpu_id;
+}
+
+void JournalReplayer::set_restamp(bool restamp) {
+    m_restamp = restamp;
+}
+
+void JournalReplayer::set_snapshot_table(SnapshotTable<Tick>* pSnapshots) {
+    m_pSnapshots = pSnapshots;
+}
+
+void JournalReplayer::start() {
+    if (m_running) return;
+    m_running = true;
+    m_done = false;
+    m_instrumentCount = m_pReader->instrument_count();
+    m_thread = std::thread(&JournalReplayer::run, this);
+}
+
+void JournalReplayer::stop() {
+    m_running = false;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+inline bool JournalReplayer::push(const Tick& tick) {
+    SPSCQueue<Tick>* pQueue = m_pQueue;
+    SnapshotTable<Tick>* pSnapshots = m_pSnapshots;
+    if (!m_shardQueues.empty()) {
+        pQueue = m_shardQueues[tick.instrument_id];
+        pSnapshots = m_shardSnapshots[tick.instrument_id];
+    }
+    if (pSnapshots) {
+        Tick* slot = pSnapshots->begin_write(tick.instrument_id);
+        *slot = tick;
+        pSnapshots->end_write(tick.instrument_id);
+    }
+
+    // 队列满时等消费者腾出槽位，回放不允许丢数据 (分片时整个回放等最慢的分片)
+    Tick* slot = pQueue->claim();
+    while (__builtin_expect(!slot, 0)) {
+        if (!m_running.load(std::memory_order_relaxed)) return false;
+        _mm_pause();
+        slot = pQueue->claim();
+    }
+    *slot = tick;
+    pQueue->commit();
+    return true;
+}
+
+void JournalReplayer::run() {
+    if (m_cpuId >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(m_cpuId, &cpuset);
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+        std::cout << "[Replay] Replayer pinned to core " << m_cpuId << ": "
+                  << (rc == 0 ? "OK" : strerror(rc)) << std::endl;
+    }
+
+    Tick tick;
+    uint64_t replayed = 0, skipped = 0;
+    bool first = true;
+    int64_t first_receive_ns = 0; // 文件中第一条记录的接收时间
+    uint64_t start_tsc = 0;       // 回放开始时刻
+    const double inv_speed = m_speed > 0 ? 1.0 / m_speed : 0;
+    const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    while (m_running.load(std::memory_order_relaxed) && m_pReader->next(tick)) {
+        // 合约 id 同时用作分片表、快照表的下标，越界的记录不能进入引擎
+        if (__builtin_expect(tick.instrument_id >= m_instrumentCount, 0)) {
+            m_skipped.store(++skipped, std::memory_order_relaxed);
+            continue;
+        }
+        if (inv_speed > 0) {
+            if (first) {
+                first_receive_ns = tick.receive_ns;
+                start_tsc = TscClock::now();
+                first = false;
+            }
+            // 目标时刻 = 回放开始 + 记录时的相对接收时间 / 倍速
+            const int64_t due_ns = (int64_t)((double)(tick.receive_ns - first_receive_ns) * inv_speed);
+            for (;;) {
+                const int64_t now_ns = TscClock::to_ns((int64_t)(TscClock::now() - start_tsc));
+                if (now_ns >= due_ns) break;
+                // 离下一条较远时让出 CPU，临近时忙等以保证间隔准确
+                if (due_ns - now_ns > 200000) {
+                    std::this_thread::sleep_for(std::chrono::microseconds((due_ns - now_ns - 100000) / 1000));
+                    if (!m_running.load(std::memory_order_relaxed)) break;
+                } else {
+                    _mm_pause();
+                }
+            }
+        }
+
+        if (m_restamp) tick.receive_ns = TscClock::wall_ns();
+        if (!push(tick)) break;
+        m_replayed.store(++replayed, std::memory_order_relaxed);
+    }
+
+    const int64_t elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "[Replay] Replayed " << replayed << " ticks in " << elapsed_ms << " ms ("
+              << (elapsed_ms > 0 ? replayed * 1000 / (uint64_t)elapsed_ms : replayed) << " ticks/s)";
+    if (skipped > 0) std::cout << ", skipped " << skipped << " records with unknown instrument id";
+    std::cout << "." << std::endl;
+    m_done.store(true, std::memory_order_release);
+}
@@ -3,20 +3,18 @@
 #include <iomanip>
 #include <chrono>
 #include <pthread.h>
-#include <immintrin.h> // _mm_pause
+#include <sched.h>
+#include <sys/mman.h>
+#include <cerrno>
+#include <cstring>
 #include <vector>
-#include <numeric>
-#include <algorithm>
 
-// RDTSC 辅助函数
-static inline uint64_t rdtsc() {
-    unsigned int lo, hi;
-    __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
-    return ((uint64_t)hi << 32) | lo;
-}
-
-MarketDataEngine::MarketDataEngine(SPSCQueue<MdData>* pQueue)
-    : m_pQueue(pQueue), m_running(false), m_cpu_id(-1) {
+MarketDataEngine::MarketDataEngine(SPSCQueue<Tick>* pQueue)
+    : m_pQueue(pQueue), m_running(false), m_ready(false), m_batch_size(DEFAULT_BATCH_SIZE),
+      m_pDrops(nullptr), m_pRegistry(nullptr), m_pSnapshots(nullptr), m_pRecorder(nullptr), m_pBus(nullptr),
+      m_pUdp(nullptr), m_pArbiter(nullptr), m_pBook(nullptr), m_pBars(nullptr),
+      m_pIndicators(nullptr), m_indicator_batch(false),
+      m_report_interval_ms(DEFAULT_REPORT_INTERVAL_MS), m_tick_count(0), m_snapshot_count(0) {
 }
 
 MarketDataEngine::~MarketDataEngine() {
@@ -26,7 +24,12 @@ MarketDataEngine::~MarketDataEngine() {
 void MarketDataEngine::start() {
     if (m_running) return;
     m_running = true;
+    m_ready = false;
     m_thread = std::thread(&MarketDataEngine::run, this);
+    while (!m_ready) {
+        std::this_thread::yield();
+    }
+    m_reporter = std::thread(&MarketDataEngine::report_loop, this);
 }
 
 void MarketDataEngine::stop() {
@@ -35,53 +38,266 @@ void MarketDataEngine::stop() {
     if (m_thread.joinable()) {
         m_thread.join();
     }
+    if (m_reporter.joinable()) {
+        m_reporter.join();
+    }
 }
 
 void MarketDataEngine::set_cpu_affinity(int cpu_id) {
-    m_cpu_id = cpu_id;
+    m_thread_cfg.cpu_id = cpu_id;
+}
+
+void MarketDataEngine::set_thread_config(const EngineThreadConfig& config) {
+    m_thread_cfg = config;
+}
+
+void MarketDataEngine::set_batch_size(size_t batch_size) {
+    m_batch_size = batch_size > 0 ? batch_size : 1;
+}
+
+void MarketDataEngine::set_drop_counters(const DropCounters* pDrops, const InstrumentRegistry* pRegistry) {
+    m_pDrops = pDrops;
+    m_pRegistry = pRegistry;
+}
+
+void MarketDataEngine::set_snapshot_table(SnapshotTable<Tick>* pSnapshots) {
+    m_pSnapshots = pSnapshots;
+}
+
+void MarketDataEngine::set_recorder(TickRecorder* pRecorder) {
+    m_pRecorder.store(pRecorder, std::memory_order_release);
+}
+
+void MarketDataEngine::set_bus(ShmBusWriter* pBus) {
+    m_pBus = pBus;
+}
+
+void MarketDataEngine::set_udp_publisher(UdpPublisher* pUdp) {
+    m_pUdp = pUdp;
+}
+
+void MarketDataEngine::set_feed_arbiter(const FeedArbiter* pArbiter) {
+    m_pArbiter = pArbiter;
+}
+
+void MarketDataEngine::set_order_book(OrderBookTable* pBook) {
+    m_pBook = pBook;
+}
+
+void MarketDataEngine::set_bar_aggregator(BarAggregator* pBars) {
+    m_pBars = pBars;
+}
+
+void MarketDataEngine::set_indicators(IndicatorTable* pIndicators, bool batch) {
+    m_pIndicators = pIndicators;
+    m_indicator_batch = batch;
+}
+
+void MarketDataEngine::set_shard(size_t index) {
+    m_tag = "#" + std::to_string(index);
+}
+
+void MarketDataEngine::set_report_interval_ms(unsigned interval_ms) {
+    m_report_interval_ms = interval_ms > 0 ? interval_ms : DEFAULT_REPORT_INTERVAL_MS;
+}
+
+void MarketDataEngine::report_drops(std::vector<uint64_t>& last_drops) {
+    for (size_t id = 0; id < m_pDrops->size(); ++id) {
+        const DropCounters::Counters& c = m_pDrops->at(id);
+        const uint64_t dropped = c.dropped.load(std::memory_order_relaxed);
+        const uint64_t overwritten = c.overwritten.load(std::memory_order_relaxed);
+        const uint64_t conflated = c.conflated.load(std::memory_order_relaxed);
+        const uint64_t total = dropped + overwritten + conflated;
+        if (total == last_drops[id]) continue;
+
+        const char* name = (m_pRegistry && id < m_pRegistry->size()) ? m_pRegistry->name((uint16_t)id) : "<unknown>";
+        std::cout << "[Strategy" << m_tag << "] Drops " << name
+                  << " +" << (total - last_drops[id])
+                  << " (dropped:" << dropped
+                  << " overwritten:" << overwritten
+                  << " conflated:" << conflated << ")" << std::endl;
+        last_drops[id] = total;
+    }
+}
+
+void MarketDataEngine::report_fronts(std::vector<uint64_t>& last, const char* label) {
+    const size_t n = m_pArbiter->front_count();
+    std::vector<uint64_t> now(n * 5);
+    uint64_t won_total = 0, unknown_total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const FeedArbiter::FrontStats& s = m_pArbiter->stats(i);
+        now[i * 5 + 0] = s.won.load(std::memory_order_relaxed);
+        now[i * 5 + 1] = s.duplicate.load(std::memory_order_relaxed);
+        now[i * 5 + 2] = s.stale.load(std::memory_order_relaxed);
+        now[i * 5 + 3] = s.behind_ns.load(std::memory_order_relaxed);
+        now[i * 5 + 4] = s.unknown.load(std::memory_order_relaxed);
+        won_total += now[i * 5] - last[i * 5];
+        unknown_total += now[i * 5 + 4] - last[i * 5 + 4];
+    }
+    if (won_total == 0 && unknown_total == 0) return;
+
+    for (size_t i = 0; i < n; ++i) {
+        const uint64_t won = now[i * 5 + 0] - last[i * 5 + 0];
+        const uint64_t duplicate = now[i * 5 + 1] - last[i * 5 + 1];
+        const uint64_t stale = now[i * 5 + 2] - last[i * 5 + 2];
+        const uint64_t behind = now[i * 5 + 3] - last[i * 5 + 3];
+        const uint64_t unknown = now[i * 5 + 4] - last[i * 5 + 4];
+        std::cout << "[Strategy" << m_tag << "] " << label << " front " << i
+                  << (m_pArbiter->stats(i).connected.load(std::memory_order_relaxed) ? "" : " (disconnected)")
+                  << ": won " << won << " (" << std::fixed << std::setprecision(1)
+                  << (won_total ? 100.0 * won / won_total : 0.0)
+                  << "%), duplicate " << duplicate << " (behind avg " << (duplicate ? behind / duplicate : 0)
+                  << " ns), stale " << stale << ", unknown instrument " << unknown << std::defaultfloat << std::endl;
+    }
+    last.swap(now);
+}
+
+// 在引擎线程内执行：绑核 -> 实时调度 -> 锁内存 -> 预热缓冲区
+// 每一步失败都只打印原因并继续，不影响行情处理
+void MarketDataEngine::setup_thread() {
+    const EngineThreadConfig& cfg = m_thread_cfg;
+
+    if (cfg.cpu_id >= 0) {
+        // 核心不存在时 pthread_setaffinity_np 返回 EINVAL
+        int rc = EINVAL;
+        if (cfg.cpu_id < CPU_SETSIZE) {
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            CPU_SET(cfg.cpu_id, &cpuset);
+            rc = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+        }
+        std::cout << "[StrategyThread" << m_tag << "] CPU affinity -> core " << cfg.cpu_id << ": "
+                  << (rc == 0 ? "OK" : strerror(rc)) << std::endl;
+    } else {
+        std::cout << "[StrategyThread" << m_tag << "] CPU affinity: disabled" << std::endl;
+    }
+
+    if (cfg.rt_priority > 0) {
+        sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = cfg.rt_priority;
+        int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        std::cout << "[StrategyThread" << m_tag << "] SCHED_FIFO priority " << cfg.rt_priority << ": "
+                  << (rc == 0 ? "OK" : strerror(rc)) << std::endl;
+    } else {
+        std::cout << "[StrategyThread" << m_tag << "] SCHED_FIFO: disabled" << std::endl;
+    }
+
+    if (cfg.lock_memory) {
+        // 进程级：锁住已映射和之后映射的全部页面，包括 CTP 网络线程使用的内存
+        int rc = mlockall(MCL_CURRENT | MCL_FUTURE) == 0 ? 0 : errno;
+        std::cout << "[StrategyThread" << m_tag << "] mlockall: "
+                  << (rc == 0 ? "OK" : strerror(rc)) << std::endl;
+    } else {
+        std::cout << "[StrategyThread" << m_tag << "] mlockall: disabled" << std::endl;
+    }
+
+    if (cfg.prefault) {
+        // 此时 start() 仍在等待，CTP API 尚未创建，队列上没有生产者
+        // 延迟直方图在构造时已逐项清零，页面已经映射
+        m_pQueue->prefault();
+        std::cout << "[StrategyThread" << m_tag << "] Prefault: ring "
+                  << (m_pQueue->capacity() * sizeof(Tick)) / 1024 << " KB, histogram "
+                  << sizeof(LatencyHistogram) / 1024 << " KB";
+        TickRecorder* pRecorder = m_pRecorder.load(std::memory_order_acquire);
+        if (pRecorder) {
+            pRecorder->prefault();
+            std::cout << ", recorder ring " << pRecorder->ring_bytes() / 1024 << " KB";
+        }
+        if (m_pUdp) {
+            m_pUdp->prefault();
+            std::cout << ", udp ring " << m_pUdp->ring_bytes() / 1024 << " KB";
+        }
+        std::cout << " OK" << std::endl;
+    } else {
+        std::cout << "[StrategyThread" << m_tag << "] Prefault: disabled" << std::endl;
+    }
 }
 
 void MarketDataEngine::run() {
+    NullTickHandler handler;
+    poll_loop(handler);
+}
 
-    std::cout << "[StrategyThread] Engine started. Polling queue..." << std::endl;
+void MarketDataEngine::thread_begin() {
+    setup_thread();
+    m_ready = true;
+    std::cout << "[StrategyThread" << m_tag << "] Engine started. Polling queue..." << std::endl;
+}
+
+void MarketDataEngine::thread_end(uint64_t count, uint64_t book_ticks, uint64_t book_deltas) {
+    std::cout << "[StrategyThread" << m_tag << "] Engine stopped. Processed " << count << " ticks." << std::endl;
+    if (m_pBook) {
+        std::cout << "[StrategyThread" << m_tag << "] Order book changed on " << book_ticks << " ticks, "
+                  << book_deltas << " level deltas (" << std::fixed << std::setprecision(2)
+                  << (book_ticks ? (double)book_deltas / book_ticks : 0.0) << " per change)" << std::defaultfloat
+                  << std::endl;
+    }
+    if (m_pBars) {
+        std::cout << "[StrategyThread" << m_tag << "] Bars: " << m_pBars->bar_count() << " closed, "
+                  << m_pBars->late_count() << " late ticks" << std::endl;
+    }
+}
 
-    MdData md;
-    long long count = 0;
-    
-    // 统计缓存
-    const int STAT_BATCH = 100; // 每100个包统计一次
-    std::vector<uint64_t> latency_samples;
-    latency_samples.reserve(STAT_BATCH);
+// 报告线程：周期性对直方图做快照，与上一次快照相减得到区间分布后打印
+// 所有 I/O 和排版都在这里，引擎线程只做 O(1) 的计数
+void MarketDataEngine::report_loop() {
+    HistogramSnapshot last, current, interval;
+    std::vector<uint64_t> last_drops(m_pDrops ? m_pDrops->size() : 0, 0);
+    uint64_t last_recorder_drops = 0;
+    uint64_t last_udp_drops = 0;
+    std::vector<uint64_t> last_fronts(m_pArbiter ? m_pArbiter->front_count() * 5 : 0, 0);
+    const unsigned STEP_MS = 100; // 分段睡眠，stop() 时尽快退出
 
+    unsigned elapsed_ms = 0;
     while (m_running) {
-        if (m_pQueue->pop(md)) {
-            // === 关键路径：无IO ===
-            
-            uint64_t process_tsc = rdtsc();
-            uint64_t latency_cycles = process_tsc - md.receive_tsc;
-            
-            // 仅收集数据，不打印
-            latency_samples.push_back(latency_cycles);
-            count++;
-
-            // 批量统计打印 (不在关键路径上频繁做)
-            if (latency_samples.size() >= STAT_BATCH) {
-                uint64_t sum = std::accumulate(latency_samples.begin(), latency_samples.end(), 0ULL);
-                uint64_t min = *std::min_element(latency_samples.begin(), latency_samples.end());
-                uint64_t max = *std::max_element(latency_samples.begin(), latency_samples.end());
-                double avg = (double)sum / STAT_BATCH;
-
-                std::cout << "[Strategy] Processed " << count << " ticks. "
-                          << "Latency(Cycles) Min:" << min 
-                          << " Max:" << max 
-                          << " Avg:" << avg << std::endl;
-                
-                latency_samples.clear();
-            }
-        } else {
-            _mm_pause(); 
+        std::this_thread::sleep_for(std::chrono::milliseconds(STEP_MS));
+        elapsed_ms += STEP_MS;
+        if (elapsed_ms < m_report_interval_ms) continue;
+        elapsed_ms = 0;
+
+        m_latency.snapshot(current);
+        interval = current;
+        interval.subtract(last);
+        last = current;
+
+        if (interval.total > 0) {
+            std::cout << "[Strategy" << m_tag << "] Processed " << m_tick_count.load(std::memory_order_relaxed) << " ticks (+"
+                      << interval.total << "), "
+                      << m_snapshot_count.load(std::memory_order_relaxed) << " snapshots. "
+                      << "Latency(ns) P50:" << interval.percentile(0.50)
+                      << " P90:" << interval.percentile(0.90)
+                      << " P99:" << interval.percentile(0.99)
+                      << " P99.9:" << interval.percentile(0.999)
+                      << " Max:" << interval.max
+                      << " Avg:" << std::fixed << std::setprecision(1) << interval.mean()
+                      << std::defaultfloat << std::endl;
+        }
+        if (m_pDrops) report_drops(last_drops);
+        TickRecorder* pRecorder = m_pRecorder.load(std::memory_order_acquire);
+        if (pRecorder && pRecorder->dropped() != last_recorder_drops) {
+            last_recorder_drops = pRecorder->dropped();
+            std::cout << "[Strategy" << m_tag << "] Recorder dropped " << last_recorder_drops << " ticks ("
+                      << (pRecorder->failed() ? "write failed" : "ring full") << ")." << std::endl;
         }
+        if (m_pUdp && m_pUdp->dropped() != last_udp_drops) {
+            last_udp_drops = m_pUdp->dropped();
+            std::cout << "[Strategy" << m_tag << "] Udp publisher dropped " << last_udp_drops << " ticks (ring full)." << std::endl;
+        }
+        if (m_pArbiter) report_fronts(last_fronts, "Interval");
+    }
+
+    // 退出时打印全程累计分布
+    m_latency.snapshot(current);
+    if (current.total > 0) {
+        std::cout << "[Strategy" << m_tag << "] Total " << current.total << " ticks. "
+                  << "Latency(ns) P50:" << current.percentile(0.50)
+                  << " P99:" << current.percentile(0.99)
+                  << " P99.9:" << current.percentile(0.999)
+                  << " Max:" << current.max << std::endl;
+    }
+    if (m_pArbiter) {
+        last_fronts.assign(last_fronts.size(), 0);
+        report_fronts(last_fronts, "Total");
     }
-    
-    std::cout << "[StrategyThread] Engine stopped. Processed " << count << " ticks." << std::endl;
 }
@@ -0,0 +1,309 @@
+#include "MockMdApi.h"
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <pthread.h>
+#include <immintrin.h> // _mm_pause
+
+// 时间轴用 CLOCK_REALTIME：同一进程内的多个模拟前置按同一交易所时间对齐
+static inline int64_t realtime_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// xorshift64*：确定性的伪随机序列
+static inline uint64_t next_random(uint64_t& state) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+MockMdApi::MockMdApi(const MockMdConfig& config)
+    : m_config(config), m_pSpi(nullptr), m_running(false), m_sent(0), m_hasRequests(false),
+      m_loggedIn(false), m_generated(0), m_cursor(0), m_updateMillisec(0) {
+    if (m_config.burst == 0) m_config.burst = 1;
+    if (m_config.seed == 0) m_config.seed = 1;
+    memset(m_updateTime, 0, sizeof(m_updateTime));
+    memset(m_actionDay, 0, sizeof(m_actionDay));
+}
+
+MockMdApi::~MockMdApi() {
+}
+
+void MockMdApi::SetPriceTick(const char* instrument_id, double price_tick) {
+    m_priceTicks.push_back(std::make_pair(std::string(instrument_id), price_tick > 0 ? price_tick : 1.0));
+}
+
+void MockMdApi::Release() {
+    m_running = false;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    std::cout << "[MockMd] Released. Sent " << SentCount() << " ticks." << std::endl;
+    delete this;
+}
+
+void MockMdApi::Init() {
+    if (m_running) return;
+    m_running = true;
+    m_thread = std::thread(&MockMdApi::run, this);
+}
+
+int MockMdApi::Join() {
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    return 0;
+}
+
+const char* MockMdApi::GetTradingDay() {
+    return m_config.trading_day.c_str();
+}
+
+void MockMdApi::RegisterFront(char* pszFrontAddress) {
+    std::cout << "[MockMd] Ignoring front " << (pszFrontAddress ? pszFrontAddress : "") << std::endl;
+}
+
+void MockMdApi::RegisterNameServer(char*) {
+}
+
+void MockMdApi::RegisterFensUserInfo(CThostFtdcFensUserInfoField*) {
+}
+
+void MockMdApi::RegisterSpi(CThostFtdcMdSpi* pSpi) {
+    m_pSpi.store(pSpi, std::memory_order_release);
+}
+
+void MockMdApi::post(const std::function<void()>& request) {
+    std::lock_guard<std::mutex> lock(m_requestMutex);
+    m_requests.push_back(request);
+    m_hasRequests.store(true, std::memory_order_release);
+}
+
+void MockMdApi::drain_requests() {
+    std::vector<std::function<void()> > requests;
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        requests.swap(m_requests);
+        m_hasRequests.store(false, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < requests.size(); ++i) requests[i]();
+}
+
+int MockMdApi::ReqUserLogin(CThostFtdcReqUserLoginField* pReqUserLoginField, int nRequestID) {
+    if (!pReqUserLoginField) return -1;
+    const std::string broker(pReqUserLoginField->BrokerID);
+    const std::string user(pReqUserLoginField->UserID);
+    post([this, broker, user, nRequestID]() {
+        CThostFtdcRspUserLoginField rsp;
+        memset(&rsp, 0, sizeof(rsp));
+        strncpy(rsp.TradingDay, m_config.trading_day.c_str(), sizeof(rsp.TradingDay) - 1);
+        strncpy(rsp.BrokerID, broker.c_str(), sizeof(rsp.BrokerID) - 1);
+        strncpy(rsp.UserID, user.c_str(), sizeof(rsp.UserID) - 1);
+        CThostFtdcRspInfoField info;
+        memset(&info, 0, sizeof(info));
+        m_loggedIn = true;
+        CThostFtdcMdSpi* pSpi = m_pSpi.load(std::memory_order_acquire);
+        if (pSpi) pSpi->OnRspUserLogin(&rsp, &info, nRequestID, true);
+    });
+    return 0;
+}
+
+int MockMdApi::ReqUserLogout(CThostFtdcUserLogoutField*, int) {
+    post([this]() { m_loggedIn = false; });
+    return 0;
+}
+
+int MockMdApi::SubscribeMarketData(char* ppInstrumentID[], int nCount) {
+    if (!ppInstrumentID || nCount <= 0) return -1;
+    std::vector<std::string> ids(ppInstrumentID, ppInstrumentID + nCount);
+    post([this, ids]() {
+        CThostFtdcMdSpi* pSpi = m_pSpi.load(std::memory_order_acquire);
+        for (size_t i = 0; i < ids.size(); ++i) {
+            CThostFtdcSpecificInstrumentField inst;
+            memset(&inst, 0, sizeof(inst));
+            strncpy(inst.InstrumentID, ids[i].c_str(), sizeof(inst.InstrumentID) - 1);
+            CThostFtdcRspInfoField info;
+            memset(&info, 0, sizeof(info));
+
+            if (m_config.instrument_count == 0 || m_instruments.size() < m_config.instrument_count) {
+                Instrument state;
+                state.id = ids[i];
+                state.price_tick = 1.0;
+                for (size_t k = 0; k < m_priceTicks.size(); ++k) {
+                    if (m_priceTicks[k].first == ids[i]) state.price_tick = m_priceTicks[k].second;
+                }
+                state.last = 1000 + (int64_t)(m_instruments.size() * 100);
+                state.volume = 0;
+                state.turnover = 0;
+                state.open_interest = 10000;
+                m_instruments.push_back(state);
+            }
+            if (pSpi) pSpi->OnRspSubMarketData(&inst, &info, 0, i + 1 == ids.size());
+        }
+    });
+    return 0;
+}
+
+int MockMdApi::UnSubscribeMarketData(char* ppInstrumentID[], int nCount) {
+    if (!ppInstrumentID || nCount <= 0) return -1;
+    std::vector<std::string> ids(ppInstrumentID, ppInstrumentID + nCount);
+    post([this, ids]() {
+        for (size_t i = 0; i < ids.size(); ++i) {
+            for (size_t k = 0; k < m_instruments.size(); ++k) {
+                if (m_instruments[k].id == ids[i]) {
+                    m_instruments.erase(m_instruments.begin() + k);
+                    break;
+                }
+            }
+        }
+        m_cursor = 0;
+    });
+    return 0;
+}
+
+int MockMdApi::SubscribeForQuoteRsp(char*[], int) {
+    return 0;
+}
+
+int MockMdApi::UnSubscribeForQuoteRsp(char*[], int) {
+    return 0;
+}
+
+int MockMdApi::ReqQryMulticastInstrument(CThostFtdcQryMulticastInstrumentField*, int) {
+    return 0;
+}
+
+void MockMdApi::fill_tick(Instrument& inst, uint64_t& rng, CThostFtdcDepthMarketDataField& md) {
+    const uint64_t r = next_random(rng);
+    // 最新价 -1/0/+1 个 tick 随机游走，成交量 1~10 手
+    inst.last += (int64_t)(r % 3) - 1;
+    if (inst.last < 10) inst.last = 10;
+    const int traded = 1 + (int)((r >> 8) % 10);
+    const double px = inst.last * inst.price_tick;
+    inst.volume += traded;
+    inst.turnover += traded * px;
+    inst.open_interest += (double)((int)((r >> 16) % 5) - 2);
+
+    memset(&md, 0, sizeof(md));
+    strncpy(md.InstrumentID, inst.id.c_str(), sizeof(md.InstrumentID) - 1);
+    strncpy(md.TradingDay, m_config.trading_day.c_str(), sizeof(md.TradingDay) - 1);
+    memcpy(md.ActionDay, m_actionDay, sizeof(m_actionDay));
+    memcpy(md.UpdateTime, m_updateTime, sizeof(m_updateTime));
+    md.UpdateMillisec = m_updateMillisec;
+    md.LastPrice = px;
+    md.Volume = inst.volume;
+    md.Turnover = inst.turnover;
+    md.OpenInterest = inst.open_interest;
+    md.PreSettlementPrice = px;
+    md.UpperLimitPrice = DBL_MAX;
+    md.LowerLimitPrice = DBL_MAX;
+
+    double* bid_px[5] = {&md.BidPrice1, &md.BidPrice2, &md.BidPrice3, &md.BidPrice4, &md.BidPrice5};
+    double* ask_px[5] = {&md.AskPrice1, &md.AskPrice2, &md.AskPrice3, &md.AskPrice4, &md.AskPrice5};
+    int* bid_vol[5] = {&md.BidVolume1, &md.BidVolume2, &md.BidVolume3, &md.BidVolume4, &md.BidVolume5};
+    int* ask_vol[5] = {&md.AskVolume1, &md.AskVolume2, &md.AskVolume3, &md.AskVolume4, &md.AskVolume5};
+    for (int i = 0; i < 5; ++i) {
+        *bid_px[i] = (inst.last - 1 - i) * inst.price_tick;
+        *ask_px[i] = (inst.last + 1 + i) * inst.price_tick;
+        *bid_vol[i] = 1 + (int)((r >> (24 + i * 4)) % 50);
+        *ask_vol[i] = 1 + (int)((r >> (44 + i * 4)) % 50);
+    }
+}
+
+void MockMdApi::publish_burst(size_t count, uint64_t& rng, int64_t exchange_ns, bool deliver) {
+    CThostFtdcMdSpi* pSpi = m_pSpi.load(std::memory_order_acquire);
+    if (!pSpi || m_instruments.empty()) return;
+
+    // 突发内的 tick 共用同一交易所时间 (北京时间)
+    const time_t cst = (time_t)(exchange_ns / 1000000000LL) + 8 * 3600;
+    tm t;
+    gmtime_r(&cst, &t);
+    strftime(m_actionDay, sizeof(m_actionDay), "%Y%m%d", &t);
+    strftime(m_updateTime, sizeof(m_updateTime), "%H:%M:%S", &t);
+    m_updateMillisec = (int)(exchange_ns / 1000000 % 1000);
+
+    CThostFtdcDepthMarketDataField md;
+    for (size_t i = 0; i < count; ++i) {
+        Instrument& inst = m_instruments[m_cursor];
+        if (++m_cursor == m_instruments.size()) m_cursor = 0;
+        fill_tick(inst, rng, md);
+        if (deliver) pSpi->OnRtnDepthMarketData(&md);
+    }
+    m_generated += count;
+    if (deliver) m_sent.store(m_sent.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+}
+
+size_t MockMdApi::burst_size() const {
+    if (m_config.max_ticks && m_generated + m_config.burst > m_config.max_ticks) {
+        return (size_t)(m_config.max_ticks - m_generated);
+    }
+    return m_config.burst;
+}
+
+void MockMdApi::run() {
+    if (m_config.cpu_id >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(m_config.cpu_id, &cpuset);
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+        std::cout << "[MockMd] Publisher pinned to core " << m_config.cpu_id << ": "
+                  << (rc == 0 ? "OK" : strerror(rc)) << std::endl;
+    }
+
+    CThostFtdcMdSpi* pSpi = m_pSpi.load(std::memory_order_acquire);
+    if (pSpi) pSpi->OnFrontConnected();
+
+    uint64_t rng = m_config.seed;
+    // 相邻两次突发的间隔，保证平均速率为 rate
+    const int64_t interval_ns = m_config.rate ? (int64_t)(m_config.burst * 1000000000ULL / m_config.rate) : 0;
+    const int64_t delay_ns = (int64_t)m_config.delay_us * 1000;
+    int64_t next_ns = 0; // 下一次突发的交易所时间
+    bool ready = false;
+
+    while (m_running) {
+        if (m_hasRequests.load(std::memory_order_acquire)) drain_requests();
+
+        const bool done = m_config.max_ticks && m_generated >= m_config.max_ticks;
+        if (!m_loggedIn || m_instruments.empty() || done) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            ready = false;
+            continue;
+        }
+
+        const int64_t now = realtime_ns();
+        if (!ready) {
+            // 刚就绪：没有共同时间轴时从现在开始；有时间轴时就绪前的突发只生成不推送
+            ready = true;
+            if (m_config.start_ns == 0) {
+                next_ns = now;
+            } else {
+                if (next_ns == 0) next_ns = m_config.start_ns;
+                while (interval_ns && next_ns + delay_ns < now &&
+                       !(m_config.max_ticks && m_generated >= m_config.max_ticks)) {
+                    publish_burst(burst_size(), rng, next_ns, false);
+                    next_ns += interval_ns;
+                }
+                continue;
+            }
+        }
+
+        const int64_t due = next_ns + delay_ns;
+        if (now < due) {
+            // 离下一次突发较远时让出 CPU，临近时忙等以保证突发时刻准确
+            if (due - now > 200000) {
+                std::this_thread::sleep_for(std::chrono::microseconds((due - now - 100000) / 1000));
+            } else {
+                _mm_pause();
+            }
+            continue;
+        }
+
+        publish_burst(burst_size(), rng, interval_ns ? next_ns : now, true);
+        next_ns += interval_ns;
+    }
+}
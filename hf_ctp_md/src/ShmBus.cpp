@@ -0,0 +1,255 @@
+#include "ShmBus.h"
+#include "TscClock.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <unistd.h>
+
+using namespace shmbus;
+
+#ifndef HUGETLBFS_MAGIC
+#define HUGETLBFS_MAGIC 0x958458f6
+#endif
+
+static bool is_hugetlbfs(const std::string& dir) {
+    struct statfs fs;
+    return !dir.empty() && statfs(dir.c_str(), &fs) == 0 && (unsigned long)fs.f_type == HUGETLBFS_MAGIC;
+}
+
+// 同名的旧总线：标记为已关闭，让仍挂载着的读端知道写端已经换了，然后删除
+static void retire(int fd) {
+    if (fd < 0) return;
+    void* p = mmap(nullptr, sizeof(BusHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p != MAP_FAILED) {
+        BusHeader* header = static_cast<BusHeader*>(p);
+        if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0) {
+            header->state.store(STATE_CLOSED, std::memory_order_release);
+        }
+        munmap(p, sizeof(BusHeader));
+    }
+    ::close(fd);
+}
+
+// === ShmBusWriter ===
+
+ShmBusWriter::ShmBusWriter()
+    : m_header(nullptr), m_slots(nullptr), m_mask(0), m_seq(0), m_size(0), m_hugePages(false) {
+}
+
+ShmBusWriter::~ShmBusWriter() {
+    close();
+}
+
+bool ShmBusWriter::map(const std::string& path, size_t size, bool huge) {
+    const int fd = huge ? ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)
+                        : shm_open(m_shmName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "[Bus] Failed to create " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    void* p = MAP_FAILED;
+    if (ftruncate(fd, (off_t)size) == 0) {
+        // 预先分配全部页面，引擎线程 publish() 时不会缺页；大页不足时 hugetlbfs 在这里就会失败
+        p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    }
+    const int err = errno;
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "[Bus] Failed to map " << path << " (" << size / 1024 << " KB): " << strerror(err) << std::endl;
+        if (huge) unlink(path.c_str());
+        else shm_unlink(m_shmName.c_str());
+        return false;
+    }
+    if (!huge) madvise(p, size, MADV_HUGEPAGE);
+
+    m_header = static_cast<BusHeader*>(p);
+    m_size = size;
+    m_hugePages = huge;
+    m_path = path;
+    return true;
+}
+
+bool ShmBusWriter::open(const std::string& name, size_t capacity, const InstrumentRegistry& registry,
+                        const std::string& hugepage_dir) {
+    if (m_header) return false;
+    if (name.empty() || name.find('/') != std::string::npos) {
+        std::cerr << "[Bus] Invalid bus name: " << name << std::endl;
+        return false;
+    }
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        std::cerr << "[Bus] Capacity must be a power of two: " << capacity << std::endl;
+        return false;
+    }
+
+    m_shmName = "/" + name;
+    const bool huge_fs = is_hugetlbfs(hugepage_dir);
+    const std::string huge_path = hugepage_dir + "/" + name;
+    if (!hugepage_dir.empty()) {
+        retire(::open(huge_path.c_str(), O_RDWR));
+        unlink(huge_path.c_str());
+    }
+    retire(shm_open(m_shmName.c_str(), O_RDWR, 0));
+    shm_unlink(m_shmName.c_str());
+
+    const size_t header_size = header_size_for(registry.size());
+    const size_t size = header_size + capacity * sizeof(Slot);
+    if (!(huge_fs && map(huge_path, (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1), true)) &&
+        !map("/dev/shm" + m_shmName, size, false)) {
+        return false;
+    }
+
+    // 文件刚创建时全为 0：槽位序号 0 表示从未写入，state 为 STATE_INIT，读端拒绝挂载
+    memcpy(m_header->magic, MAGIC, sizeof(MAGIC));
+    m_header->version = VERSION;
+    m_header->header_size = (uint32_t)header_size;
+    m_header->capacity = capacity;
+    m_header->slot_size = sizeof(Slot);
+    m_header->instrument_count = (uint32_t)registry.size();
+    m_header->writer_pid = (uint32_t)getpid();
+    m_header->huge_pages = m_hugePages ? 1 : 0;
+    m_header->created_ns = TscClock::wall_ns();
+
+    journal::InstrumentEntry* entries = reinterpret_cast<journal::InstrumentEntry*>(
+        reinterpret_cast<char*>(m_header) + sizeof(BusHeader));
+    for (size_t i = 0; i < registry.size(); ++i) {
+        strncpy(entries[i].instrument_id, registry.name((uint16_t)i), sizeof(entries[i].instrument_id) - 1);
+        entries[i].price_tick = registry.price_tick((uint16_t)i);
+    }
+
+    m_slots = reinterpret_cast<Slot*>(reinterpret_cast<char*>(m_header) + header_size);
+    m_mask = capacity - 1;
+    m_seq = 0;
+    m_header->write_seq.store(0, std::memory_order_relaxed);
+    m_header->state.store(STATE_RUNNING, std::memory_order_release);
+
+    std::cout << "[Bus] Publishing to " << m_path << " (" << capacity << " slots, " << m_size / 1024 << " KB, "
+              << (m_hugePages ? "2MB huge pages" : "4KB pages") << ")" << std::endl;
+    return true;
+}
+
+void ShmBusWriter::close() {
+    if (!m_header) return;
+    m_header->state.store(STATE_CLOSED, std::memory_order_release);
+    munmap(m_header, m_size);
+    if (m_hugePages) unlink(m_path.c_str());
+    else shm_unlink(m_shmName.c_str());
+    std::cout << "[Bus] Closed " << m_path << ", published " << m_seq << " ticks." << std::endl;
+    m_header = nullptr;
+    m_slots = nullptr;
+}
+
+// === ShmBusReader ===
+
+ShmBusReader::ShmBusReader()
+    : m_header(nullptr), m_slots(nullptr), m_instruments(nullptr), m_mask(0), m_cursor(0), m_received(0),
+      m_lapped(0), m_missed(0), m_torn(0), m_size(0) {
+}
+
+ShmBusReader::~ShmBusReader() {
+    close();
+}
+
+bool ShmBusReader::open(const std::string& name, const std::string& hugepage_dir) {
+    close();
+
+    // 与写端相同的查找顺序：先 hugetlbfs，再 POSIX shm
+    int fd = -1;
+    if (!hugepage_dir.empty()) {
+        m_path = hugepage_dir + "/" + name;
+        fd = ::open(m_path.c_str(), O_RDONLY);
+    }
+    if (fd < 0) {
+        m_path = "/dev/shm/" + name;
+        fd = shm_open(("/" + name).c_str(), O_RDONLY, 0);
+    }
+    if (fd < 0) {
+        std::cerr << "[Bus] Bus " << name << " not found: " << strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(BusHeader)) {
+        std::cerr << "[Bus] " << m_path << " is too small to be a bus." << std::endl;
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "[Bus] mmap failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    m_header = static_cast<const BusHeader*>(p);
+    m_size = (size_t)st.st_size;
+
+    const char* error = nullptr;
+    if (memcmp(m_header->magic, MAGIC, sizeof(MAGIC)) != 0 || m_header->state.load(std::memory_order_acquire) == STATE_INIT) {
+        error = "not initialized";
+    } else if (m_header->version != VERSION) {
+        error = "unsupported version";
+    } else if (m_header->slot_size != sizeof(Slot)) {
+        error = "Tick layout differs from this build";
+    } else if (m_header->capacity < 2 || (m_header->capacity & (m_header->capacity - 1)) != 0 ||
+               sizeof(BusHeader) + (size_t)m_header->instrument_count * sizeof(journal::InstrumentEntry) > m_header->header_size ||
+               m_header->header_size + m_header->capacity * sizeof(Slot) > m_size) {
+        error = "corrupt header";
+    }
+    if (error) {
+        std::cerr << "[Bus] " << m_path << ": " << error << std::endl;
+        close();
+        return false;
+    }
+
+    m_instruments = reinterpret_cast<const journal::InstrumentEntry*>(reinterpret_cast<const char*>(m_header) + sizeof(BusHeader));
+    m_slots = reinterpret_cast<const Slot*>(reinterpret_cast<const char*>(m_header) + m_header->header_size);
+    m_mask = m_header->capacity - 1;
+    m_received = m_lapped = m_missed = m_torn = 0;
+    seek_latest();
+    return true;
+}
+
+void ShmBusReader::close() {
+    if (m_header) munmap(const_cast<BusHeader*>(m_header), m_size);
+    m_header = nullptr;
+    m_slots = nullptr;
+    m_instruments = nullptr;
+}
+
+void ShmBusReader::seek_latest() {
+    m_cursor = m_header->write_seq.load(std::memory_order_acquire);
+}
+
+void ShmBusReader::seek_oldest() {
+    // 最老的几个槽位随时可能被覆盖，留出 1/8 圈的余量
+    const uint64_t head = m_header->write_seq.load(std::memory_order_acquire);
+    const uint64_t keep = capacity() - capacity() / 8;
+    m_cursor = head > keep ? head - keep : 0;
+}
+
+void ShmBusReader::on_lapped() {
+    const uint64_t head = m_header->write_seq.load(std::memory_order_acquire);
+    ++m_lapped;
+    if (head > m_cursor) {
+        m_missed += head - m_cursor;
+        m_cursor = head;
+    }
+}
+
+bool ShmBusReader::writer_closed() const {
+    if (backlog() != 0) return false;
+    if (m_header->state.load(std::memory_order_acquire) == STATE_CLOSED) return true;
+    return kill((pid_t)m_header->writer_pid, 0) != 0 && errno == ESRCH;
+}
+
+uint16_t ShmBusReader::find_instrument(const char* instrument_id) const {
+    for (size_t i = 0; i < instrument_count(); ++i) {
+        if (strncmp(m_instruments[i].instrument_id, instrument_id, sizeof(journal::InstrumentEntry::instrument_id)) == 0) {
+            return (uint16_t)i;
+        }
+    }
+    return 0xFFFF;
+}
@@ -0,0 +1,233 @@
+#include "TickRecorder.h"
+#include "TscClock.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <new>
+#include <unistd.h>
+
+using namespace journal;
+
+static inline size_t round_up_block(size_t n) {
+    return (n + JOURNAL_BLOCK_SIZE - 1) & ~(JOURNAL_BLOCK_SIZE - 1);
+}
+
+TickRecorder::TickRecorder(size_t ring_size, size_t buffer_size)
+    : m_ring(ring_size), m_running(false), m_written(0), m_dropped(0), m_failed(false),
+      m_fd(-1), m_directIO(false), m_flushIntervalMs(DEFAULT_FLUSH_INTERVAL_MS),
+      m_instrumentCount(0), m_indexEnabled(true),
+      m_buffer(nullptr), m_bufferSize(round_up_block(buffer_size < TICK_RECORD_SIZE * 2 ? TICK_RECORD_SIZE * 2 : buffer_size)),
+      m_used(0), m_fileOffset(0) {
+}
+
+TickRecorder::~TickRecorder() {
+    stop();
+    free(m_buffer);
+}
+
+void TickRecorder::set_flush_interval_ms(unsigned interval_ms) {
+    m_flushIntervalMs = interval_ms > 0 ? interval_ms : DEFAULT_FLUSH_INTERVAL_MS;
+}
+
+void TickRecorder::set_index_bucket_ns(int64_t bucket_ns) {
+    m_indexEnabled = bucket_ns > 0;
+    if (m_indexEnabled) m_index.set_bucket_ns(bucket_ns);
+}
+
+bool TickRecorder::open(const std::string& path, uint32_t trading_day, const InstrumentRegistry& registry) {
+    if (m_fd >= 0) return false;
+
+    m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    m_directIO = m_fd >= 0;
+    if (m_fd < 0 && errno == EINVAL) {
+        m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    if (m_fd < 0) {
+        std::cerr << "[Recorder] Failed to open " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    m_path = path;
+    m_instrumentCount = registry.size();
+    m_index.clear();
+
+    // 文件头 + 合约表，补零到块边界
+    const size_t header_size = header_size_for(registry.size());
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, JOURNAL_BLOCK_SIZE, header_size) != 0) {
+        throw std::bad_alloc();
+    }
+    char* header_buf = static_cast<char*>(ptr);
+    memset(header_buf, 0, header_size);
+
+    FileHeader* header = reinterpret_cast<FileHeader*>(header_buf);
+    memcpy(header->magic, MAGIC, sizeof(MAGIC));
+    header->version = VERSION;
+    header->header_size = (uint32_t)header_size;
+    header->trading_day = trading_day;
+    header->instrument_count = (uint32_t)registry.size();
+    header->tick_size = sizeof(Tick);
+    header->tsc_ghz = TscClock::ghz();
+    header->tsc_base = TscClock::base_tsc();
+    header->tsc_base_wall_ns = TscClock::base_wall_ns();
+    header->created_ns = TscClock::wall_ns();
+
+    InstrumentEntry* entries = reinterpret_cast<InstrumentEntry*>(header_buf + sizeof(FileHeader));
+    for (size_t i = 0; i < registry.size(); ++i) {
+        strncpy(entries[i].instrument_id, registry.name((uint16_t)i), sizeof(entries[i].instrument_id) - 1);
+        entries[i].price_tick = registry.price_tick((uint16_t)i);
+    }
+
+    const ssize_t n = pwrite(m_fd, header_buf, header_size, 0);
+    free(header_buf);
+    if (n != (ssize_t)header_size) {
+        std::cerr << "[Recorder] Failed to write header to " << path << ": " << strerror(errno) << std::endl;
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    // 写缓冲在 open() 时才分配，未启用记录时只占用环的虚拟地址
+    if (!m_buffer) {
+        if (posix_memalign(&ptr, JOURNAL_BLOCK_SIZE, m_bufferSize) != 0) {
+            throw std::bad_alloc();
+        }
+        m_buffer = static_cast<char*>(ptr);
+    }
+    memset(m_buffer, 0, m_bufferSize);
+    m_fileOffset = header_size;
+    m_used = 0;
+    std::cout << "[Recorder] Journal " << path << " (trading day " << trading_day << ", "
+              << registry.size() << " instruments, O_DIRECT " << (m_directIO ? "on" : "off") << ")" << std::endl;
+    return true;
+}
+
+void TickRecorder::start() {
+    if (m_running || m_fd < 0) return;
+    m_running = true;
+    m_thread = std::thread(&TickRecorder::run, this);
+}
+
+void TickRecorder::stop() {
+    if (!m_running) return;
+    m_running = false;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    // 去掉最后一块的补零，文件长度即数据实际长度；写盘失败时只保留成功写出的完整块
+    if (m_fd >= 0) {
+        const uint64_t length = failed() ? m_fileOffset : m_fileOffset + m_used;
+        if (ftruncate(m_fd, (off_t)length) != 0) {
+            std::cerr << "[Recorder] ftruncate failed: " << strerror(errno) << std::endl;
+        }
+        fdatasync(m_fd);
+        ::close(m_fd);
+        m_fd = -1;
+
+        // 索引最后写：journal 完整落盘后索引才出现，长度不符的索引读取端会重建
+        // 写盘失败时索引里有指向文件之外的条目，不写出
+        if (m_indexEnabled && !failed()) {
+            const size_t entries = m_index.entry_count();
+            if (m_index.write(m_path + ".idx", m_instrumentCount, length)) {
+                std::cout << "[Recorder] Index " << m_path << ".idx (" << entries << " entries)" << std::endl;
+            }
+        }
+        std::cout << "[Recorder] Closed " << m_path << ". Wrote " << written() << " ticks ("
+                  << length / (1024 * 1024) << " MB), dropped " << dropped() << "." << std::endl;
+    }
+}
+
+// 写出缓冲区中的全部数据 (长度向上取整到块，块尾为 0)
+// 之后只保留最后一个不完整的块，下次刷盘时在同一偏移覆盖重写
+bool TickRecorder::flush() {
+    if (m_used == 0) return true;
+
+    const size_t len = round_up_block(m_used);
+    size_t done = 0;
+    while (done < len) {
+        const ssize_t n = pwrite(m_fd, m_buffer + done, len - done, (off_t)(m_fileOffset + done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[Recorder] pwrite failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        done += (size_t)n;
+    }
+
+    const size_t full = m_used & ~(JOURNAL_BLOCK_SIZE - 1);
+    if (full > 0) {
+        const size_t tail = m_used - full;
+        memmove(m_buffer, m_buffer + full, tail);
+        memset(m_buffer + tail, 0, full);
+        m_fileOffset += full;
+        m_used = tail;
+    }
+    return true;
+}
+
+void TickRecorder::fail() {
+    m_failed.store(true, std::memory_order_relaxed);
+    std::cerr << "[Recorder] Write failed, recording stopped; further ticks are counted as dropped." << std::endl;
+}
+
+void TickRecorder::run() {
+    const size_t BATCH = 256;
+    const std::chrono::milliseconds flush_interval(m_flushIntervalMs);
+    std::chrono::steady_clock::time_point last_flush = std::chrono::steady_clock::now();
+    uint64_t written = 0;
+    bool dirty = false;
+
+    for (;;) {
+        // 先读停止标志再取数据：stop() 之前 append 的 tick 一定在本轮取到，不会漏写
+        const bool running = m_running.load();
+        SPSCQueue<Tick>::Span batch = m_ring.peek_batch(BATCH);
+        if (batch.empty()) {
+            if (!running) break;
+            // 写线程不在关键路径上，空闲时睡眠以免占用 CPU
+            if (dirty && std::chrono::steady_clock::now() - last_flush >= flush_interval) {
+                if (!flush()) fail();
+                dirty = false;
+                last_flush = std::chrono::steady_clock::now();
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+            continue;
+        }
+
+        // 写盘失败后只取空记录环，保证引擎线程的 append 不会一直撞满
+        if (failed()) {
+            m_dropped.fetch_add(batch.size(), std::memory_order_relaxed);
+            m_ring.release(batch.size());
+            continue;
+        }
+
+        size_t stored = 0;
+        for (const Tick& tick : batch) {
+            if (m_used + TICK_RECORD_SIZE > m_bufferSize) {
+                // flush() 失败时 m_used 不变，缓冲区已满，不能再写
+                if (!flush()) {
+                    fail();
+                    break;
+                }
+                last_flush = std::chrono::steady_clock::now();
+            }
+            if (m_indexEnabled) m_index.add(tick, m_fileOffset + m_used);
+            RecordHeader* rh = reinterpret_cast<RecordHeader*>(m_buffer + m_used);
+            rh->length = sizeof(Tick);
+            rh->type = RECORD_TICK;
+            rh->reserved = 0;
+            memcpy(m_buffer + m_used + sizeof(RecordHeader), &tick, sizeof(Tick));
+            m_used += TICK_RECORD_SIZE;
+            ++stored;
+        }
+        written += stored;
+        if (stored < batch.size()) m_dropped.fetch_add(batch.size() - stored, std::memory_order_relaxed);
+        m_ring.release(batch.size());
+        m_written.store(written, std::memory_order_relaxed);
+        dirty = true;
+    }
+
+    if (!failed() && !flush()) fail();
+}
@@ -0,0 +1,62 @@
+#include "TscClock.h"
+#include <cpuid.h>
+#include <ctime>
+
+uint64_t TscClock::s_mult = 1ULL << TscClock::MULT_SHIFT;
+uint64_t TscClock::s_base_tsc = 0;
+int64_t TscClock::s_base_wall_ns = 0;
+double TscClock::s_ghz = 1.0;
+bool TscClock::s_serialized = false;
+bool TscClock::s_calibrated = false;
+
+static inline int64_t clock_ns(clockid_t clock) {
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// 读取一对 (TSC, 系统时钟)：取前后两次 TSC 间隔最短的一次，TSC 取中点，
+// 排除读时钟过程中被中断/调度打断的样本
+static void sample_pair(clockid_t clock, uint64_t& tsc, int64_t& ns) {
+    uint64_t best = ~0ULL;
+    tsc = 0;
+    ns = 0;
+    for (int i = 0; i < 16; ++i) {
+        const uint64_t t0 = TscClock::rdtscp();
+        const int64_t t = clock_ns(clock);
+        const uint64_t t1 = TscClock::rdtscp();
+        if (t1 - t0 < best) {
+            best = t1 - t0;
+            tsc = t0 + (t1 - t0) / 2;
+            ns = t;
+        }
+    }
+}
+
+bool TscClock::invariant_tsc() {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) return false;
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx & (1u << 8)) != 0;
+}
+
+bool TscClock::calibrate(uint64_t window_ns) {
+    uint64_t tsc0, tsc1;
+    int64_t ns0, ns1;
+    sample_pair(CLOCK_MONOTONIC_RAW, tsc0, ns0);
+    while ((uint64_t)(clock_ns(CLOCK_MONOTONIC_RAW) - ns0) < window_ns) {}
+    sample_pair(CLOCK_MONOTONIC_RAW, tsc1, ns1);
+    if (tsc1 <= tsc0 || ns1 <= ns0) return false;
+
+    const double ghz = (double)(tsc1 - tsc0) / (double)(ns1 - ns0);
+    s_ghz = ghz;
+    s_mult = (uint64_t)((double)(1ULL << MULT_SHIFT) / ghz + 0.5);
+
+    uint64_t base_tsc;
+    int64_t base_wall;
+    sample_pair(CLOCK_REALTIME, base_tsc, base_wall);
+    s_base_tsc = base_tsc;
+    s_base_wall_ns = base_wall;
+    s_calibrated = true;
+    return true;
+}
@@ -0,0 +1,290 @@
+#include "UdpFeed.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <immintrin.h> // _mm_pause
+
+using namespace udpfeed;
+
+bool udpfeed::make_address(const std::string& host, uint16_t port, sockaddr_in& out) {
+    memset(&out, 0, sizeof(out));
+    out.sin_family = AF_INET;
+    out.sin_port = htons(port);
+    return inet_pton(AF_INET, host.c_str(), &out.sin_addr) == 1;
+}
+
+static bool is_multicast(const sockaddr_in& addr) {
+    return IN_MULTICAST(ntohl(addr.sin_addr.s_addr));
+}
+
+static char* alloc_packets(size_t count) {
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, CACHELINE_SIZE, count * MAX_PACKET_SIZE) != 0) {
+        throw std::bad_alloc();
+    }
+    memset(ptr, 0, count * MAX_PACKET_SIZE);
+    return static_cast<char*>(ptr);
+}
+
+// === UdpPublisher ===
+
+UdpPublisher::UdpPublisher(size_t ring_size)
+    : m_ring(ring_size), m_running(false), m_packets(0), m_ticks(0), m_errors(0), m_dropped(0),
+      m_fd(-1), m_ticksPerPacket(DEFAULT_TICKS_PER_PACKET), m_cpuId(-1), m_idleSleepUs(50), m_session(0), m_seq(0),
+      m_buffer(alloc_packets(MAX_BATCH)), m_msgs(MAX_BATCH), m_iovs(MAX_BATCH) {
+    memset(&m_dest, 0, sizeof(m_dest));
+}
+
+UdpPublisher::~UdpPublisher() {
+    stop();
+    if (m_fd >= 0) ::close(m_fd);
+    free(m_buffer);
+}
+
+bool UdpPublisher::open(const std::string& group, uint16_t port, const std::string& iface,
+                        size_t ticks_per_packet, int ttl) {
+    if (m_fd >= 0) return false;
+    if (!make_address(group, port, m_dest)) {
+        std::cerr << "[Udp] Invalid group address: " << group << std::endl;
+        return false;
+    }
+    if (ticks_per_packet == 0 || ticks_per_packet > MAX_TICKS_PER_PACKET) {
+        std::cerr << "[Udp] TicksPerPacket must be 1~" << MAX_TICKS_PER_PACKET << std::endl;
+        return false;
+    }
+    m_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_fd < 0) {
+        std::cerr << "[Udp] socket failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (is_multicast(m_dest)) {
+        in_addr local;
+        const unsigned char loop = 1;
+        const unsigned char hops = (unsigned char)(ttl < 0 ? 0 : ttl > 255 ? 255 : ttl);
+        if (inet_pton(AF_INET, iface.c_str(), &local) != 1 ||
+            setsockopt(m_fd, IPPROTO_IP, IP_MULTICAST_IF, &local, sizeof(local)) != 0 ||
+            setsockopt(m_fd, IPPROTO_IP, IP_MULTICAST_TTL, &hops, sizeof(hops)) != 0 ||
+            setsockopt(m_fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) != 0) {
+            std::cerr << "[Udp] Failed to set multicast interface " << iface << ": " << strerror(errno) << std::endl;
+            ::close(m_fd);
+            m_fd = -1;
+            return false;
+        }
+    }
+    const int sndbuf = 4 << 20;
+    setsockopt(m_fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+    m_ticksPerPacket = ticks_per_packet;
+    m_session = (uint32_t)(TscClock::wall_ns() / 1000) ^ (uint32_t)getpid();
+    m_seq = 0;
+    for (size_t i = 0; i < MAX_BATCH; ++i) {
+        m_iovs[i].iov_base = m_buffer + i * MAX_PACKET_SIZE;
+        memset(&m_msgs[i], 0, sizeof(mmsghdr));
+        m_msgs[i].msg_hdr.msg_name = &m_dest;
+        m_msgs[i].msg_hdr.msg_namelen = sizeof(m_dest);
+        m_msgs[i].msg_hdr.msg_iov = &m_iovs[i];
+        m_msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    std::cout << "[Udp] Publishing to " << group << ":" << port << (is_multicast(m_dest) ? " (multicast via " + iface + ")" : "")
+              << ", " << ticks_per_packet << " ticks/packet" << std::endl;
+    return true;
+}
+
+void UdpPublisher::set_cpu_affinity(int cpu_id) {
+    m_cpuId = cpu_id;
+}
+
+void UdpPublisher::set_idle_sleep_us(unsigned sleep_us) {
+    m_idleSleepUs = sleep_us;
+}
+
+void UdpPublisher::start() {
+    if (m_running || m_fd < 0) return;
+    m_running = true;
+    m_thread = std::thread(&UdpPublisher::run, this);
+}
+
+void UdpPublisher::stop() {
+    if (!m_running) return;
+    m_running = false;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    std::cout << "[Udp] Closed. Sent " << ticks_sent() << " ticks in " << packets() << " packets, dropped "
+              << dropped() << ", send errors " << send_errors() << "." << std::endl;
+}
+
+// 发出前 count 个已打包的报文，返回成功发出的个数
+size_t UdpPublisher::send(size_t count) {
+    const int64_t now = TscClock::wall_ns();
+    for (size_t i = 0; i < count; ++i) {
+        reinterpret_cast<PacketHeader*>(m_iovs[i].iov_base)->send_ns = now;
+    }
+    size_t sent = 0;
+    while (sent < count) {
+        const int n = sendmmsg(m_fd, &m_msgs[sent], (unsigned)(count - sent), 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            // ENOBUFS 等：这一批剩余的报文丢弃，接收端会看到序号跳跃
+            m_errors.store(m_errors.load(std::memory_order_relaxed) + (count - sent), std::memory_order_relaxed);
+            break;
+        }
+        sent += (size_t)n;
+    }
+    return sent;
+}
+
+void UdpPublisher::run() {
+    if (m_cpuId >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(m_cpuId, &cpuset);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    }
+
+    uint64_t packets = 0, ticks = 0;
+    for (;;) {
+        // 先读停止标志再取数据：stop() 之前 append 的 tick 一定在本轮取到，不会漏发
+        const bool running = m_running.load();
+        // 把环里现有的 tick 打包成最多 MAX_BATCH 个报文
+        size_t count = 0;
+        while (count < MAX_BATCH) {
+            SPSCQueue<Tick>::Span span = m_ring.peek_batch(m_ticksPerPacket);
+            if (span.empty()) break;
+            char* packet = static_cast<char*>(m_iovs[count].iov_base);
+            PacketHeader* header = reinterpret_cast<PacketHeader*>(packet);
+            header->magic = MAGIC;
+            header->version = VERSION;
+            header->tick_count = (uint16_t)span.size();
+            header->session = m_session;
+            header->tick_size = sizeof(Tick);
+            header->seq = ++m_seq;
+            memset(header->reserved, 0, sizeof(header->reserved));
+            memcpy(packet + sizeof(PacketHeader), span.data, span.size() * sizeof(Tick));
+            m_iovs[count].iov_len = sizeof(PacketHeader) + span.size() * sizeof(Tick);
+            ticks += span.size();
+            m_ring.release(span.size());
+            ++count;
+        }
+
+        if (count == 0) {
+            if (!running) break;
+            if (m_idleSleepUs) std::this_thread::sleep_for(std::chrono::microseconds(m_idleSleepUs));
+            else _mm_pause();
+            continue;
+        }
+        send(count);
+        packets += count;
+        m_packets.store(packets, std::memory_order_relaxed);
+        m_ticks.store(ticks, std::memory_order_relaxed);
+    }
+}
+
+// === UdpReceiver ===
+
+UdpReceiver::UdpReceiver()
+    : m_fd(-1), m_buffer(alloc_packets(BATCH)), m_msgs(BATCH), m_iovs(BATCH), m_session(0), m_nextSeq(0),
+      m_packets(0), m_ticks(0), m_gaps(0), m_lost(0), m_outOfOrder(0), m_malformed(0), m_resets(0), m_batches(0) {
+    for (size_t i = 0; i < BATCH; ++i) {
+        m_iovs[i].iov_base = m_buffer + i * MAX_PACKET_SIZE;
+        m_iovs[i].iov_len = MAX_PACKET_SIZE;
+        memset(&m_msgs[i], 0, sizeof(mmsghdr));
+        m_msgs[i].msg_hdr.msg_iov = &m_iovs[i];
+        m_msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
+UdpReceiver::~UdpReceiver() {
+    close();
+    free(m_buffer);
+}
+
+bool UdpReceiver::open(const std::string& group, uint16_t port, const std::string& iface, int rcvbuf_bytes) {
+    close();
+    sockaddr_in addr;
+    if (!make_address(group, port, addr)) {
+        std::cerr << "[Udp] Invalid group address: " << group << std::endl;
+        return false;
+    }
+    m_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_fd < 0) {
+        std::cerr << "[Udp] socket failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    const int on = 1;
+    setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(m_fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+    if (rcvbuf_bytes > 0) setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf_bytes, sizeof(rcvbuf_bytes));
+
+    // 组播绑定组地址，只收该组的报文；单播绑定给定地址
+    bool ok = bind(m_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    if (ok && is_multicast(addr)) {
+        ip_mreq mreq;
+        mreq.imr_multiaddr = addr.sin_addr;
+        ok = inet_pton(AF_INET, iface.c_str(), &mreq.imr_interface) == 1 &&
+             setsockopt(m_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) == 0;
+    }
+    if (!ok) {
+        std::cerr << "[Udp] Failed to join " << group << ":" << port << " on " << iface << ": " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    m_session = 0;
+    m_nextSeq = 0;
+    m_packets = m_ticks = m_gaps = m_lost = m_outOfOrder = m_malformed = m_resets = m_batches = 0;
+    return true;
+}
+
+void UdpReceiver::close() {
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = -1;
+}
+
+int UdpReceiver::receive(int timeout_ms) {
+    if (timeout_ms > 0) {
+        pollfd pfd;
+        pfd.fd = m_fd;
+        pfd.events = POLLIN;
+        if (::poll(&pfd, 1, timeout_ms) <= 0) return 0;
+    }
+    const int n = recvmmsg(m_fd, m_msgs.data(), (unsigned)BATCH, MSG_DONTWAIT, nullptr);
+    if (n > 0) ++m_batches;
+    return n;
+}
+
+bool UdpReceiver::accept(const PacketHeader* header, size_t length) {
+    if (length < sizeof(PacketHeader) || header->magic != MAGIC || header->version != VERSION ||
+        header->tick_size != sizeof(Tick) || header->tick_count > MAX_TICKS_PER_PACKET ||
+        length != sizeof(PacketHeader) + header->tick_count * sizeof(Tick)) {
+        ++m_malformed;
+        return false;
+    }
+    if (header->session != m_session) {
+        // 第一个报文或发布端重启：从这个报文开始重新计序号
+        if (m_nextSeq != 0) ++m_resets;
+        m_session = header->session;
+        m_nextSeq = header->seq;
+    }
+    if (header->seq < m_nextSeq) {
+        ++m_outOfOrder;
+        return false;
+    }
+    if (header->seq > m_nextSeq) {
+        ++m_gaps;
+        m_lost += header->seq - m_nextSeq;
+    }
+    m_nextSeq = header->seq + 1;
+    ++m_packets;
+    return true;
+}
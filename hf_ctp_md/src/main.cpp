@@ -2,10 +2,31 @@
 #include <string>
 #include <thread>
 #include <csignal>
+#include <vector>
+#include <memory>
+#include <cstdlib>
+#include <ctime>
+#include <sys/stat.h>
 #include "ThostFtdcMdApi.h"
 #include "SPSCQueue.h"
 #include "CTPMdSpi.h"
 #include "MarketDataEngine.h"
+#include "InstrumentRegistry.h"
+#include "OverflowPolicy.h"
+#include "SnapshotTable.h"
+#include "Config.h"
+#include "TscClock.h"
+#include "MockMdApi.h"
+#include "TickRecorder.h"
+#include "JournalReader.h"
+#include "JournalReplayer.h"
+#include "ShmBus.h"
+#include "UdpFeed.h"
+#include "FeedArbiter.h"
+#include "ShardMap.h"
+#include "BarAggregator.h"
+#include "IndicatorTable.h"
+#include "AsyncLog.h"
 
 // 全局标志位，用于信号处理
 std::atomic<bool> g_running(true);
@@ -22,71 +43,456 @@ int main(int argc, char* argv[]) {
 
     std::cout << "=== High Frequency CTP Market Data System ===" << std::endl;
 
+    // 0. 读取配置 (与 ctp_test 相同的 INI 格式)，缺省时使用模拟环境的默认值
+    std::string config_path = "config/config.ini";
+    if (argc > 1) config_path = argv[1];
+    Config config;
+    if (config.load(config_path)) {
+        std::cout << "[Main] Loaded config " << config_path << std::endl;
+    } else {
+        std::cout << "[Main] Config " << config_path << " not found, using defaults." << std::endl;
+    }
+
+    // 异步日志：CTP 回调线程上的日志经后台线程写出，guard 析构时写完剩余日志
+    hf_log::LogConfig logConfig;
+    if (!hf_log::parse_level(config.get_string("LOG", "Level", "INFO").c_str(), logConfig.level)) {
+        std::cerr << "[Main] Unknown LOG Level, using INFO." << std::endl;
+    }
+    logConfig.path = config.get_string("LOG", "File", "");
+    logConfig.buffer_size = (size_t)config.get_int("LOG", "BufferKB", 1024) * 1024;
+    logConfig.cpu_id = (int)config.get_int("LOG", "CpuId", -1);
+    hf_log::LogGuard logGuard(logConfig);
+
+    // 标定 TSC：之后所有时间戳和延迟都由 TSC 换算为纳秒
+    const bool invariantTsc = TscClock::invariant_tsc();
+    TscClock::set_serialized(config.get_bool("CLOCK", "SerializedTsc", false));
+    if (!TscClock::calibrate((uint64_t)config.get_int("CLOCK", "CalibrationMs", 100) * 1000000ULL)) {
+        std::cerr << "[Main] TSC calibration failed." << std::endl;
+        return -1;
+    }
+    std::cout << "[Main] TSC " << TscClock::ghz() << " GHz, invariant: " << (invariantTsc ? "yes" : "NO")
+              << ", serialized read: " << (TscClock::serialized() ? "yes" : "no") << std::endl;
+    if (!invariantTsc) {
+        std::cout << "[Main] Warning: TSC is not invariant, nanosecond latencies are approximate." << std::endl;
+    }
+
     // 1. 初始化无锁队列
-    // 容量设为 1024 (必须是2的幂次如果做位运算优化，但我们的实现里用取模，稍微宽容点)
-    // 考虑到行情突发流量，设大一点比较安全，例如 4096
-    std::cout << "[Main] Initializing Ring Buffer (size=4096)..." << std::endl;
-    SPSCQueue<MdData> queue(4096);
+    // 容量必须是 2 的幂次 (队列内部用位与代替取模)
+    // 考虑到行情突发流量，设大一点比较安全，默认 4096
+    const size_t queueCapacity = (size_t)config.get_int("QUEUE", "Capacity", 4096);
+    std::cout << "[Main] Initializing Ring Buffer (size=" << queueCapacity << ")..." << std::endl;
+    if (queueCapacity < 2 || (queueCapacity & (queueCapacity - 1)) != 0) {
+        std::cerr << "[Main] QUEUE Capacity must be a power of two." << std::endl;
+        return -1;
+    }
+
+    // 队列满时的处理策略：CTP 网络线程不能被无限期阻塞
+    OverflowConfig overflow;
+    const std::string policyName = config.get_string("QUEUE", "OverflowPolicy", overflow_policy_name(overflow.policy));
+    if (!parse_overflow_policy(policyName.c_str(), overflow.policy)) {
+        std::cerr << "[Main] Unknown OverflowPolicy: " << policyName << std::endl;
+        return -1;
+    }
+    overflow.spin_timeout_ns = (uint64_t)config.get_int("QUEUE", "SpinTimeoutNs", (long long)overflow.spin_timeout_ns);
+    std::cout << "[Main] Overflow policy: " << overflow_policy_name(overflow.policy) << std::endl;
+
+    // 回放模式 ([REPLAY] Enabled=true)：行情来自记录的 journal 文件，不连接前置
+    const bool useReplay = config.get_bool("REPLAY", "Enabled", false);
+    JournalReader reader;
+    if (useReplay) {
+        const std::string replayFile = config.get_string("REPLAY", "File");
+        if (!reader.open(replayFile)) {
+            return -1;
+        }
+        std::cout << "[Main] Replaying " << replayFile << " (trading day " << reader.trading_day() << ", "
+                  << reader.instrument_count() << " instruments, " << reader.size() / (1024 * 1024) << " MB)" << std::endl;
+    }
+
+    // 订阅列表及最小变动价位，启动前注册为稠密 id，供 tick 归一化和按合约统计使用
+    // Instruments 每项为 合约代码[:最小变动价位]；配置了 InstrumentsCsv (query_instruments 导出) 时以 CSV 中的价位为准
+    // 回放时按文件中的合约表依次注册，id 与记录时一致
+    InstrumentRegistry registry;
+    const std::string instrumentsCsv = config.get_string("INSTRUMENTS", "InstrumentsCsv");
+    if (useReplay) {
+        for (size_t i = 0; i < reader.instrument_count(); ++i) {
+            registry.add(reader.instrument_id(i), reader.price_tick(i));
+        }
+    } else if (!instrumentsCsv.empty()) {
+        const int loaded = registry.load_csv(instrumentsCsv.c_str());
+        if (loaded < 0) {
+            std::cerr << "[Main] Failed to open " << instrumentsCsv << std::endl;
+            return -1;
+        }
+        std::cout << "[Main] Loaded " << loaded << " instruments from " << instrumentsCsv << std::endl;
+    }
+
+    // 为了更快地触发 100 次统计，默认多订几个活跃合约
+    std::vector<std::string> subscriptions = config.get_list("INSTRUMENTS", "Instruments");
+    if (useReplay) {
+        subscriptions.clear();
+    } else if (!config.has("INSTRUMENTS", "Instruments")) {
+        const char* defaults[] = {
+            "au2512:0.02", "ag2512:1", "rb2601:1", "TS2601:0.002",
+            "cu2601:10",   "al2601:5", "zn2601:5", "ni2601:10"
+        };
+        subscriptions.assign(defaults, defaults + sizeof(defaults) / sizeof(defaults[0]));
+    }
+    std::vector<std::string> instrumentIds;
+    try {
+        for (size_t i = 0; i < subscriptions.size(); ++i) {
+            const std::string& item = subscriptions[i];
+            const size_t colon = item.find(':');
+            const std::string id = item.substr(0, colon);
+            const double priceTick = colon == std::string::npos ? 1.0 : atof(item.c_str() + colon + 1);
+            registry.add(id.c_str(), priceTick > 0 ? priceTick : 1.0);
+            instrumentIds.push_back(id);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[Main] " << e.what() << std::endl;
+        return -1;
+    }
+    std::vector<char*> instruments;
+    for (size_t i = 0; i < instrumentIds.size(); ++i) {
+        instruments.push_back(const_cast<char*>(instrumentIds[i].c_str()));
+    }
+    const int instrumentCount = (int)instruments.size();
+    if (!registry.build()) {
+        std::cerr << "[Main] Failed to build instrument perfect hash." << std::endl;
+        return -1;
+    }
+    DropCounters drops(registry.size());
+
+    // 分片 ([ENGINE] Shards)：合约按 ShardMap 分到多个 SPSC 队列，每个分片一个引擎线程
+    // 同一合约始终在同一分片内，合约内的先后顺序不变
+    const long long shardCount = config.get_int("ENGINE", "Shards", 1);
+    if (shardCount < 1 || shardCount > (long long)ShardMap::MAX_SHARDS) {
+        std::cerr << "[Main] ENGINE Shards must be between 1 and " << ShardMap::MAX_SHARDS << "." << std::endl;
+        return -1;
+    }
+    ShardMap shardMap(registry, (size_t)shardCount);
+    const std::vector<std::string> shardAssign = config.get_list("ENGINE", "ShardAssign");
+    for (size_t i = 0; i < shardAssign.size(); ++i) {
+        const int matched = shardMap.assign(shardAssign[i]);
+        if (matched < 0) {
+            std::cerr << "[Main] Invalid ShardAssign item: " << shardAssign[i] << std::endl;
+            return -1;
+        }
+        if (matched == 0) std::cerr << "[Main] ShardAssign " << shardAssign[i] << " matches no instrument." << std::endl;
+    }
+    const bool sharded = shardMap.shard_count() > 1;
+
+    // 按合约的最新快照表，与 FIFO 队列互补，供只关心最新盘口的策略使用
+    // 快照表是单写者的，分片时每个分片一张 (只有该分片的合约会被写入)
+    const bool useSnapshots = config.get_bool("QUEUE", "Snapshots", true);
+    std::vector<std::unique_ptr<SPSCQueue<Tick> > > queues;
+    std::vector<std::unique_ptr<SnapshotTable<Tick> > > snapshotTables;
+    std::vector<SPSCQueue<Tick>*> queuePtrs;
+    std::vector<SnapshotTable<Tick>*> snapshotPtrs;
+    for (size_t i = 0; i < shardMap.shard_count(); ++i) {
+        queues.push_back(std::unique_ptr<SPSCQueue<Tick> >(new SPSCQueue<Tick>(queueCapacity)));
+        queues.back()->set_overwrite(overflow.policy == OverflowPolicy::OverwriteOldest);
+        queuePtrs.push_back(queues.back().get());
+        if (useSnapshots) {
+            snapshotTables.push_back(std::unique_ptr<SnapshotTable<Tick> >(new SnapshotTable<Tick>(registry.size())));
+            snapshotPtrs.push_back(snapshotTables.back().get());
+        }
+        if (sharded) {
+            std::cout << "[Main] Shard " << i << ": " << shardMap.instruments_in(i) << " instruments" << std::endl;
+        }
+    }
 
     // 2. 初始化并启动消费者引擎
-    std::cout << "[Main] Starting Strategy Engine..." << std::endl;
-    MarketDataEngine engine(&queue);
-    // 去除绑核设置
-    // engine.set_cpu_affinity(1); 
-    engine.start();
-
-    // 3. 初始化 CTP API
-    std::cout << "[Main] Initializing CTP API..." << std::endl;
-    CThostFtdcMdApi* pMdApi = CThostFtdcMdApi::CreateFtdcMdApi("./flow/", false, false);
-    if (!pMdApi) {
-        std::cerr << "[Main] Failed to create MdApi instance." << std::endl;
+    // 绑核/实时调度/锁内存/预热在引擎线程内完成，start() 返回时已打印各项结果
+    EngineThreadConfig threadCfg;
+    threadCfg.cpu_id = (int)config.get_int("ENGINE", "CpuId", threadCfg.cpu_id);
+    threadCfg.rt_priority = (int)config.get_int("ENGINE", "RtPriority", threadCfg.rt_priority);
+    threadCfg.lock_memory = config.get_bool("ENGINE", "LockMemory", threadCfg.lock_memory);
+    threadCfg.prefault = config.get_bool("ENGINE", "Prefault", threadCfg.prefault);
+    // 分片时第 i 个引擎线程绑到 ShardCpuIds 的第 i 项，未配置的沿用 CpuId
+    const std::vector<std::string> shardCpuIds = config.get_list("ENGINE", "ShardCpuIds");
+
+    // 行情记录：引擎处理过的 tick 经独立写线程落盘，登录拿到交易日后再创建文件
+    // 记录、总线和 UDP 转发都是单写者，只能挂在唯一的引擎上；分片时不启用
+    if (sharded && (config.get_bool("RECORDER", "Enabled", false) || config.get_bool("BUS", "Enabled", false) ||
+                    config.get_bool("UDP", "Enabled", false))) {
+        std::cerr << "[Main] Recorder/Bus/Udp require a single shard, disabled." << std::endl;
+    }
+    const bool useRecorder = !useReplay && !sharded && config.get_bool("RECORDER", "Enabled", false);
+    TickRecorder recorder((size_t)config.get_int("RECORDER", "RingSize", TickRecorder::DEFAULT_RING_SIZE),
+                          (size_t)config.get_int("RECORDER", "BufferKB", TickRecorder::DEFAULT_BUFFER_SIZE / 1024) * 1024);
+    recorder.set_flush_interval_ms((unsigned)config.get_int("RECORDER", "FlushIntervalMs", TickRecorder::DEFAULT_FLUSH_INTERVAL_MS));
+    recorder.set_index_bucket_ns(config.get_int("RECORDER", "IndexBucketSec", 60) * 1000000000LL);
+
+    // 共享内存行情总线：本机其他策略进程通过 ShmBusReader 挂载读取，回放时同样广播
+    ShmBusWriter bus;
+    if (!sharded && config.get_bool("BUS", "Enabled", false)) {
+        if (!bus.open(config.get_string("BUS", "Name", "hf_md"),
+                      (size_t)config.get_int("BUS", "Capacity", ShmBusWriter::DEFAULT_CAPACITY), registry,
+                      config.get_string("BUS", "HugePageDir", "/dev/hugepages"))) {
+            std::cerr << "[Main] Bus disabled." << std::endl;
+        }
+    }
+
+    // UDP 组播转发：给同机其他容器里的消费者，独立的发送线程打包后 sendmmsg
+    UdpPublisher udp((size_t)config.get_int("UDP", "RingSize", UdpPublisher::DEFAULT_RING_SIZE));
+    bool useUdp = false;
+    if (!sharded && config.get_bool("UDP", "Enabled", false)) {
+        udp.set_cpu_affinity((int)config.get_int("UDP", "CpuId", -1));
+        udp.set_idle_sleep_us((unsigned)config.get_int("UDP", "IdleSleepUs", 50));
+        if (udp.open(config.get_string("UDP", "Group", "239.255.0.1"), (uint16_t)config.get_int("UDP", "Port", 30001),
+                     config.get_string("UDP", "Interface", "127.0.0.1"),
+                     (size_t)config.get_int("UDP", "TicksPerPacket", udpfeed::DEFAULT_TICKS_PER_PACKET),
+                     (int)config.get_int("UDP", "Ttl", 1))) {
+            useUdp = true;
+        } else {
+            std::cerr << "[Main] Udp publisher disabled." << std::endl;
+        }
+    }
+
+    // 前置列表：[MD] FrontAddress 加上 RedundantFronts，模拟前置的个数取 [MOCK] FrontDelaysUs 的项数
+    // 每个前置一个 MdApi 实例，多于一个时做 A/B 仲裁，最先到达的一笔胜出
+#ifdef HF_MOCK_ONLY
+    const bool useMock = true;
+#else
+    const bool useMock = config.get_bool("MOCK", "Enabled", false);
+#endif
+    std::vector<std::string> frontAddrs(1, config.get_string("MD", "FrontAddress", "tcp://101.231.162.58:41213"));
+    const std::vector<std::string> redundantFronts = config.get_list("MD", "RedundantFronts");
+    frontAddrs.insert(frontAddrs.end(), redundantFronts.begin(), redundantFronts.end());
+    const std::vector<std::string> mockDelays = config.get_list("MOCK", "FrontDelaysUs");
+    if (useMock) frontAddrs.resize(mockDelays.empty() ? 1 : mockDelays.size(), "mock");
+    if (frontAddrs.size() > FeedArbiter::MAX_FRONTS) {
+        std::cerr << "[Main] At most " << FeedArbiter::MAX_FRONTS << " fronts are supported." << std::endl;
         return -1;
     }
+    const size_t frontCount = useReplay ? 0 : frontAddrs.size();
+    FeedArbiter arbiter(registry.size(), frontCount);
 
-    CTPMdSpi spi(pMdApi, &queue);
-    pMdApi->RegisterSpi(&spi);
-    
-    // 模拟环境地址 (从原代码获取)
-    char frontAddr[] = "tcp://101.231.162.58:41213"; 
-    pMdApi->RegisterFront(frontAddr);
-    
-    pMdApi->Init();
-    
-    // 等待连接完成 (实际应由回调驱动，这里简单 sleep)
-    std::this_thread::sleep_for(std::chrono::seconds(2));
+    // 五档盘口：引擎线程逐笔比较，只把变化的档位交给策略；各分片的合约互不相同，共用一张表
+    const bool useOrderBook = config.get_bool("ENGINE", "OrderBook", false);
+    OrderBookTable orderBook(useOrderBook ? registry.size() : 0);
+
+    // K 线聚合 ([BARS] Periods 为秒，逗号分隔)：每个引擎一个聚合器，收盘由交易所时间驱动
+    const bool useBars = config.get_bool("BARS", "Enabled", false);
+    std::vector<uint32_t> barPeriods;
+    const std::vector<std::string> barPeriodItems = config.get_list("BARS", "Periods");
+    for (size_t i = 0; i < barPeriodItems.size(); ++i) {
+        const uint32_t period = (uint32_t)atoi(barPeriodItems[i].c_str());
+        if (!BarAggregator::valid_period(period)) {
+            std::cerr << "[Main] BARS period must divide 86400: " << barPeriodItems[i] << std::endl;
+            return -1;
+        }
+        barPeriods.push_back(period);
+    }
+    if (useBars && (barPeriods.empty() || barPeriods.size() > BarAggregator::MAX_PERIODS)) {
+        std::cerr << "[Main] BARS Periods must list 1 to " << BarAggregator::MAX_PERIODS << " periods." << std::endl;
+        return -1;
+    }
+    const uint32_t barCloseDelayMs = (uint32_t)config.get_int("BARS", "CloseDelayMs", 0);
+    std::vector<std::unique_ptr<BarAggregator> > barAggregators;
+
+    // 滚动指标 (EMA/VWAP/波动率/OBI)：每个引擎一张表，逐笔或整批更新
+    const bool useIndicators = config.get_bool("INDICATORS", "Enabled", false);
+    const std::string indicatorMode = config.get_string("INDICATORS", "Mode", "tick");
+    if (useIndicators && indicatorMode != "tick" && indicatorMode != "batch") {
+        std::cerr << "[Main] Unknown INDICATORS Mode: " << indicatorMode << std::endl;
+        return -1;
+    }
+    const double emaPeriod = config.get_double("INDICATORS", "EmaPeriod", 20);
+    const double volPeriod = config.get_double("INDICATORS", "VolPeriod", 100);
+    std::vector<std::unique_ptr<IndicatorTable> > indicatorTables;
+
+    std::cout << "[Main] Starting Strategy Engine..." << std::endl;
+    std::vector<std::unique_ptr<MarketDataEngine> > engines;
+    for (size_t i = 0; i < shardMap.shard_count(); ++i) {
+        engines.push_back(std::unique_ptr<MarketDataEngine>(new MarketDataEngine(queuePtrs[i])));
+        MarketDataEngine& engine = *engines.back();
+        engine.set_batch_size((size_t)config.get_int("ENGINE", "BatchSize", MarketDataEngine::DEFAULT_BATCH_SIZE));
+        engine.set_report_interval_ms((unsigned)config.get_int("ENGINE", "ReportIntervalMs", MarketDataEngine::DEFAULT_REPORT_INTERVAL_MS));
+        if (sharded) engine.set_shard(i);
+        if (useSnapshots) engine.set_snapshot_table(snapshotPtrs[i]);
+        if (useOrderBook) engine.set_order_book(&orderBook);
+        if (useBars) {
+            barAggregators.push_back(std::unique_ptr<BarAggregator>(
+                new BarAggregator(registry.size(), barPeriods, barCloseDelayMs)));
+            engine.set_bar_aggregator(barAggregators.back().get());
+        }
+        if (useIndicators) {
+            indicatorTables.push_back(std::unique_ptr<IndicatorTable>(
+                new IndicatorTable(registry.size(), emaPeriod, volPeriod)));
+            engine.set_indicators(indicatorTables.back().get(), indicatorMode == "batch");
+        }
+        // 丢弃计数和前置统计是全局的，只由第一个引擎报告
+        if (i == 0) {
+            engine.set_drop_counters(&drops, &registry);
+            if (frontCount > 1) engine.set_feed_arbiter(&arbiter);
+        }
+        if (bus.is_open()) engine.set_bus(&bus);
+        if (useUdp) engine.set_udp_publisher(&udp);
+        EngineThreadConfig shardThreadCfg = threadCfg;
+        if (i < shardCpuIds.size()) shardThreadCfg.cpu_id = atoi(shardCpuIds[i].c_str());
+        engine.set_thread_config(shardThreadCfg);
+        engine.start();
+    }
+    // 转发环由引擎线程预热，发送线程在此之后启动
+    if (useUdp) udp.start();
+
+    if (useReplay) {
+        JournalReplayer replayer(&reader, queuePtrs[0]);
+        replayer.set_speed(config.get_double("REPLAY", "Speed", 0));
+        replayer.set_cpu_affinity((int)config.get_int("REPLAY", "CpuId", -1));
+        if (sharded) {
+            replayer.set_shards(shardMap, queuePtrs, snapshotPtrs);
+        } else if (useSnapshots) {
+            replayer.set_snapshot_table(snapshotPtrs[0]);
+        }
+        replayer.start();
+
+        // 文件回放完且所有分片处理完全部 tick 后退出
+        for (;;) {
+            uint64_t processed = 0;
+            for (size_t i = 0; i < engines.size(); ++i) processed += engines[i]->tick_count();
+            if (!g_running || (replayer.done() && processed >= replayer.replayed())) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        std::cout << "[Main] Shutting down..." << std::endl;
+        replayer.stop();
+        for (size_t i = 0; i < engines.size(); ++i) engines[i]->stop();
+        udp.stop();
+        bus.close();
+        std::cout << "[Main] Shutdown complete." << std::endl;
+        return 0;
+    }
+
+    // 3. 初始化 CTP API ([MOCK] Enabled=true 或 hf_ctp_md_sim 时使用进程内模拟前置)
+    // 多个模拟前置共用同一行情时间轴，生成完全相同的行情，只是注入的延迟不同
+    MockMdConfig mockCfg;
+    mockCfg.rate = (uint64_t)config.get_int("MOCK", "Rate", (long long)mockCfg.rate);
+    mockCfg.burst = (size_t)config.get_int("MOCK", "Burst", (long long)mockCfg.burst);
+    mockCfg.instrument_count = (size_t)config.get_int("MOCK", "InstrumentCount", 0);
+    mockCfg.max_ticks = (uint64_t)config.get_int("MOCK", "MaxTicks", 0);
+    mockCfg.seed = (uint64_t)config.get_int("MOCK", "Seed", (long long)mockCfg.seed);
+    mockCfg.cpu_id = (int)config.get_int("MOCK", "CpuId", -1);
+    mockCfg.trading_day = config.get_string("MOCK", "TradingDay", mockCfg.trading_day);
+    if (frontCount > 1) mockCfg.start_ns = TscClock::wall_ns();
+
+    std::vector<CThostFtdcMdApi*> mdApis;
+    std::vector<std::unique_ptr<CTPMdSpi> > spis;
+    for (size_t i = 0; i < frontCount; ++i) {
+        CThostFtdcMdApi* pMdApi = nullptr;
+        if (useMock) {
+            mockCfg.delay_us = mockDelays.empty() ? 0 : (uint64_t)atoll(mockDelays[i].c_str());
+            std::cout << "[Main] Initializing Mock MdApi " << i << " (rate=" << mockCfg.rate << "/s, burst="
+                      << mockCfg.burst << ", delay=" << mockCfg.delay_us << "us)..." << std::endl;
+            MockMdApi* pMock = new MockMdApi(mockCfg);
+            for (size_t k = 0; k < registry.size(); ++k) {
+                pMock->SetPriceTick(registry.name((uint16_t)k), registry.price_tick((uint16_t)k));
+            }
+            pMdApi = pMock;
+        }
+#ifndef HF_MOCK_ONLY
+        else {
+            // 每个实例需要独立的流文件目录
+            std::string flowDir = "./flow/";
+            if (i > 0) {
+                flowDir += std::to_string(i) + "/";
+                mkdir("./flow", 0755);
+                mkdir(flowDir.c_str(), 0755);
+            }
+            std::cout << "[Main] Initializing CTP API " << i << " (" << frontAddrs[i] << ")..." << std::endl;
+            pMdApi = CThostFtdcMdApi::CreateFtdcMdApi(flowDir.c_str(), false, false);
+        }
+#endif
+        if (!pMdApi) {
+            std::cerr << "[Main] Failed to create MdApi instance." << std::endl;
+            return -1;
+        }
+
+        // 队列、快照表和溢出处理由第一个前置的 Spi 持有，其余前置仲裁胜出后交给它写入
+        spis.push_back(std::unique_ptr<CTPMdSpi>(new CTPMdSpi(pMdApi, queuePtrs[0], &registry)));
+        CTPMdSpi& spi = *spis.back();
+        if (i == 0) {
+            spi.SetOverflowPolicy(overflow, &drops);
+            if (sharded) {
+                spi.SetShards(shardMap, queuePtrs, snapshotPtrs);
+            } else if (useSnapshots) {
+                spi.SetSnapshotTable(snapshotPtrs[0]);
+            }
+        }
+        if (frontCount > 1) spi.SetArbiter(&arbiter, (uint8_t)i, spis[0].get());
+        pMdApi->RegisterSpi(&spi);
+        pMdApi->RegisterFront(const_cast<char*>(frontAddrs[i].c_str()));
+        mdApis.push_back(pMdApi);
+    }
+    for (size_t i = 0; i < mdApis.size(); ++i) mdApis[i]->Init();
+
+    // 等待连接完成 (实际应由回调驱动，这里简单 sleep；模拟前置是即时回调的)
+    const std::chrono::milliseconds connectWait(useMock ? 100 : 2000);
+    std::this_thread::sleep_for(connectWait);
 
     // 4. 登录
-    // 模拟环境账号
-    spi.ReqUserLogin("9999", "247060", "RY20000219*");
+    // 默认为模拟环境账号
+    for (size_t i = 0; i < spis.size(); ++i) {
+        spis[i]->ReqUserLogin(config.get_string("MD", "BrokerID", "9999").c_str(),
+                              config.get_string("MD", "UserID", "247060").c_str(),
+                              config.get_string("MD", "Password", "RY20000219*").c_str());
+    }
 
     // 等待登录完成
-    std::this_thread::sleep_for(std::chrono::seconds(2));
+    std::this_thread::sleep_for(connectWait);
+
+    if (useRecorder) {
+        // 文件名：<Directory>/md_<交易日>_<启动时间>.tj，同一交易日重启不会覆盖
+        const std::string dir = config.get_string("RECORDER", "Directory", "./journal");
+        mkdir(dir.c_str(), 0755);
+        const char* tradingDay = mdApis[0]->GetTradingDay();
+        char name[64];
+        snprintf(name, sizeof(name), "/md_%s_%ld.tj", tradingDay ? tradingDay : "0", (long)time(nullptr));
+        if (!recorder.open(dir + name, (uint32_t)atoi(tradingDay ? tradingDay : "0"), registry)) {
+            std::cerr << "[Main] Recorder disabled." << std::endl;
+        } else {
+            // 打开成功后才挂到引擎上；引擎已在运行，记录环在这里预热
+            if (threadCfg.prefault) recorder.prefault();
+            recorder.start();
+            engines[0]->set_recorder(&recorder);
+        }
+    }
 
     // 5. 订阅行情
-    // 为了更快地触发 100 次统计，我们可以多订几个活跃合约
-    char* instruments[] = {
-        (char*)"au2512", (char*)"ag2512", (char*)"rb2601", (char*)"TS2601",
-        (char*)"cu2601", (char*)"al2601", (char*)"zn2601", (char*)"ni2601"
-    };
-    spi.SubscribeMarketData(instruments, 8);
+    for (size_t i = 0; i < spis.size(); ++i) {
+        spis[i]->SubscribeMarketData(instruments.data(), instrumentCount);
+    }
 
     std::cout << "[Main] System running. Press Ctrl+C to exit." << std::endl;
 
-    // 6. 主线程保持运行，直到收到信号
+    // 6. 主线程保持运行，直到收到信号 (模拟前置可设置 RunSeconds 自动退出，便于脚本化压测)
+    const long long runSeconds = useMock ? config.get_int("MOCK", "RunSeconds", 0) : 0;
+    const std::chrono::steady_clock::time_point runStart = std::chrono::steady_clock::now();
     while (g_running) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
+        if (runSeconds > 0 && std::chrono::steady_clock::now() - runStart >= std::chrono::seconds(runSeconds)) {
+            std::cout << "[Main] RunSeconds reached." << std::endl;
+            break;
+        }
     }
 
     // 7. 清理资源
     std::cout << "[Main] Shutting down..." << std::endl;
     
     // 先停 API，不再产生新数据
-    pMdApi->RegisterSpi(nullptr);
-    pMdApi->Release();
-    pMdApi = nullptr; // Release 会自删除
+    for (size_t i = 0; i < mdApis.size(); ++i) {
+        mdApis[i]->RegisterSpi(nullptr);
+        mdApis[i]->Release(); // Release 会自删除
+    }
+    mdApis.clear();
 
     // 再停消费者
-    engine.stop();
+    for (size_t i = 0; i < engines.size(); ++i) engines[i]->stop();
+
+    // 最后停记录，写完环中剩余的 tick；关闭总线，读端读完剩余数据后看到写端已退出
+    recorder.stop();
+    udp.stop();
+    bus.close();
 
     std::cout << "[Main] Shutdown complete." << std::endl;
     return 0;
@@ -0,0 +1,117 @@
+// 共享内存行情总线的示例客户端
+//
+// 用法: bus_reader [-c cpu] [-o] [name] [instrument]
+//   挂载总线 (默认 hf_md)，零拷贝读取并每秒打印收包速率、
+//   接收 -> 本进程读到的延迟分布 (两端各自标定 TSC，误差在微秒级) 以及被套圈的情况
+//   指定 instrument 时打印该合约的每一笔；-o 从环内最老的数据开始读；写端退出后读完剩余数据结束
+#include "LatencyHistogram.h"
+#include "ShmBus.h"
+#include "TscClock.h"
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <string>
+#include <immintrin.h> // _mm_pause
+
+static std::atomic<bool> g_running(true);
+
+static void signal_handler(int) {
+    g_running = false;
+}
+
+static void pin(int cpu_id) {
+    if (cpu_id < 0) return;
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu_id, &cpuset);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+}
+
+int main(int argc, char* argv[]) {
+    int cpu_id = -1;
+    bool oldest = false;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; ++arg) {
+        if (strcmp(argv[arg], "-c") == 0 && arg + 1 < argc) {
+            cpu_id = atoi(argv[++arg]);
+        } else if (strcmp(argv[arg], "-o") == 0) {
+            oldest = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [-c cpu] [-o] [name] [instrument]" << std::endl;
+            return 1;
+        }
+    }
+    const std::string name = arg < argc ? argv[arg++] : "hf_md";
+    const char* instrument = arg < argc ? argv[arg++] : nullptr;
+
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+    if (!TscClock::calibrate(100000000ULL)) {
+        std::cerr << "TSC calibration failed." << std::endl;
+        return 1;
+    }
+
+    ShmBusReader bus;
+    if (!bus.open(name)) return 1;
+    uint16_t filter = 0xFFFF;
+    if (instrument) {
+        filter = bus.find_instrument(instrument);
+        if (filter == 0xFFFF) {
+            std::cerr << instrument << " is not on bus " << name << std::endl;
+            return 1;
+        }
+    }
+    if (oldest) bus.seek_oldest();
+    std::cout << "Attached " << bus.path() << ": writer pid " << bus.writer_pid() << ", " << bus.capacity()
+              << " slots, " << bus.instrument_count() << " instruments, "
+              << (bus.huge_pages() ? "huge pages" : "4KB pages") << ", backlog " << bus.backlog() << std::endl;
+
+    pin(cpu_id);
+    LatencyHistogram latency;
+    HistogramSnapshot last, current, interval;
+    last.clear();
+    uint64_t last_received = 0;
+    const int64_t REPORT_NS = 1000000000LL;
+    int64_t next_report = TscClock::wall_ns() + REPORT_NS;
+
+    while (g_running) {
+        const size_t n = bus.poll([&](const Tick& tick) {
+            const int64_t latency_ns = TscClock::wall_ns() - tick.receive_ns;
+            latency.record(latency_ns > 0 ? (uint64_t)latency_ns : 0);
+            if (tick.instrument_id == filter) {
+                printf("%s last %.4f vol %d bid %.4f x %d ask %.4f x %d\n", bus.instrument_id(filter),
+                       tick.last_px * bus.price_tick(filter), tick.volume, tick.bid_px[0] * bus.price_tick(filter),
+                       tick.bid_vol[0], tick.ask_px[0] * bus.price_tick(filter), tick.ask_vol[0]);
+            }
+        });
+        if (n == 0) {
+            if (bus.writer_closed()) break;
+            _mm_pause();
+        }
+
+        const int64_t now = TscClock::wall_ns();
+        if (now >= next_report) {
+            next_report = now + REPORT_NS;
+            latency.snapshot(current);
+            interval = current;
+            interval.subtract(last);
+            last = current;
+            printf("[Bus] %llu ticks/s, latency(ns) P50:%llu P99:%llu Max:%llu, lapped %llu, missed %llu, backlog %llu\n",
+                   (unsigned long long)(bus.received() - last_received),
+                   (unsigned long long)interval.percentile(0.50), (unsigned long long)interval.percentile(0.99),
+                   (unsigned long long)interval.max, (unsigned long long)bus.lapped(),
+                   (unsigned long long)bus.missed(), (unsigned long long)bus.backlog());
+            fflush(stdout);
+            last_received = bus.received();
+        }
+    }
+
+    printf("[Bus] Received %llu ticks, lapped %llu times, missed %llu, torn %llu%s\n",
+           (unsigned long long)bus.received(), (unsigned long long)bus.lapped(), (unsigned long long)bus.missed(),
+           (unsigned long long)bus.torn(), bus.writer_closed() ? ", writer closed" : "");
+    return 0;
+}
@@ -0,0 +1,160 @@
+// 收盘后把当天的 journal (.tj) 转换为列式日文件 (.tc)
+//
+// 用法: tick_convert [-b block_ticks] [-m max_pending_ticks] [-v] <out.tc> <journal.tj>...
+//   同一交易日重启会产生多个 journal，按命令行顺序 (即时间顺序) 合并，合约按代码合并并重新编号
+//   -m  写入端缓存 tick 总数的上限，超出时提前写出不满的块 (默认 1M 条，约 128 MB)
+//   -v  转换后重新读取两边逐条比对
+#include "ColumnarReader.h"
+#include "ColumnarWriter.h"
+#include "JournalReader.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace columnar;
+
+// 按 journal 内 id -> 列式文件 id 的映射读取全部 tick
+static bool open_journal(const std::string& path, JournalReader& reader, ColumnarWriter& writer,
+                         std::vector<uint16_t>& id_map) {
+    if (!reader.open(path)) return false;
+    id_map.resize(reader.instrument_count());
+    for (size_t i = 0; i < reader.instrument_count(); ++i) {
+        id_map[i] = writer.add_instrument(reader.instrument_id(i), reader.price_tick(i));
+        if (id_map[i] == ColumnarReader::INVALID_ID) {
+            std::cerr << "Too many instruments." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// 每个合约一个解码游标，按 journal 顺序取出该合约的下一条与原始 tick 比对
+struct VerifyCursor {
+    size_t block;
+    size_t pos;
+    std::vector<Tick, AlignedAllocator<Tick> > ticks;
+};
+
+static bool verify(const std::string& out_path, const std::vector<std::string>& inputs) {
+    ColumnarReader columns;
+    if (!columns.open(out_path)) return false;
+
+    std::vector<VerifyCursor> cursors(columns.instrument_count());
+    for (size_t i = 0; i < cursors.size(); ++i) {
+        cursors[i].block = 0;
+        cursors[i].pos = 0;
+    }
+
+    uint64_t checked = 0;
+    for (size_t f = 0; f < inputs.size(); ++f) {
+        JournalReader reader;
+        if (!reader.open(inputs[f])) return false;
+        std::vector<uint16_t> id_map(reader.instrument_count());
+        for (size_t i = 0; i < reader.instrument_count(); ++i) {
+            id_map[i] = columns.find_instrument(reader.instrument_id(i));
+        }
+
+        Tick tick;
+        while (reader.next(tick)) {
+            if (tick.instrument_id >= id_map.size() || id_map[tick.instrument_id] == ColumnarReader::INVALID_ID) continue;
+            const uint16_t id = id_map[tick.instrument_id];
+            tick.instrument_id = id;
+
+            VerifyCursor& cur = cursors[id];
+            if (cur.pos == cur.ticks.size()) {
+                if (cur.block >= columns.block_count(id)) {
+                    std::cerr << "Verify: " << columns.instrument(id).instrument_id << " has fewer ticks than the journal." << std::endl;
+                    return false;
+                }
+                const BlockEntry& entry = columns.block(id, cur.block++);
+                cur.ticks.resize(entry.tick_count);
+                if (columns.decode_block(entry, cur.ticks.data()) != entry.tick_count) {
+                    std::cerr << "Verify: corrupt block " << (cur.block - 1) << " of " << columns.instrument(id).instrument_id << std::endl;
+                    return false;
+                }
+                cur.pos = 0;
+            }
+            if (memcmp(&cur.ticks[cur.pos++], &tick, sizeof(Tick)) != 0) {
+                std::cerr << "Verify: mismatch at tick " << checked << " (" << columns.instrument(id).instrument_id << ")" << std::endl;
+                return false;
+            }
+            checked++;
+        }
+    }
+
+    if (checked != columns.tick_count()) {
+        std::cerr << "Verify: " << checked << " journal ticks vs " << columns.tick_count() << " columnar ticks." << std::endl;
+        return false;
+    }
+    std::cout << "Verify: " << checked << " ticks identical." << std::endl;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    size_t block_ticks = ColumnarWriter::DEFAULT_BLOCK_TICKS;
+    size_t max_pending = ColumnarWriter::DEFAULT_MAX_PENDING_TICKS;
+    bool do_verify = false;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; ++arg) {
+        if (strcmp(argv[arg], "-v") == 0) {
+            do_verify = true;
+        } else if (strcmp(argv[arg], "-b") == 0 && arg + 1 < argc) {
+            block_ticks = (size_t)strtoull(argv[++arg], nullptr, 10);
+        } else if (strcmp(argv[arg], "-m") == 0 && arg + 1 < argc) {
+            max_pending = (size_t)strtoull(argv[++arg], nullptr, 10);
+        } else {
+            break;
+        }
+    }
+    if (argc - arg < 2) {
+        std::cerr << "Usage: " << argv[0] << " [-b block_ticks] [-m max_pending_ticks] [-v] <out.tc> <journal.tj>..." << std::endl;
+        return 1;
+    }
+    const std::string out_path = argv[arg++];
+    const std::vector<std::string> inputs(argv + arg, argv + argc);
+
+    ColumnarWriter writer(block_ticks, max_pending);
+    uint64_t input_bytes = 0;
+    uint32_t trading_day = 0;
+    for (size_t f = 0; f < inputs.size(); ++f) {
+        JournalReader reader;
+        std::vector<uint16_t> id_map;
+        if (!open_journal(inputs[f], reader, writer, id_map)) return 1;
+        if (f == 0) {
+            trading_day = reader.trading_day();
+            if (!writer.open(out_path, trading_day)) return 1;
+        } else if (reader.trading_day() != trading_day) {
+            std::cerr << "Warning: " << inputs[f] << " is trading day " << reader.trading_day()
+                      << ", expected " << trading_day << std::endl;
+        }
+
+        Tick tick;
+        uint64_t count = 0;
+        while (reader.next(tick)) {
+            if (tick.instrument_id >= id_map.size()) continue;
+            tick.instrument_id = id_map[tick.instrument_id];
+            if (!writer.append(tick)) return 1;
+            count++;
+        }
+        input_bytes += reader.size();
+        std::cout << inputs[f] << ": " << count << " ticks" << std::endl;
+    }
+    if (!writer.close()) return 1;
+
+    const uint64_t ticks = writer.tick_count();
+    printf("%s: %llu ticks, %zu blocks (%llu flushed early), %.1f MB -> %.1f MB (%.2fx, %.1f bytes/tick)\n",
+           out_path.c_str(), (unsigned long long)ticks, writer.block_count(),
+           (unsigned long long)writer.budget_flushes(),
+           input_bytes / 1048576.0, writer.file_size() / 1048576.0,
+           writer.file_size() ? (double)input_bytes / writer.file_size() : 0.0,
+           ticks ? (double)writer.file_size() / ticks : 0.0);
+    for (int c = 0; c < NUM_COLUMNS; ++c) {
+        printf("  %-14s %6.2f bytes/tick\n", column_name(c), ticks ? (double)writer.column_bytes(c) / ticks : 0.0);
+    }
+
+    if (do_verify && !verify(out_path, inputs)) return 1;
+    return 0;
+}
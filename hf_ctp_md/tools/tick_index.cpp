@@ -0,0 +1,99 @@
+// journal 稀疏索引工具
+//
+// 用法: tick_index [-b bucket_sec] <journal.tj>
+//         为已有的 journal 建索引 (写出 <journal>.idx)，记录时已生成索引的不需要
+//       tick_index -q <journal.tj> <instrument> <from> <to>
+//         查询合约在 [from, to) 内的 tick，时间为北京时间 YYYYMMDD-HH:MM:SS (交易所时间，夜盘用自然日)
+//         同时做一遍全文件顺序扫描，核对结果并比较耗时
+#include "JournalIndex.h"
+#include "JournalReader.h"
+#include "Tick.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+static uint64_t elapsed_us(std::chrono::steady_clock::time_point start) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// "YYYYMMDD-HH:MM:SS" -> UTC epoch 纳秒
+static bool parse_time(const char* s, int64_t& ns) {
+    if (strlen(s) != 17 || s[8] != '-' || s[11] != ':' || s[14] != ':') return false;
+    ns = exchange_time_ns(s, s + 9, 0);
+    return true;
+}
+
+static int query(const std::string& path, const char* instrument, const char* from_str, const char* to_str) {
+    int64_t from = 0, to = 0;
+    if (!parse_time(from_str, from) || !parse_time(to_str, to)) {
+        std::cerr << "Time must be YYYYMMDD-HH:MM:SS" << std::endl;
+        return 1;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    JournalIndex index;
+    if (!index.open(path)) return 1;
+    const uint64_t open_us = elapsed_us(start);
+    const uint16_t id = index.find_instrument(instrument);
+    if (id == 0xFFFF) {
+        std::cerr << instrument << " is not in " << path << std::endl;
+        return 1;
+    }
+
+    start = std::chrono::steady_clock::now();
+    TickCursor cursor = index.query(id, from, to);
+    Tick tick;
+    uint64_t matched = 0;
+    int64_t first_ts = 0, last_ts = 0;
+    while (cursor.next(tick)) {
+        if (matched++ == 0) first_ts = tick.exchange_ts_ns;
+        last_ts = tick.exchange_ts_ns;
+    }
+    const uint64_t query_us = elapsed_us(start);
+
+    // 全文件顺序扫描作对照
+    start = std::chrono::steady_clock::now();
+    JournalReader reader;
+    if (!reader.open(path)) return 1;
+    uint64_t expected = 0, total = 0;
+    while (reader.next(tick)) {
+        total++;
+        if (tick.instrument_id == id && tick.exchange_ts_ns >= from && tick.exchange_ts_ns < to) expected++;
+    }
+    const uint64_t scan_us = elapsed_us(start);
+
+    printf("index: %zu entries, bucket %llds, %s (%llu us)\n", index.entry_count(),
+           (long long)(index.bucket_ns() / 1000000000LL), index.loaded() ? "loaded" : "rebuilt", (unsigned long long)open_us);
+    printf("query %s: %llu ticks, scanned %llu of %llu records in %llu us (first %lld, last %lld)\n",
+           instrument, (unsigned long long)matched, (unsigned long long)cursor.scanned(),
+           (unsigned long long)total, (unsigned long long)query_us, (long long)first_ts, (long long)last_ts);
+    printf("linear scan: %llu ticks in %llu us, %s\n", (unsigned long long)expected, (unsigned long long)scan_us,
+           matched == expected ? "OK" : "MISMATCH");
+    return matched == expected ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 6 && strcmp(argv[1], "-q") == 0) {
+        return query(argv[2], argv[3], argv[4], argv[5]);
+    }
+
+    int64_t bucket_sec = JournalIndexBuilder::DEFAULT_BUCKET_NS / 1000000000LL;
+    int arg = 1;
+    if (argc > 3 && strcmp(argv[1], "-b") == 0) {
+        bucket_sec = atoll(argv[2]);
+        arg = 3;
+    }
+    if (argc - arg != 1 || bucket_sec <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [-b bucket_sec] <journal.tj>\n"
+                  << "       " << argv[0] << " -q <journal.tj> <instrument> <YYYYMMDD-HH:MM:SS> <YYYYMMDD-HH:MM:SS>" << std::endl;
+        return 1;
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (!JournalIndexBuilder::build(argv[arg], bucket_sec * 1000000000LL)) return 1;
+    std::cout << "Wrote " << argv[arg] << ".idx in " << elapsed_us(start) / 1000 << " ms" << std::endl;
+    return 0;
+}
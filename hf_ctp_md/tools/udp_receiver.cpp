@@ -0,0 +1,117 @@
+// UDP 组播行情转发的示例客户端
+//
+// 用法: udp_receiver [-c cpu] [-i iface] [group] [port] [instrument_index]
+//   加入组播组 (默认 239.255.0.1:30001，经 127.0.0.1 接收)，每秒打印报文/tick 速率、丢包情况，
+//   以及两段延迟：CTP 接收 -> 发布端发出、发出 -> 本进程收到 (同机时两端共用 TSC 时钟源)
+//   指定 instrument_index 时打印该合约编号的每一笔
+#include "LatencyHistogram.h"
+#include "UdpFeed.h"
+#include "TscClock.h"
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <string>
+
+static std::atomic<bool> g_running(true);
+
+static void signal_handler(int) {
+    g_running = false;
+}
+
+static void pin(int cpu_id) {
+    if (cpu_id < 0) return;
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu_id, &cpuset);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+}
+
+static void record(LatencyHistogram& hist, int64_t ns) {
+    hist.record(ns > 0 ? (uint64_t)ns : 0);
+}
+
+int main(int argc, char* argv[]) {
+    int cpu_id = -1;
+    std::string iface = "127.0.0.1";
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; ++arg) {
+        if (strcmp(argv[arg], "-c") == 0 && arg + 1 < argc) {
+            cpu_id = atoi(argv[++arg]);
+        } else if (strcmp(argv[arg], "-i") == 0 && arg + 1 < argc) {
+            iface = argv[++arg];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [-c cpu] [-i iface] [group] [port] [instrument_index]" << std::endl;
+            return 1;
+        }
+    }
+    const std::string group = arg < argc ? argv[arg++] : "239.255.0.1";
+    const uint16_t port = (uint16_t)(arg < argc ? atoi(argv[arg++]) : 30001);
+    const int filter = arg < argc ? atoi(argv[arg++]) : -1;
+
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+    if (!TscClock::calibrate(100000000ULL)) {
+        std::cerr << "TSC calibration failed." << std::endl;
+        return 1;
+    }
+
+    UdpReceiver rx;
+    if (!rx.open(group, port, iface)) return 1;
+    std::cout << "Listening on " << group << ":" << port << " via " << iface << std::endl;
+
+    pin(cpu_id);
+    LatencyHistogram publish_latency, wire_latency;
+    HistogramSnapshot last_publish, last_wire, current, interval;
+    last_publish.clear();
+    last_wire.clear();
+    uint64_t last_packets = 0, last_ticks = 0;
+    const int64_t REPORT_NS = 1000000000LL;
+    int64_t next_report = TscClock::wall_ns() + REPORT_NS;
+
+    while (g_running) {
+        rx.poll([&](const Tick& tick, const udpfeed::PacketHeader& header, int64_t recv_ns) {
+            record(publish_latency, header.send_ns - tick.receive_ns);
+            record(wire_latency, recv_ns - header.send_ns);
+            if ((int)tick.instrument_id == filter) {
+                printf("#%d seq %llu last %lld vol %d bid %d x %d ask %d x %d\n", filter,
+                       (unsigned long long)header.seq, (long long)tick.last_px, tick.volume, tick.bid_px[0], tick.bid_vol[0],
+                       tick.ask_px[0], tick.ask_vol[0]);
+            }
+        }, 100);
+
+        const int64_t now = TscClock::wall_ns();
+        if (now >= next_report) {
+            next_report = now + REPORT_NS;
+            publish_latency.snapshot(current);
+            interval = current;
+            interval.subtract(last_publish);
+            last_publish = current;
+            const uint64_t p50 = interval.percentile(0.50), p99 = interval.percentile(0.99);
+            wire_latency.snapshot(current);
+            interval = current;
+            interval.subtract(last_wire);
+            last_wire = current;
+            printf("[Udp] %llu packets/s, %llu ticks/s, recv->send(ns) P50:%llu P99:%llu, send->recv(ns) P50:%llu "
+                   "P99:%llu Max:%llu, gaps %llu, lost %llu, out of order %llu\n",
+                   (unsigned long long)(rx.packets() - last_packets), (unsigned long long)(rx.ticks() - last_ticks),
+                   (unsigned long long)p50, (unsigned long long)p99,
+                   (unsigned long long)interval.percentile(0.50), (unsigned long long)interval.percentile(0.99),
+                   (unsigned long long)interval.max, (unsigned long long)rx.gaps(), (unsigned long long)rx.lost(),
+                   (unsigned long long)rx.out_of_order());
+            fflush(stdout);
+            last_packets = rx.packets();
+            last_ticks = rx.ticks();
+        }
+    }
+
+    printf("[Udp] Received %llu ticks in %llu packets (%llu recvmmsg batches), gaps %llu, lost %llu, "
+           "out of order %llu, malformed %llu, publisher restarts %llu\n",
+           (unsigned long long)rx.ticks(), (unsigned long long)rx.packets(), (unsigned long long)rx.batches(),
+           (unsigned long long)rx.gaps(), (unsigned long long)rx.lost(), (unsigned long long)rx.out_of_order(),
+           (unsigned long long)rx.malformed(), (unsigned long long)rx.resets());
+    return 0;
+}
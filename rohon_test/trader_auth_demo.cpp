@@ -17,6 +17,7 @@
 #include <iomanip>
 #include <iconv.h>
 #include "ThostFtdcTraderApi.h"
+#include "AsyncLog.h"
 
 // ==================== 编码转换 ====================
 // CTP/融航所有字符串字段均为 GBK，终端为 UTF-8，需要转换后打印。
@@ -194,20 +195,20 @@ public:
 
     void OnFrontConnected() override
     {
-        std::cout << "\n[连接] 融航柜台连接成功，开始认证..." << std::endl;
+        LOG_INFO("[连接] 融航柜台连接成功，开始认证...");
         reqAuthenticate();
     }
 
     void OnFrontDisconnected(int nReason) override
     {
-        std::cout << "[断开] 连接断开，原因: " << nReason << std::endl;
+        LOG_WARN("[断开] 连接断开，原因: {}", nReason);
         g_bLoggedIn = false;
         g_bReady    = false;
     }
 
     void OnHeartBeatWarning(int nTimeLapse) override
     {
-        std::cout << "[心跳] 警告，已 " << nTimeLapse << "s 未收到数据" << std::endl;
+        LOG_WARN("[心跳] 警告，已 {}s 未收到数据", nTimeLapse);
     }
 
     // ---------- 认证 ----------
@@ -228,10 +229,10 @@ public:
                            int, bool) override
     {
         if (i && i->ErrorID != 0) {
-            std::cerr << "[认证] 失败: [" << i->ErrorID << "] " << gbk2utf8(i->ErrorMsg) << std::endl;
+            LOG_ERROR("[认证] 失败: [{}] {}", i->ErrorID, hf_log::gbk(i->ErrorMsg));
             return;
         }
-        std::cout << "[认证] 成功，发送登录..." << std::endl;
+        LOG_INFO("[认证] 成功，发送登录...");
         reqUserLogin();
     }
 
@@ -250,7 +251,7 @@ public:
                         int, bool) override
     {
         if (i && i->ErrorID != 0) {
-            std::cerr << "[登录] 失败: [" << i->ErrorID << "] " << gbk2utf8(i->ErrorMsg) << std::endl;
+            LOG_ERROR("[登录] 失败: [{}] {}", i->ErrorID, hf_log::gbk(i->ErrorMsg));
             return;
         }
         g_FrontID   = f->FrontID;
@@ -258,12 +259,12 @@ public:
         // MaxOrderRef 是本 session 已用过的最大 OrderRef，新单从 +1 开始
         g_nOrderRef = atoi(f->MaxOrderRef) + 1;
 
-        std::cout << "[登录] 成功\n"
-                  << "  交易日:      " << f->TradingDay    << "\n"
-                  << "  FrontID:     " << g_FrontID        << "\n"
-                  << "  SessionID:   " << g_SessionID      << "\n"
-                  << "  MaxOrderRef: " << f->MaxOrderRef   << "  下一单号: " << g_nOrderRef.load()
-                  << std::endl;
+        LOG_INFO("[登录] 成功\n"
+                 "  交易日:      {}\n"
+                 "  FrontID:     {}\n"
+                 "  SessionID:   {}\n"
+                 "  MaxOrderRef: {}  下一单号: {}",
+                 f->TradingDay, g_FrontID, g_SessionID, f->MaxOrderRef, g_nOrderRef.load());
 
         g_bLoggedIn = true;
         reqSettlementConfirm();
@@ -272,7 +273,7 @@ public:
     void OnRspUserLogout(CThostFtdcUserLogoutField*, CThostFtdcRspInfoField*,
                          int, bool) override
     {
-        std::cout << "[登出] 成功" << std::endl;
+        LOG_INFO("[登出] 成功");
         g_bLoggedIn = false;
         g_bReady    = false;
     }
@@ -281,7 +282,7 @@ public:
 
     void reqSettlementConfirm()
     {
-        std::cout << "[结算] 发送结算确认..." << std::endl;
+        LOG_INFO("[结算] 发送结算确认...");
         CThostFtdcSettlementInfoConfirmField req = {};
         strncpy(req.BrokerID,   g_BrokerID.c_str(), sizeof(req.BrokerID)   - 1);
         strncpy(req.InvestorID, g_UserID.c_str(),   sizeof(req.InvestorID) - 1);
@@ -293,11 +294,12 @@ public:
     {
         if (i && i->ErrorID != 0) {
             // 部分柜台不要求结算确认，忽略错误仍可交易
-            std::cout << "[结算] 跳过确认 [" << i->ErrorID << "] " << gbk2utf8(i->ErrorMsg) << std::endl;
+            LOG_WARN("[结算] 跳过确认 [{}] {}", i->ErrorID, hf_log::gbk(i->ErrorMsg));
         } else {
-            std::cout << "[结算] 确认成功" << std::endl;
+            LOG_INFO("[结算] 确认成功");
         }
         g_bReady = true;
+        // 就绪提示和命令帮助属于交互输出，仍直接写 stdout
         std::cout << "\n========== 就绪，可以下单 ==========" << std::endl;
         printHelp();
     }
@@ -396,8 +398,7 @@ public:
                           int, bool) override
     {
         if (i && i->ErrorID != 0) {
-            std::cerr << "[报单拒绝] OrderRef=" << (f ? f->OrderRef : "?")
-                      << "  [" << i->ErrorID << "] " << gbk2utf8(i->ErrorMsg) << std::endl;
+            LOG_ERROR("[报单拒绝] OrderRef={}  [{}] {}", f ? f->OrderRef : "?", i->ErrorID, hf_log::gbk(i->ErrorMsg));
             if (f) {
                 std::lock_guard<std::mutex> lk(g_orderMutex);
                 auto it = g_orders.find(std::string(f->OrderRef));
@@ -412,8 +413,7 @@ public:
                              CThostFtdcRspInfoField* i) override
     {
         if (i && i->ErrorID != 0) {
-            std::cerr << "[下单错误] OrderRef=" << (f ? f->OrderRef : "?")
-                      << "  [" << i->ErrorID << "] " << gbk2utf8(i->ErrorMsg) << std::endl;
+            LOG_ERROR("[下单错误] OrderRef={}  [{}] {}", f ? f->OrderRef : "?", i->ErrorID, hf_log::gbk(i->ErrorMsg));
         }
     }
 
@@ -422,7 +422,7 @@ public:
                           int, bool) override
     {
         if (i && i->ErrorID != 0) {
-            std::cerr << "[撤单拒绝] [" << i->ErrorID << "] " << gbk2utf8(i->ErrorMsg) << std::endl;
+            LOG_ERROR("[撤单拒绝] [{}] {}", i->ErrorID, hf_log::gbk(i->ErrorMsg));
         }
     }
 
@@ -431,7 +431,7 @@ public:
                              CThostFtdcRspInfoField* i) override
     {
         if (i && i->ErrorID != 0) {
-            std::cerr << "[撤单错误] [" << i->ErrorID << "] " << gbk2utf8(i->ErrorMsg) << std::endl;
+            LOG_ERROR("[撤单错误] [{}] {}", i->ErrorID, hf_log::gbk(i->ErrorMsg));
         }
     }
 
@@ -454,33 +454,24 @@ public:
             }
         }
 
-        std::cout << "[报单推送] OrderRef=" << orderRef
-                  << "  SysID="   << f->OrderSysID
-                  << "  " << f->InstrumentID
-                  << "  剩余=" << f->VolumeTotal
-                  << "  状态=" << gbk2utf8(f->StatusMsg)
-                  << std::endl;
+        LOG_INFO("[报单推送] OrderRef={}  SysID={}  {}  剩余={}  状态={}",
+                 orderRef, f->OrderSysID, f->InstrumentID, f->VolumeTotal, hf_log::gbk(f->StatusMsg));
     }
 
     // 成交推送
     void OnRtnTrade(CThostFtdcTradeField* f) override
     {
         if (!f) return;
-        std::cout << "[成交推送] OrderRef=" << f->OrderRef
-                  << "  " << f->ExchangeID << "." << f->InstrumentID
-                  << "  " << (f->Direction == THOST_FTDC_D_Buy ? "BUY" : "SELL")
-                  << "  价=" << f->Price
-                  << "  量=" << f->Volume
-                  << "  时间=" << f->TradeTime
-                  << std::endl;
+        LOG_INFO("[成交推送] OrderRef={}  {}.{}  {}  价={}  量={}  时间={}",
+                 f->OrderRef, f->ExchangeID, f->InstrumentID, f->Direction == THOST_FTDC_D_Buy ? "BUY" : "SELL",
+                 f->Price, f->Volume, f->TradeTime);
     }
 
     // 通用错误
     void OnRspError(CThostFtdcRspInfoField* i, int reqId, bool) override
     {
         if (i && i->ErrorID != 0)
-            std::cerr << "[错误] ReqID=" << reqId
-                      << "  [" << i->ErrorID << "] " << gbk2utf8(i->ErrorMsg) << std::endl;
+            LOG_ERROR("[错误] ReqID={}  [{}] {}", reqId, i->ErrorID, hf_log::gbk(i->ErrorMsg));
     }
 };
 
@@ -585,6 +576,9 @@ int main(int argc, char* argv[])
 
     std::string configFile = (argc > 1) ? argv[1] : "config.json";
 
+    // 柜台回调线程上的日志经后台线程写出，退出时写完剩余日志
+    hf_log::LogGuard logGuard;
+
     std::cout << "========================================\n"
               << "  融航柜台 CTP 下单/撤单 Demo\n"
               << "========================================\n"